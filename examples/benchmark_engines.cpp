@@ -0,0 +1,277 @@
+/*
+ * Microbenchmarks of the three MT2 engines, called directly from C++ so that
+ * no Python or ufunc overhead is measured.
+ *
+ * Build and run with `make benchmark_cpp`, or with the benchmark_engines target
+ * of the CMake build, or by hand:
+ *
+ *     c++ -std=c++11 -O3 -DENABLE_INLINING=1 -DDISABLE_COPYRIGHT_PRINTING=1 \
+ *         -Isrc/_mt2 -o build/benchmark_engines examples/benchmark_engines.cpp
+ *     build/benchmark_engines [n_events] [repeats] [corpus.mt2 ...]
+ *
+ * Each engine is run over fixed, seeded corpora of events, at each of several
+ * values of the precision argument. These are the corpora below, or else those
+ * read from files written by examples/generate_corpus.cpp (`make corpora'),
+ * truncated to `n_events'. For each, we report:
+ *
+ *     ns/event   mean time per event over the whole corpus, the best of
+ *                `repeats' passes
+ *     p50 - max  percentiles of the time of single events, each timed on its
+ *                own, so including the overhead of reading the clock
+ *     tests      mean disjointness tests per event, for the tombs engines
+ *
+ * The precision argument is relative for tombs, but absolute (in the units of
+ * the inputs) for Lester and Lally, so only precision 0 compares like with
+ * like.
+ */
+
+/*
+ * Includes
+ *
+ * algorithm
+ *     std::sort
+ * chrono
+ *     std::chrono::steady_clock
+ * cstdint
+ *     std::uint64_t
+ * cstdio
+ *     std::printf
+ * cstdlib
+ *     std::atol
+ * string
+ *     std::string
+ * vector
+ *     std::vector
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "lester_mt2_bisect_v7.h"
+#include "mt2_Lallyver2.h"
+#include "mt2_bisect.h"
+#include "mt2_corpus.h"
+
+
+/* Types */
+/*
+ * Compute MT2 for event `i' of `events'. If `tests' is not NULL, it is
+ * incremented by the number of disjointness tests made, if known.
+ */
+typedef double (*engine_function)(const struct mt2_corpus *events,
+                                  std::size_t i, double precision,
+                                  unsigned long long *tests);
+
+struct engine {
+    const char *name;
+    engine_function function;
+};
+
+
+/* Engines */
+static double
+tombs(const struct mt2_corpus *events, std::size_t i, double precision,
+      unsigned long long *tests)
+{
+    const std::vector<double> *c = events->columns;
+    if (!tests)
+        return mt2_bisect_impl(c[0][i], c[1][i], c[2][i], c[3][i], c[4][i],
+                               c[5][i], c[6][i], c[7][i], c[8][i], c[9][i],
+                               precision);
+
+    struct mt2_setup<double> setup;
+    if (!mt2_prepare(c[0][i], c[1][i], c[2][i], c[3][i], c[4][i], c[5][i],
+                     c[6][i], c[7][i], c[8][i], c[9][i], &setup))
+        return setup.scale;
+    struct mt2_diagnostics diagnostics = {mt2_status_ok, 0, 0};
+    const double result = mt2_bisect_setup<double>(
+        &setup, precision, 0, 0, NULL, &diagnostics);
+    *tests += diagnostics.tests;
+    return result;
+}
+
+static double
+tombs_brent(const struct mt2_corpus *events, std::size_t i, double precision,
+            unsigned long long *tests)
+{
+    const std::vector<double> *c = events->columns;
+    struct mt2_setup<double> setup;
+    if (!mt2_prepare(c[0][i], c[1][i], c[2][i], c[3][i], c[4][i], c[5][i],
+                     c[6][i], c[7][i], c[8][i], c[9][i], &setup))
+        return setup.scale;
+    struct mt2_diagnostics diagnostics = {mt2_status_ok, 0, 0};
+    const double result = mt2_brent_setup<double>(
+        &setup, precision, 0, 0, NULL, tests ? &diagnostics : NULL);
+    if (tests)
+        *tests += diagnostics.tests;
+    return result;
+}
+
+static double
+lester(const struct mt2_corpus *events, std::size_t i, double precision,
+       unsigned long long *tests)
+{
+    const std::vector<double> *c = events->columns;
+    return asymm_mt2_lester_bisect::get_mT2(
+        c[0][i], c[1][i], c[2][i], c[3][i], c[4][i], c[5][i], c[6][i],
+        c[7][i], c[8][i], c[9][i], precision, true);
+}
+
+static double
+lally(const struct mt2_corpus *events, std::size_t i, double precision,
+      unsigned long long *tests)
+{
+    const std::vector<double> *c = events->columns;
+    return mt2_lally(c[0][i], c[1][i], c[2][i], c[3][i], c[4][i], c[5][i],
+                     c[6][i], c[7][i], c[8][i], c[9][i], precision);
+}
+
+static const struct engine engines[] = {
+    {"tombs", &tombs},
+    {"tombs-brent", &tombs_brent},
+    {"lester", &lester},
+    {"lally", &lally},
+};
+
+
+/* Corpora */
+/*
+ * Return a uniform double in [0, 1) from a 64-bit linear congruential
+ * generator, so that corpora are the same on every platform.
+ */
+static double
+uniform(std::uint64_t *state)
+{
+    *state = *state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (double)(*state >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/*
+ * Return `n' events like those of the unit tests: all components uniform in
+ * [-100, 100], with masses made positive. If `near_massless', the second
+ * visible particle is scaled to near zero mass and the invisible particles
+ * are massless, which is slow for every engine.
+ */
+static struct mt2_corpus
+make_corpus(const char *name, std::size_t n, std::uint64_t seed,
+            bool near_massless)
+{
+    struct mt2_corpus events;
+    events.name = name;
+    events.seed = seed;
+    for (int j = 0; j < 10; ++j)
+        events.columns[j].resize(n);
+
+    std::uint64_t state = seed;
+    for (std::size_t i = 0; i < n; ++i) {
+        for (int j = 0; j < 10; ++j) {
+            double x = 200 * uniform(&state) - 100;
+            if (j == 0 || j == 3 || j == 8 || j == 9)
+                x = x < 0 ? -x : x;
+            events.columns[j][i] = x;
+        }
+        if (near_massless) {
+            events.columns[3][i] *= 1e-9;
+            events.columns[8][i] = 0;
+            events.columns[9][i] = 0;
+        }
+    }
+    return events;
+}
+
+
+/* Measurement */
+static double
+seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+static void
+run(const struct engine *e, const struct mt2_corpus *events, double precision,
+    int repeats)
+{
+    const std::size_t n = events->columns[0].size();
+
+    /* Throughput, the best of several passes. */
+    volatile double sink = 0;
+    double best = 0;
+    for (int r = 0; r < repeats; ++r) {
+        const auto start = std::chrono::steady_clock::now();
+        double sum = 0;
+        for (std::size_t i = 0; i < n; ++i)
+            sum += e->function(events, i, precision, NULL);
+        const double elapsed = seconds_since(start);
+        sink = sink + sum;
+        if (r == 0 || elapsed < best)
+            best = elapsed;
+    }
+
+    /* Latency of single events, and tests where the engine counts them. */
+    std::vector<double> latency(n);
+    unsigned long long tests = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        sink = sink + e->function(events, i, precision, NULL);
+        latency[i] = 1e9 * seconds_since(start);
+        e->function(events, i, precision, &tests);
+    }
+    std::sort(latency.begin(), latency.end());
+
+    std::printf("%-24s %-12s %9.0e %9.1f %8.0f %8.0f %8.0f %9.0f ",
+                events->name.c_str(), e->name, precision, 1e9 * best / n,
+                latency[n / 2], latency[n * 9 / 10], latency[n * 99 / 100],
+                latency[n - 1]);
+    if (tests)
+        std::printf("%6.1f\n", (double)tests / n);
+    else
+        std::printf("%6s\n", "-");
+}
+
+
+int
+main(int argc, char **argv)
+{
+    const std::size_t n = argc > 1 ? std::atol(argv[1]) : 100000;
+    const int repeats = argc > 2 ? std::atoi(argv[2]) : 5;
+    if (n == 0 || repeats <= 0) {
+        std::fprintf(stderr,
+                     "usage: %s [n_events] [repeats] [corpus.mt2 ...]\n",
+                     argv[0]);
+        return 1;
+    }
+
+    std::vector<struct mt2_corpus> corpora;
+    for (int i = 3; i < argc; ++i) {
+        struct mt2_corpus events;
+        if (!mt2_corpus_read(&events, argv[i])) {
+            std::fprintf(stderr, "%s: cannot read corpus %s\n", argv[0],
+                         argv[i]);
+            return 1;
+        }
+        for (int j = 0; j < 10; ++j)
+            events.columns[j].resize(std::min(n, events.columns[j].size()));
+        if (events.columns[0].empty())
+            continue;
+        corpora.push_back(events);
+    }
+    if (argc <= 3) {
+        corpora.push_back(make_corpus("bulk", n, 42, false));
+        corpora.push_back(make_corpus("near-massless", n, 43, true));
+    }
+    const double precisions[] = {0, 1e-6, 1e-3};
+
+    std::printf("%-24s %-12s %9s %9s %8s %8s %8s %9s %6s\n", "corpus",
+                "engine", "precision", "ns/event", "p50", "p90", "p99", "max",
+                "tests");
+    for (const auto &events : corpora)
+        for (double precision : precisions)
+            for (const auto &e : engines)
+                run(&e, &events, precision, repeats);
+    return 0;
+}
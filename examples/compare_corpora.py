@@ -0,0 +1,71 @@
+"""Compare the three MT2 engines on corpora written by generate_corpus.cpp.
+
+Run ``make corpora``, then e.g.
+
+    python examples/compare_corpora.py build/corpora/*.mt2
+"""
+
+import sys
+import time
+
+import numpy
+
+from mt2 import mt2, mt2_arxiv
+from mt2._mt2 import mt2_lally_ufunc
+
+# The layout of the header of a corpus file; see examples/mt2_corpus.h.
+HEADER = numpy.dtype(
+    [
+        ("magic", "S8"),
+        ("version", "=u4"),
+        ("n_columns", "=u4"),
+        ("n_events", "=u8"),
+        ("seed", "=u8"),
+        ("name", "S32"),
+    ]
+)
+
+
+def load_corpus(path):
+    """Return the name of the corpus in `path`, and its ten columns of events."""
+    header = numpy.fromfile(path, dtype=HEADER, count=1)[0]
+    if header["magic"] != b"MT2SOA1" or header["version"] != 1:
+        raise ValueError(f"{path} is not a corpus file of this byte order")
+    columns = numpy.memmap(
+        path,
+        dtype=numpy.float64,
+        mode="r",
+        offset=HEADER.itemsize,
+        shape=(int(header["n_columns"]), int(header["n_events"])),
+    )
+    return header["name"].decode(), list(columns)
+
+
+def mt2_lally(*args):
+    return mt2_lally_ufunc(*args, 0.0)
+
+
+def main(paths):
+    print(f"{'corpus':<24} {'engine':<8} {'ns/event':>9} {'max rel. diff':>14}")
+    for path in paths:
+        name, args = load_corpus(path)
+        expected = None
+        engines = (("tombs", mt2), ("lester", mt2_arxiv), ("lally", mt2_lally))
+        for engine, function in engines:
+            start = time.perf_counter()
+            with numpy.errstate(all="ignore"):
+                result = function(*args)
+            elapsed = time.perf_counter() - start
+            if expected is None:
+                expected = result
+            with numpy.errstate(all="ignore"):
+                difference = numpy.abs(result - expected) / numpy.abs(expected)
+            difference = numpy.nanmax(numpy.where(expected > 0, difference, 0))
+            print(
+                f"{name:<24} {engine:<8} {1e9 * elapsed / len(result):9.1f} "
+                f"{difference:14.2e}"
+            )
+
+
+if __name__ == "__main__":
+    main(sys.argv[1:])
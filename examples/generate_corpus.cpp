@@ -0,0 +1,156 @@
+/*
+ * Generate seeded corpora of MT2 events, one file per pair of decay model and
+ * kinematic regime; see examples/mt2_corpus.h for the models, the regimes and
+ * the file format.
+ *
+ * Build and run with `make corpora', or by hand:
+ *
+ *     c++ -std=c++11 -O3 -pthread -Isrc/_mt2 \
+ *         -o build/generate_corpus examples/generate_corpus.cpp
+ *     build/generate_corpus [-n n_events] [-s seed] [-j threads] [-o dir] \
+ *         [name ...]
+ *
+ * Each corpus is written to `dir'/`name'.mt2, where the name is that of the
+ * model and of the regime, e.g. "slepton-boosted". If names are given, only
+ * those corpora are written. The files are the same for any number of
+ * threads, so the seed and the number of events identify a corpus.
+ */
+
+/*
+ * Includes
+ *
+ * algorithm
+ *     std::find, std::min
+ * atomic
+ *     std::atomic
+ * cstdio
+ *     std::fprintf, std::printf
+ * cstdlib
+ *     std::atoi, std::strtoull
+ * cstring
+ *     std::strcmp
+ * string
+ *     std::string
+ * thread
+ *     std::thread
+ * vector
+ *     std::vector
+ */
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mt2_corpus.h"
+
+
+/* Generation */
+/*
+ * Generate the named corpus of `n' events from `model' and `regime', with the
+ * blocks shared between `threads' threads.
+ */
+static struct mt2_corpus
+generate(const std::string &name, const struct mt2_corpus_model *model,
+         const struct mt2_corpus_regime *regime, std::size_t n,
+         std::uint64_t seed, int threads)
+{
+    struct mt2_corpus corpus;
+    corpus.name = name;
+    corpus.seed = seed;
+    for (int j = 0; j < 10; ++j)
+        corpus.columns[j].resize(n);
+
+    const std::size_t n_blocks = (n + mt2_corpus_block - 1) / mt2_corpus_block;
+    std::atomic<std::size_t> next(0);
+    auto work = [&]() {
+        for (std::size_t block = next++; block < n_blocks; block = next++) {
+            const std::size_t begin = block * mt2_corpus_block;
+            mt2_corpus_fill(&corpus, model, regime, begin,
+                            std::min(n, begin + mt2_corpus_block));
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; ++t)
+        pool.emplace_back(work);
+    work();
+    for (auto &thread : pool)
+        thread.join();
+    return corpus;
+}
+
+
+static int
+usage(const char *program)
+{
+    std::fprintf(stderr,
+                 "usage: %s [-n n_events] [-s seed] [-j threads] [-o dir] "
+                 "[name ...]\n",
+                 program);
+    return 1;
+}
+
+int
+main(int argc, char **argv)
+{
+    std::size_t n = 100000;
+    std::uint64_t seed = 42;
+    int threads = (int)std::thread::hardware_concurrency();
+    std::string directory = ".";
+    std::vector<std::string> names;
+
+    for (int i = 1; i < argc; ++i) {
+        const bool has_value = i + 1 < argc;
+        if (!std::strcmp(argv[i], "-n") && has_value)
+            n = std::strtoull(argv[++i], NULL, 10);
+        else if (!std::strcmp(argv[i], "-s") && has_value)
+            seed = std::strtoull(argv[++i], NULL, 10);
+        else if (!std::strcmp(argv[i], "-j") && has_value)
+            threads = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "-o") && has_value)
+            directory = argv[++i];
+        else if (argv[i][0] == '-')
+            return usage(argv[0]);
+        else
+            names.push_back(argv[i]);
+    }
+    if (n == 0)
+        return usage(argv[0]);
+    if (threads <= 0)
+        threads = 1;
+
+    std::vector<std::string> written;
+    for (const auto &model : mt2_corpus_models) {
+        for (const auto &regime : mt2_corpus_regimes) {
+            const std::string name =
+                std::string(model.name) + "-" + regime.name;
+            if (!names.empty()
+                && std::find(names.begin(), names.end(), name) == names.end())
+                continue;
+
+            const struct mt2_corpus corpus =
+                generate(name, &model, &regime, n, seed, threads);
+            const std::string path = directory + "/" + name + ".mt2";
+            if (!mt2_corpus_write(&corpus, path.c_str())) {
+                std::fprintf(stderr, "%s: cannot write %s\n", argv[0],
+                             path.c_str());
+                return 1;
+            }
+            std::printf("%s\n", path.c_str());
+            written.push_back(name);
+        }
+    }
+
+    for (const auto &name : names) {
+        if (std::find(written.begin(), written.end(), name) == written.end()) {
+            std::fprintf(stderr, "%s: unknown corpus %s\n", argv[0],
+                         name.c_str());
+            return 1;
+        }
+    }
+    return 0;
+}
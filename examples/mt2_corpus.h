@@ -0,0 +1,347 @@
+/*
+ * Seeded corpora of MT2 events, and the binary file format in which they are
+ * stored, shared by examples/generate_corpus.cpp and the benchmarks.
+ *
+ * File format
+ *
+ * A corpus file is a 64-byte header followed by ten columns of `n_events'
+ * doubles each, in the order of the arguments of `mt2' (mass, px and py of
+ * each visible particle, the x and y components of the missing transverse
+ * momentum, then the two invisible masses). All values are in host byte order;
+ * a reader can detect a foreign byte order by the version not being 1.
+ *
+ *     offset  size  field
+ *          0     8  magic, "MT2SOA1" and a NUL
+ *          8     4  version, uint32, currently 1
+ *         12     4  n_columns, uint32, always 10
+ *         16     8  n_events, uint64
+ *         24     8  seed, uint64, that of the whole run of the generator
+ *         32    32  name, NUL-padded, e.g. "slepton-boosted"
+ *
+ * Corpora
+ *
+ * Each event is a pair of equal-mass parents, each decaying to one visible and
+ * one invisible particle, with the masses of a `mt2_corpus_model'. The
+ * invisible masses of the event are the true ones, so MT2 of every event is at
+ * most the parent mass, up to rounding. A `mt2_corpus_regime' chooses the
+ * kinematics of the parents, and may then distort the event into one of the
+ * configurations that are slow or delicate for the engines; the bound does not
+ * hold once the missing momentum has been zeroed.
+ *
+ * Events are generated in blocks of `mt2_corpus_block' events, each with its
+ * own random stream seeded from the seed, the name of the corpus and the index
+ * of the block. A corpus is thus the same however many threads generate it,
+ * and adding models or regimes does not change the existing corpora.
+ */
+
+#ifndef MT2_CORPUS_H
+#define MT2_CORPUS_H
+
+/*
+ * Includes
+ *
+ * cmath
+ *     std::cos, std::cosh, std::log, std::pow, std::sin, std::sinh, std::sqrt
+ * cstdint
+ *     std::uint32_t, std::uint64_t
+ * cstdio
+ *     std::FILE, std::fclose, std::fopen, std::fread, std::fwrite
+ * cstring
+ *     std::memcmp, std::memcpy, std::memset, std::strncpy
+ * string
+ *     std::string
+ * vector
+ *     std::vector
+ */
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+
+/* Types */
+struct mt2_corpus {
+    std::string name;
+    std::uint64_t seed;
+    std::vector<double> columns[10];
+};
+
+struct mt2_corpus_header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t n_columns;
+    std::uint64_t n_events;
+    std::uint64_t seed;
+    char name[32];
+};
+
+/* A parent of mass `parent', decaying to masses `visible' and `invisible'. */
+struct mt2_corpus_model {
+    const char *name;
+    double parent;
+    double visible;
+    double invisible;
+};
+
+/*
+ * The parents have transverse momenta drawn from exponential distributions
+ * with means `pt_a' and `pt_b', in units of the parent mass, and rapidities
+ * uniform in [-2.5, 2.5]. If `boost' is non-zero, the whole event is then
+ * boosted in a random transverse direction with a Lorentz factor of one plus
+ * an exponential variate of mean `boost'.
+ *
+ * Then, if `near_massless', the visible masses are scaled by 1e-9 and the
+ * invisible masses are zero; if `zero_met', the missing momentum is set to
+ * zero; and if `decades' is non-zero, the momenta and masses of each event are
+ * scaled by 10^u, for u uniform in [-decades, decades].
+ */
+struct mt2_corpus_regime {
+    const char *name;
+    double pt_a;
+    double pt_b;
+    double boost;
+    bool near_massless;
+    bool zero_met;
+    double decades;
+};
+
+
+/* Constants */
+static const char mt2_corpus_magic[8] = "MT2SOA1";
+
+static const std::size_t mt2_corpus_block = 4096;
+
+static const double mt2_corpus_two_pi = 6.283185307179586;
+
+/* Slepton, chargino to W, and top to b with the W taken as invisible. */
+static const struct mt2_corpus_model mt2_corpus_models[] = {
+    {"slepton", 300.0, 0.1056583755, 100.0},
+    {"chargino", 400.0, 80.377, 150.0},
+    {"top", 172.57, 4.18, 80.377},
+};
+
+static const struct mt2_corpus_regime mt2_corpus_regimes[] = {
+    /* name            pt_a  pt_b  boost  massless zero_met decades */
+    {"bulk",           0.5,  0.5,  0.0,   false,   false,   0.0},
+    {"unbalanced",     10.0, 0.01, 0.0,   false,   false,   0.0},
+    {"near-massless",  0.5,  0.5,  0.0,   true,    false,   0.0},
+    {"boosted",        0.5,  0.5,  20.0,  false,   false,   0.0},
+    {"zero-met",       0.5,  0.5,  0.0,   false,   true,    0.0},
+    {"dynamic-range",  0.5,  0.5,  0.0,   false,   false,   50.0},
+};
+
+
+/* Random numbers */
+/* Return the next output of the SplitMix64 generator. */
+inline std::uint64_t
+mt2_corpus_next(std::uint64_t *state)
+{
+    std::uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+/* Return a uniform double in [0, 1). */
+inline double
+mt2_corpus_uniform(std::uint64_t *state)
+{
+    return (double)(mt2_corpus_next(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/* Return the seed of the random stream of a block of the named corpus. */
+inline std::uint64_t
+mt2_corpus_stream(std::uint64_t seed, const std::string &name,
+                  std::uint64_t block)
+{
+    /* FNV-1a of the name, so that each corpus has its own streams. */
+    std::uint64_t hash = 0xcbf29ce484222325ULL;
+    for (char c : name)
+        hash = (hash ^ (unsigned char)c) * 0x100000001b3ULL;
+    std::uint64_t state = seed ^ hash;
+    state = mt2_corpus_next(&state) + block;
+    return mt2_corpus_next(&state);
+}
+
+
+/* Kinematics */
+/* A four-momentum (e, x, y, z). */
+struct mt2_corpus_vector {
+    double e, x, y, z;
+};
+
+/*
+ * Return `p' boosted by the velocity of a particle of four-momentum `by' and
+ * mass `m', i.e. from the rest frame of that particle to the frame in which it
+ * has four-momentum `by'.
+ */
+inline struct mt2_corpus_vector
+mt2_corpus_boost(struct mt2_corpus_vector p, struct mt2_corpus_vector by,
+                 double m)
+{
+    const double bp = (by.x * p.x + by.y * p.y + by.z * p.z) / m;
+    const double k = bp / (by.e + m) + p.e / m;
+    const struct mt2_corpus_vector result = {
+        (by.e * p.e + by.x * p.x + by.y * p.y + by.z * p.z) / m,
+        p.x + k * by.x, p.y + k * by.y, p.z + k * by.z};
+    return result;
+}
+
+/* Return a four-momentum of mass `m' and momentum `p' in a random direction. */
+inline struct mt2_corpus_vector
+mt2_corpus_isotropic(double m, double p, std::uint64_t *state)
+{
+    const double cos_theta = 2 * mt2_corpus_uniform(state) - 1;
+    const double sin_theta = std::sqrt(1 - cos_theta * cos_theta);
+    const double phi = mt2_corpus_two_pi * mt2_corpus_uniform(state);
+    const struct mt2_corpus_vector result = {
+        std::sqrt(m * m + p * p), p * sin_theta * std::cos(phi),
+        p * sin_theta * std::sin(phi), p * cos_theta};
+    return result;
+}
+
+/* Return a parent of mass `m' with transverse momentum of mean `pt_mean'. */
+inline struct mt2_corpus_vector
+mt2_corpus_parent(double m, double pt_mean, std::uint64_t *state)
+{
+    const double pt = -pt_mean * std::log(1 - mt2_corpus_uniform(state));
+    const double phi = mt2_corpus_two_pi * mt2_corpus_uniform(state);
+    const double rapidity = 5 * mt2_corpus_uniform(state) - 2.5;
+    const double mt = std::sqrt(m * m + pt * pt);
+    const struct mt2_corpus_vector result = {
+        mt * std::cosh(rapidity), pt * std::cos(phi), pt * std::sin(phi),
+        mt * std::sinh(rapidity)};
+    return result;
+}
+
+/*
+ * Decay `parent', of mass `model->parent', isotropically in its rest frame,
+ * and store the visible and invisible daughters in the lab frame.
+ */
+inline void
+mt2_corpus_decay(const struct mt2_corpus_model *model, double visible_mass,
+                 double invisible_mass, struct mt2_corpus_vector parent,
+                 struct mt2_corpus_vector *visible,
+                 struct mt2_corpus_vector *invisible, std::uint64_t *state)
+{
+    const double m = model->parent;
+    const double sum = visible_mass + invisible_mass;
+    const double difference = visible_mass - invisible_mass;
+    const double p = std::sqrt((m * m - sum * sum)
+                               * (m * m - difference * difference)) / (2 * m);
+    struct mt2_corpus_vector v = mt2_corpus_isotropic(visible_mass, p, state);
+    struct mt2_corpus_vector i = {
+        std::sqrt(invisible_mass * invisible_mass + p * p), -v.x, -v.y, -v.z};
+    *visible = mt2_corpus_boost(v, parent, m);
+    *invisible = mt2_corpus_boost(i, parent, m);
+}
+
+/* Fill events [begin, end) of `corpus', which must be a single block. */
+inline void
+mt2_corpus_fill(struct mt2_corpus *corpus,
+                const struct mt2_corpus_model *model,
+                const struct mt2_corpus_regime *regime, std::size_t begin,
+                std::size_t end)
+{
+    std::uint64_t state = mt2_corpus_stream(corpus->seed, corpus->name,
+                                            begin / mt2_corpus_block);
+    const double m = model->parent;
+    const double visible_mass =
+        regime->near_massless ? 1e-9 * model->visible : model->visible;
+    const double invisible_mass = regime->near_massless ? 0 : model->invisible;
+    std::vector<double> *c = corpus->columns;
+
+    for (std::size_t n = begin; n < end; ++n) {
+        struct mt2_corpus_vector a =
+            mt2_corpus_parent(m, regime->pt_a * m, &state);
+        struct mt2_corpus_vector b =
+            mt2_corpus_parent(m, regime->pt_b * m, &state);
+        if (regime->boost) {
+            const double gamma =
+                1 - regime->boost * std::log(1 - mt2_corpus_uniform(&state));
+            const double phi = mt2_corpus_two_pi * mt2_corpus_uniform(&state);
+            const double p = std::sqrt(gamma * gamma - 1);
+            const struct mt2_corpus_vector frame = {
+                gamma, p * std::cos(phi), p * std::sin(phi), 0};
+            a = mt2_corpus_boost(a, frame, 1);
+            b = mt2_corpus_boost(b, frame, 1);
+        }
+
+        struct mt2_corpus_vector visible_a, invisible_a, visible_b, invisible_b;
+        mt2_corpus_decay(model, visible_mass, invisible_mass, a, &visible_a,
+                         &invisible_a, &state);
+        mt2_corpus_decay(model, visible_mass, invisible_mass, b, &visible_b,
+                         &invisible_b, &state);
+
+        double scale = 1;
+        if (regime->decades)
+            scale = std::pow(10.0, regime->decades
+                                       * (2 * mt2_corpus_uniform(&state) - 1));
+        const bool met = !regime->zero_met;
+        c[0][n] = scale * visible_mass;
+        c[1][n] = scale * visible_a.x;
+        c[2][n] = scale * visible_a.y;
+        c[3][n] = scale * visible_mass;
+        c[4][n] = scale * visible_b.x;
+        c[5][n] = scale * visible_b.y;
+        c[6][n] = met ? scale * (invisible_a.x + invisible_b.x) : 0;
+        c[7][n] = met ? scale * (invisible_a.y + invisible_b.y) : 0;
+        c[8][n] = scale * invisible_mass;
+        c[9][n] = scale * invisible_mass;
+    }
+}
+
+
+/* Files */
+/* Write `corpus' to `path', returning false on failure. */
+inline bool
+mt2_corpus_write(const struct mt2_corpus *corpus, const char *path)
+{
+    struct mt2_corpus_header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, mt2_corpus_magic, sizeof(header.magic));
+    header.version = 1;
+    header.n_columns = 10;
+    header.n_events = corpus->columns[0].size();
+    header.seed = corpus->seed;
+    std::strncpy(header.name, corpus->name.c_str(), sizeof(header.name) - 1);
+
+    std::FILE *file = std::fopen(path, "wb");
+    if (!file)
+        return false;
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+    for (int j = 0; ok && j < 10; ++j)
+        ok = std::fwrite(corpus->columns[j].data(), sizeof(double),
+                         header.n_events, file) == header.n_events;
+    return std::fclose(file) == 0 && ok;
+}
+
+/* Read `corpus' from `path', returning false on failure. */
+inline bool
+mt2_corpus_read(struct mt2_corpus *corpus, const char *path)
+{
+    std::FILE *file = std::fopen(path, "rb");
+    if (!file)
+        return false;
+    struct mt2_corpus_header header;
+    bool ok = std::fread(&header, sizeof(header), 1, file) == 1
+              && std::memcmp(header.magic, mt2_corpus_magic,
+                             sizeof(header.magic)) == 0
+              && header.version == 1 && header.n_columns == 10;
+    if (ok) {
+        header.name[sizeof(header.name) - 1] = '\0';
+        corpus->name = header.name;
+        corpus->seed = header.seed;
+    }
+    for (int j = 0; ok && j < 10; ++j) {
+        corpus->columns[j].resize(header.n_events);
+        ok = std::fread(corpus->columns[j].data(), sizeof(double),
+                        header.n_events, file) == header.n_events;
+    }
+    std::fclose(file);
+    return ok;
+}
+
+#endif  /* MT2_CORPUS_H */
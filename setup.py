@@ -18,7 +18,10 @@ class _CustomBuildExt(build_ext):
                     "-std=c++11",
                     "-pedantic",
                     "-Werror",
+                    # The ufunc loops can be split across a pool of std::thread.
+                    "-pthread",
                 ]
+                extension.extra_link_args = ["-pthread"]
         super().build_extensions()
 
 
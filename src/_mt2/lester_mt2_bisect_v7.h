@@ -243,12 +243,12 @@ struct EllipseParams {
 };
 
 // This is the interface: users should call this function:
-bool ellipsesAreDisjoint(const EllipseParams & e1, const EllipseParams & e2);
+inline bool ellipsesAreDisjoint(const EllipseParams & e1, const EllipseParams & e2);
 
 // This is an implementation thing: users should not call it:
-bool __private_ellipsesAreDisjoint(const double coeffLamPow3, const double coeffLamPow2, const double coeffLamPow1, const double coeffLamPow0);
+inline bool __private_ellipsesAreDisjoint(const double coeffLamPow3, const double coeffLamPow2, const double coeffLamPow1, const double coeffLamPow0);
 
-bool ellipsesAreDisjoint(const EllipseParams & e1, const EllipseParams & e2) {
+inline bool ellipsesAreDisjoint(const EllipseParams & e1, const EllipseParams & e2) {
   /* We want to construct the polynomial "Det(lambda A + B)" where A and B are the 3x3 matrices associated with e1 and e2, and we want to get that
   polynomial in the form lambda^3 + a lambda^2 + b lambda + c.
 
@@ -274,7 +274,7 @@ bool ellipsesAreDisjoint(const EllipseParams & e1, const EllipseParams & e2) {
     return __private_ellipsesAreDisjoint(coeffLamPow0, coeffLamPow1, coeffLamPow2, coeffLamPow3); // reversed order
   }
 }
-bool __private_ellipsesAreDisjoint(const double coeffLamPow3, const double coeffLamPow2, const double coeffLamPow1, const double coeffLamPow0) {
+inline bool __private_ellipsesAreDisjoint(const double coeffLamPow3, const double coeffLamPow2, const double coeffLamPow1, const double coeffLamPow0) {
 
   // precondition of being called:
   //assert(fabs(coeffLamPow3)>=fabs(coeffLamPow0));
@@ -349,7 +349,8 @@ class asymm_mt2_lester_bisect {
     const double pxMiss, const double pyMiss,
     const double mInvis1, const double mInvis2,
     const double desiredPrecisionOnMT2=0, // This must be non-negative.  If set to zero (default) MT2 will be calculated to the highest precision available on the machine (or as close to that as the algorithm permits).  If set to a positive value, MT2 (note that is MT2, not its square) will be calculated to within +- desiredPrecisionOnMT2. Note that by requesting precision of +- 0.01 GeV on an MT2 value of 100 GeV can result in speedups of a factor of two or three.
-    const bool useDeciSectionsInitially=true // If true, interval is cut at the 10% point until first acceptance, which gives factor 3 increase in speed calculating kinematic min, but 3% slowdown for events in the bulk.  Is on (true) by default, but can be turned off by setting to false.
+    const bool useDeciSectionsInitially=true, // If true, interval is cut at the 10% point until first acceptance, which gives factor 3 increase in speed calculating kinematic min, but 3% slowdown for events in the bulk.  Is on (true) by default, but can be turned off by setting to false.
+    unsigned long long * const tests=0 // If not null, incremented by the number of disjointness tests made.
   ) {
 
     const double mT2_Sq = get_mT2_Sq(
@@ -358,7 +359,8 @@ class asymm_mt2_lester_bisect {
                             pxMiss,pyMiss,
                             mInvis1, mInvis2,
                             desiredPrecisionOnMT2,
-                            useDeciSectionsInitially);
+                            useDeciSectionsInitially,
+                            tests);
     if (mT2_Sq==MT2_ERROR) {
       return MT2_ERROR;
     }
@@ -399,7 +401,8 @@ class asymm_mt2_lester_bisect {
     const double pxMiss, const double pyMiss,
     const double mInvis1, const double mInvis2,
     const double desiredPrecisionOnMT2=0, // This must be non-negative.  If set to zero (default) MT2 will be calculated to the highest precision available on the machine (or as close to that as the algorithm permits).  If set to a positive value, MT2 (note that is MT2, not its square) will be calculated to within +- desiredPrecisionOnMT2. Note that by requesting precision of +- 0.01 GeV on an MT2 value of 100 GeV can resJult in speedups of a factor of ..
-    const bool useDeciSectionsInitially=true // If true, interval is cut at the 10% point until first acceptance, which gives factor 3 increase in speed calculating kinematic min, but 3% slowdown for events in the bulk.  Is on (true) by default, but can be turned off by setting to false.
+    const bool useDeciSectionsInitially=true, // If true, interval is cut at the 10% point until first acceptance, which gives factor 3 increase in speed calculating kinematic min, but 3% slowdown for events in the bulk.  Is on (true) by default, but can be turned off by setting to false.
+    unsigned long long * const tests=0 // If not null, incremented by the number of disjointness tests made.
       ) {
 
 #ifndef DISABLE_COPYRIGHT_PRINTING
@@ -416,7 +419,9 @@ class asymm_mt2_lester_bisect {
                mVis1, pxVis1, pyVis1,
                pxMiss, pyMiss,
                mInvis2, mInvis1,
-               desiredPrecisionOnMT2
+               desiredPrecisionOnMT2,
+               true, // The swapped search keeps the default of useDeciSectionsInitially, as it always has.
+               tests
              );
     }
 
@@ -467,6 +472,7 @@ class asymm_mt2_lester_bisect {
       const Lester::EllipseParams & side2=helper(mUpperSq, mtSq, +tx, +ty, mqSq, pxMiss, pyMiss); // see side2Coeffs in mathematica notebook
 
       bool disjoint;
+      if (tests) ++*tests;
       try {
         disjoint = Lester::ellipsesAreDisjoint(side1, side2);
       } catch (...) {
@@ -511,6 +517,7 @@ class asymm_mt2_lester_bisect {
       const Lester::EllipseParams & side1 = helper(trialMSq, msSq, -sx, -sy, mpSq, 0,      0     ); // see side1Coeffs in mathematica notebook
       const Lester::EllipseParams & side2 = helper(trialMSq, mtSq, +tx, +ty, mqSq, pxMiss, pyMiss); // see side2Coeffs in mathematica notebook
 
+      if (tests) ++*tests;
       try {
         const bool disjoint = Lester::ellipsesAreDisjoint(side1, side2);
         if (disjoint) {
@@ -582,13 +589,13 @@ class asymm_mt2_lester_bisect {
   }
 };
 
-void myversion(){
+inline void myversion(){
 
   std::cout << "Version is : 2014_11_13" << std::endl;
 
 }
 
-double MT(double px1, double px2, double py1, double py2, double m1 , double m2){
+inline double MT(double px1, double px2, double py1, double py2, double m1 , double m2){
   double E1 = sqrt(px1*px1+py1*py1+m1*m1);
   double E2 = sqrt(px2*px2+py2*py2+m2*m2);
   double Msq = (E1+E2)*(E1+E2)-(px1+px2)*(px1+px2)-(py1+py2)*(py1+py2);
@@ -596,7 +603,7 @@ double MT(double px1, double px2, double py1, double py2, double m1 , double m2)
   return sqrt(Msq);
 }
 
-std::pair <double,double>  ben_findsols(double MT2, double px, double py, double visM, double Ma, double pxb, double pyb, double metx, double mety, double visMb, double Mb){
+inline std::pair <double,double>  ben_findsols(double MT2, double px, double py, double visM, double Ma, double pxb, double pyb, double metx, double mety, double visMb, double Mb){
 
   //Visible particle (px,py,visM)
   std::pair <double,double> sols;
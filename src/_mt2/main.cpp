@@ -1,5 +1,17 @@
 #include <Python.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #define NPY_NO_DEPRECATED_API NPY_1_7_API_VERSION
 
 #include <numpy/ndarraytypes.h>
@@ -8,11 +20,135 @@
 
 #include "lester_mt2_bisect_v7.h"
 #include "mt2_Lallyver2.h"
+#include "mt2_arrow.h"
 #include "mt2_bisect.h"
+#include "mt2_bisect_lanes.h"
+#include "mt2_kernel.h"
+#include "mt2_pool.h"
 
 #define STRINGIFY(x) #x
 #define MACRO_STRINGIFY(x) STRINGIFY(x)
 
+/* Arguments of a ufunc inner loop. */
+// const-correctness was introduced in numpy 1.19, but retain backward compatibility.
+#ifdef NPY_1_19_API_VERSION
+#define MT2_LOOP_ARGS char **args, npy_intp const *dimensions, npy_intp const *steps, void *data
+#else
+#define MT2_LOOP_ARGS char **args, npy_intp *dimensions, npy_intp *steps, void *data
+#endif
+
+/*
+ * Number of elements each thread claims at a time, when a loop is split across
+ * threads. This is large enough to amortise claiming, and small enough that
+ * slow events are spread between threads. Elements with core dimensions are
+ * claimed in proportionally smaller chunks, but never fewer than fill the
+ * widest SIMD lanes.
+ */
+#define MT2_THREAD_CHUNK 1024
+#define MT2_THREAD_MIN_CHUNK 16
+
+
+/*
+ * Statistics
+ *
+ * Each loop which computes mt2 tallies its events locally, then adds the
+ * tally to process-wide counters for its engine when it returns. Loops split
+ * across threads return once per chunk, so the counters cost a few atomic
+ * additions per thousand events, and are safe without the GIL.
+ */
+enum mt2_engine
+{
+    mt2_engine_tombs,
+    mt2_engine_lester,
+    mt2_engine_lally,
+    mt2_n_engines
+};
+
+static const char *const mt2_engine_names[mt2_n_engines] = {"tombs", "lester", "lally"};
+
+/* The work of one loop call, for one engine. */
+struct mt2_tally
+{
+    unsigned long long events;
+    unsigned long long tests; // Disjointness tests, which lally does not make.
+    unsigned long long errors; // Negative results, which mean an error.
+    unsigned long long infinities;
+    unsigned long long nans;
+    std::chrono::steady_clock::time_point start;
+};
+
+/* The totals of every tally, with time in nanoseconds summed over threads. */
+struct mt2_counters
+{
+    std::atomic<unsigned long long> events;
+    std::atomic<unsigned long long> tests;
+    std::atomic<unsigned long long> errors;
+    std::atomic<unsigned long long> infinities;
+    std::atomic<unsigned long long> nans;
+    std::atomic<unsigned long long> nanoseconds;
+};
+
+static struct mt2_counters mt2_stats[mt2_n_engines];
+
+static void mt2_tally_start(struct mt2_tally *tally)
+{
+    tally->events = 0;
+    tally->tests = 0;
+    tally->errors = 0;
+    tally->infinities = 0;
+    tally->nans = 0;
+    tally->start = std::chrono::steady_clock::now();
+}
+
+/* Count one event whose result was `result'. */
+static inline void mt2_tally_result(struct mt2_tally *tally, double result)
+{
+    ++tally->events;
+    if (!(result >= 0 && result < std::numeric_limits<double>::infinity()))
+    {
+        if (std::isnan(result))
+            ++tally->nans;
+        else if (result < 0)
+            ++tally->errors;
+        else
+            ++tally->infinities;
+    }
+}
+
+/* Counts each result of a mt2_lane_queue in a mt2_tally. */
+struct mt2_tally_results
+{
+    struct mt2_tally *tally;
+
+    MT2_ALWAYS_INLINE void operator()(double result) const
+    {
+        mt2_tally_result(tally, result);
+    }
+};
+
+/*
+ * Count one event which made `tests' disjointness tests, for loops which
+ * decide something about MT2 without finding it, so have no result to count.
+ */
+static inline void mt2_tally_tests(struct mt2_tally *tally, unsigned tests)
+{
+    ++tally->events;
+    tally->tests += tests;
+}
+
+static void mt2_tally_finish(const struct mt2_tally *tally, enum mt2_engine engine)
+{
+    const auto elapsed = std::chrono::steady_clock::now() - tally->start;
+    struct mt2_counters *counters = &mt2_stats[engine];
+    counters->events.fetch_add(tally->events, std::memory_order_relaxed);
+    counters->tests.fetch_add(tally->tests, std::memory_order_relaxed);
+    counters->errors.fetch_add(tally->errors, std::memory_order_relaxed);
+    counters->infinities.fetch_add(tally->infinities, std::memory_order_relaxed);
+    counters->nans.fetch_add(tally->nans, std::memory_order_relaxed);
+    counters->nanoseconds.fetch_add(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+        std::memory_order_relaxed);
+}
 
 static void mt2_lester_ufunc(
     char **args,
@@ -56,6 +192,9 @@ static void mt2_lester_ufunc(
     const npy_intp useDeciSectionsInitially_step = steps[10];
     const npy_intp out_step = steps[12];
 
+    struct mt2_tally tally;
+    mt2_tally_start(&tally);
+
     for (npy_intp i = 0; i < n; ++i)
     {
         *((double *)out) = asymm_mt2_lester_bisect::get_mT2(
@@ -70,7 +209,9 @@ static void mt2_lester_ufunc(
             *(double *)mInvis1,
             *(double *)mInvis2,
             *(double *)desiredPrecisionOnMT2,
-            *(npy_bool *)useDeciSectionsInitially);
+            *(npy_bool *)useDeciSectionsInitially,
+            &tally.tests);
+        mt2_tally_result(&tally, *(double *)out);
 
         mVis1 += mVis1_step;
         pxVis1 += pxVis1_step;
@@ -86,6 +227,8 @@ static void mt2_lester_ufunc(
         useDeciSectionsInitially += useDeciSectionsInitially_step;
         out += out_step;
     }
+
+    mt2_tally_finish(&tally, mt2_engine_lester);
 }
 
 static void mt2_lally_ufunc(
@@ -128,6 +271,9 @@ static void mt2_lally_ufunc(
     const npy_intp desiredPrecisionOnMT2_step = steps[10];
     const npy_intp out_step = steps[11];
 
+    struct mt2_tally tally;
+    mt2_tally_start(&tally);
+
     for (npy_intp i = 0; i < n; ++i)
     {
         *((double *)out) = mt2_lally(
@@ -142,6 +288,7 @@ static void mt2_lally_ufunc(
             *(double *)mInvis1,
             *(double *)mInvis2,
             *(double *)desiredPrecisionOnMT2);
+        mt2_tally_result(&tally, *(double *)out);
 
         mVis1 += mVis1_step;
         pxVis1 += pxVis1_step;
@@ -156,19 +303,421 @@ static void mt2_lally_ufunc(
         desiredPrecisionOnMT2 += desiredPrecisionOnMT2_step;
         out += out_step;
     }
+
+    mt2_tally_finish(&tally, mt2_engine_lally);
 }
 
-static void mt2_tombs_ufunc(
+/*
+ * The inner loop of mt2_tombs_ufunc, mt2_tombs_hint_ufunc and
+ * mt2_tombs_valid_ufunc, which runs the kernel of mt2_kernel.h with N lanes.
+ */
+template <typename In, typename Out, int N, int G, mt2_method Method, bool Hints, bool Valid>
+static MT2_ALWAYS_INLINE void mt2_tombs_loop(
     char **args,
-// const-correctness was introduced in numpy 1.19, but retain backward compatibility.
-#ifdef NPY_1_19_API_VERSION
     npy_intp const *dimensions,
-    npy_intp const *steps,
-#else
-    npy_intp *dimensions,
-    npy_intp *steps,
-#endif
-    void *data)
+    npy_intp const *steps)
+{
+    struct mt2_tally tally;
+    mt2_tally_start(&tally);
+    const struct mt2_tally_results count = {&tally};
+    tally.tests += mt2_kernel<In, Out, N, G, Method, Hints, Valid>(args, steps, dimensions[0], count);
+    mt2_tally_finish(&tally, mt2_engine_tombs);
+}
+
+MT2_ISA_VARIANTS(mt2_tombs_ufunc, (MT2_LOOP_ARGS),
+                 mt2_tombs_loop<T, T, lanes, 2, Method, false, false>(args, dimensions, steps))
+MT2_ISA_VARIANTS(mt2_tombs_hint_ufunc, (MT2_LOOP_ARGS),
+                 mt2_tombs_loop<T, T, lanes, 2, Method, true, false>(args, dimensions, steps))
+MT2_ISA_VARIANTS(mt2_tombs_valid_ufunc, (MT2_LOOP_ARGS),
+                 mt2_tombs_loop<T, T, lanes, 2, Method, false, true>(args, dimensions, steps))
+
+/*
+ * The inner loop of mt2_scan_ufunc, which has core signature
+ * (),(),(),(),(),(),(),(),(k),()->(k): each event is evaluated with both
+ * invisible masses set to each of k grid values.
+ *
+ * Blocks of up to N*G events have their kinematics prepared once, then step
+ * through the grid together, bisecting in lockstep at each grid point.
+ *
+ * MT2 does not decrease as the invisible masses increase, so an event's final
+ * lower bound at one grid point is also a lower bound at the next, if that is
+ * larger. Its next result is also predicted from the last two, and a narrow
+ * bracket around that prediction is passed as hints. The hints are tested
+ * before use, so any grid order gives correct results; ascending grids are
+ * fastest.
+ */
+template <typename In, typename Out, int N, int G, mt2_method Method>
+static MT2_ALWAYS_INLINE void mt2_scan_loop(
+    char **args,
+    npy_intp const *dimensions,
+    npy_intp const *steps)
+{
+    const npy_intp n = dimensions[0];
+    const npy_intp n_grid = dimensions[1];
+    const npy_intp mInvis_grid_step = steps[11];
+    const npy_intp out_grid_step = steps[12];
+
+    /* As in mt2_kernel_impl. */
+    const double min_precision = std::numeric_limits<Out>::epsilon() / 8;
+
+    /* Relative half-width of the bracket around a prediction, at least. */
+    const double min_spread = 1.0 / (1LL << 40);
+
+    /* Per event in the block. */
+    struct mt2_kinematics<double> kinematics[N * G];
+    double precision[N * G];
+    char *mInvis[N * G];
+    char *out[N * G];
+
+    /*
+     * The last two grid points with finite results, if any, for each event,
+     * and how far the last prediction was from its result.
+     */
+    double m_prev[N * G][2];
+    double mt2_prev[N * G][2];
+    double lo_prev[N * G];
+    int n_prev[N * G];
+    double predicted[N * G];
+    double miss[N * G];
+
+    /* Per event queued for bisection at one grid point. */
+    struct mt2_setup<double> setups[N * G];
+    double precisions[N * G];
+    double lo_hints[N * G];
+    double hi_hints[N * G];
+    double results[N * G];
+    double bracket_lo[N * G];
+    int queued[N * G];
+
+    struct mt2_tally tally;
+    mt2_tally_start(&tally);
+
+    for (npy_intp i0 = 0; i0 < n; i0 += N * G)
+    {
+        const int n_block = n - i0 < N * G ? (int)(n - i0) : N * G;
+
+        for (int b = 0; b < n_block; ++b)
+        {
+            const npy_intp i = i0 + b;
+            mt2_prepare_kinematics(
+                (double)*(In *)(args[0] + i * steps[0]),
+                (double)*(In *)(args[1] + i * steps[1]),
+                (double)*(In *)(args[2] + i * steps[2]),
+                (double)*(In *)(args[3] + i * steps[3]),
+                (double)*(In *)(args[4] + i * steps[4]),
+                (double)*(In *)(args[5] + i * steps[5]),
+                (double)*(In *)(args[6] + i * steps[6]),
+                (double)*(In *)(args[7] + i * steps[7]),
+                &kinematics[b]);
+            mInvis[b] = args[8] + i * steps[8];
+            precision[b] = std::fmax(*(In *)(args[9] + i * steps[9]), min_precision);
+            out[b] = args[10] + i * steps[10];
+            n_prev[b] = 0;
+            miss[b] = std::numeric_limits<double>::quiet_NaN();
+        }
+
+        for (npy_intp k = 0; k < n_grid; ++k)
+        {
+            int n_queued = 0;
+
+            for (int b = 0; b < n_block; ++b)
+            {
+                const double m = (double)*(In *)(mInvis[b] + k * mInvis_grid_step);
+                struct mt2_setup<double> *setup = &setups[n_queued];
+
+                if (!mt2_prepare_masses(&kinematics[b], m, m, setup))
+                {
+                    *(Out *)(out[b] + k * out_grid_step) = (Out)setup->scale;
+                    mt2_tally_result(&tally, setup->scale);
+                    n_prev[b] = 0;
+                    miss[b] = std::numeric_limits<double>::quiet_NaN();
+                    continue;
+                }
+
+                double lo_hint = 0;
+                double hi_hint = 0;
+                predicted[b] = std::numeric_limits<double>::quiet_NaN();
+                if (n_prev[b] > 0)
+                {
+                    /* Extrapolate from the last two results, or guess a unit
+                     * slope from one, and allow for errors like the last. */
+                    const double dm = m - m_prev[b][0];
+                    double slope = 1;
+                    if (n_prev[b] > 1 && m_prev[b][0] != m_prev[b][1])
+                    {
+                        slope = (mt2_prev[b][0] - mt2_prev[b][1]) / (m_prev[b][0] - m_prev[b][1]);
+                    }
+                    const double change = slope * dm;
+                    predicted[b] = mt2_prev[b][0] + change;
+                    const double spread = (
+                        (std::isfinite(miss[b]) ? 4 * miss[b] : std::fabs(change))
+                        + mt2_prev[b][0] * min_spread);
+
+                    const double squeeze = 1 / setup->scale;
+                    if (dm >= 0)
+                    {
+                        setup->lo = std::fmax(setup->lo, lo_prev[b] * squeeze);
+                    }
+                    lo_hint = (predicted[b] - spread) * squeeze;
+                    hi_hint = (predicted[b] + spread) * squeeze;
+                    if (!std::isfinite(lo_hint) || !std::isfinite(hi_hint))
+                    {
+                        lo_hint = 0;
+                        hi_hint = 0;
+                    }
+                }
+
+                precisions[n_queued] = precision[b];
+                lo_hints[n_queued] = lo_hint;
+                hi_hints[n_queued] = hi_hint;
+                queued[n_queued] = b;
+                ++n_queued;
+            }
+
+            if (n_queued == 0)
+                continue;
+
+            tally.tests += mt2_bisect_lanes<double, N, G, Method, true>(
+                setups, precisions, n_queued, results, lo_hints, hi_hints, bracket_lo);
+
+            for (int q = 0; q < n_queued; ++q)
+            {
+                const int b = queued[q];
+                const double m = (double)*(In *)(mInvis[b] + k * mInvis_grid_step);
+                *(Out *)(out[b] + k * out_grid_step) = (Out)results[q];
+                mt2_tally_result(&tally, results[q]);
+
+                if (std::isfinite(results[q]) && std::isfinite(bracket_lo[q]))
+                {
+                    miss[b] = std::fabs(results[q] - predicted[b]);
+                    m_prev[b][1] = m_prev[b][0];
+                    mt2_prev[b][1] = mt2_prev[b][0];
+                    m_prev[b][0] = m;
+                    mt2_prev[b][0] = results[q];
+                    lo_prev[b] = bracket_lo[q];
+                    ++n_prev[b];
+                }
+                else
+                {
+                    n_prev[b] = 0;
+                    miss[b] = std::numeric_limits<double>::quiet_NaN();
+                }
+            }
+        }
+    }
+
+    mt2_tally_finish(&tally, mt2_engine_tombs);
+}
+
+MT2_ISA_VARIANTS(mt2_scan_ufunc, (MT2_LOOP_ARGS),
+                 mt2_scan_loop<T, T, lanes, 2, Method>(args, dimensions, steps))
+
+/*
+ * The inner loop of mt2_rows_ufunc, which has core signature (10),()->(): the
+ * ten arguments of each event are one row of an (n, 10) array.
+ *
+ * If Contiguous, each row is ten adjacent values, as in a C-ordered matrix or
+ * a structured array of ten fields, so the whole row is read from one or two
+ * cache lines. Otherwise the values are a constant stride apart. Events are
+ * then queued and bisected as in mt2_kernel_impl.
+ */
+template <typename In, typename Out, int N, int G, mt2_method Method, bool Contiguous>
+static MT2_ALWAYS_INLINE void mt2_rows_loop_impl(
+    char **args,
+    npy_intp const *dimensions,
+    npy_intp const *steps)
+{
+    const npy_intp column_step = Contiguous ? (npy_intp)sizeof(In) : steps[3];
+
+    /* As in mt2_kernel_impl. */
+    const double min_precision = std::numeric_limits<Out>::epsilon() / 8;
+    double precision = 0;
+
+    struct mt2_kinematics<double> kinematics;
+
+    struct mt2_tally tally;
+    mt2_tally_start(&tally);
+    mt2_lane_queue<Out, N, G, Method, false, mt2_tally_results> queue({&tally});
+
+    tally.tests += mt2_lanes_loop(0, dimensions[0], &queue, [&](npy_intp i) MT2_LAMBDA_INLINE {
+        const char *row = args[0] + i * steps[0];
+        double x[10];
+        for (int k = 0; k < 10; ++k)
+        {
+            x[k] = (double)*(const In *)(row + k * column_step);
+        }
+
+        if (steps[1] != 0 || i == 0)
+        {
+            precision = std::fmax(*(const In *)(args[1] + i * steps[1]), min_precision);
+        }
+
+        mt2_prepare_kinematics(x[0], x[1], x[2], x[3], x[4], x[5], x[6], x[7], &kinematics);
+        queue.add(&kinematics, x[8], x[9], precision, (Out *)(args[2] + i * steps[2]));
+    });
+
+    mt2_tally_finish(&tally, mt2_engine_tombs);
+}
+
+/* Choose the variant of mt2_rows_loop_impl for the layout of the rows. */
+template <typename In, typename Out, int N, int G, mt2_method Method>
+static MT2_ALWAYS_INLINE void mt2_rows_loop(
+    char **args,
+    npy_intp const *dimensions,
+    npy_intp const *steps)
+{
+    if (steps[3] == (npy_intp)sizeof(In))
+        mt2_rows_loop_impl<In, Out, N, G, Method, true>(args, dimensions, steps);
+    else
+        mt2_rows_loop_impl<In, Out, N, G, Method, false>(args, dimensions, steps);
+}
+
+MT2_ISA_VARIANTS(mt2_rows_ufunc, (MT2_LOOP_ARGS),
+                 mt2_rows_loop<T, T, lanes, 2, Method>(args, dimensions, steps))
+
+/* How mt2_vectors_loop reads the visible and missing momenta of an event. */
+enum mt2_inputs
+{
+    mt2_inputs_polar,      // pt, phi, m of each visible particle; magnitude, phi of the missing momentum
+    mt2_inputs_four_vector // E, px, py, pz of each visible particle; magnitude, phi of the missing momentum
+};
+
+/* Return the number of arguments for the momenta of one event, read as Inputs. */
+static constexpr int mt2_n_inputs(mt2_inputs inputs)
+{
+    return inputs == mt2_inputs_polar ? 8 : 10;
+}
+
+/*
+ * Return the mass of the four-vector (e, px, py, pz), or 0 if its squared mass
+ * is negative, as from rounding of a (nearly) massless four-vector.
+ */
+static MT2_ALWAYS_INLINE double mt2_four_vector_mass(double e, double px, double py, double pz)
+{
+    const double m2 = (e - pz) * (e + pz) - px * px - py * py;
+    return m2 < 0 ? 0 : std::sqrt(m2);
+}
+
+/*
+ * Store in `x' the arguments of mt2, up to but excluding the invisible masses,
+ * converted from those of type In at `in' as given by Inputs.
+ */
+template <typename In, mt2_inputs Inputs>
+static MT2_ALWAYS_INLINE void mt2_read_inputs(char *const *in, double *x)
+{
+    int k = 0;
+    for (int vis = 0; vis < 2; ++vis)
+    {
+        if (Inputs == mt2_inputs_polar)
+        {
+            const double pt = (double)*(In *)in[k];
+            const double phi = (double)*(In *)in[k + 1];
+            x[3 * vis] = (double)*(In *)in[k + 2];
+            x[3 * vis + 1] = pt * std::cos(phi);
+            x[3 * vis + 2] = pt * std::sin(phi);
+            k += 3;
+        }
+        else
+        {
+            const double e = (double)*(In *)in[k];
+            const double px = (double)*(In *)in[k + 1];
+            const double py = (double)*(In *)in[k + 2];
+            const double pz = (double)*(In *)in[k + 3];
+            x[3 * vis] = mt2_four_vector_mass(e, px, py, pz);
+            x[3 * vis + 1] = px;
+            x[3 * vis + 2] = py;
+            k += 4;
+        }
+    }
+
+    const double met = (double)*(In *)in[k];
+    const double phi = (double)*(In *)in[k + 1];
+    x[6] = met * std::cos(phi);
+    x[7] = met * std::sin(phi);
+}
+
+/*
+ * The inner loop of mt2_polar_ufunc and mt2_four_vector_ufunc, which take the
+ * momenta of each event as given by Inputs, followed by the invisible masses
+ * and precision as for mt2_tombs_ufunc.
+ *
+ * The momenta are converted to the arguments of mt2 as they are read, so the
+ * conversion costs no passes over memory, and events are then queued and
+ * bisected as in mt2_kernel_impl.
+ */
+template <typename In, typename Out, int N, int G, mt2_method Method, mt2_inputs Inputs>
+static MT2_ALWAYS_INLINE void mt2_vectors_loop(
+    char **args,
+    npy_intp const *dimensions,
+    npy_intp const *steps)
+{
+    const int n_in = mt2_n_inputs(Inputs) + 3;
+
+    /* As in mt2_kernel_impl. */
+    const double min_precision = std::numeric_limits<Out>::epsilon() / 8;
+    double precision = 0;
+
+    struct mt2_kinematics<double> kinematics;
+
+    struct mt2_tally tally;
+    mt2_tally_start(&tally);
+    mt2_lane_queue<Out, N, G, Method, false, mt2_tally_results> queue({&tally});
+
+    tally.tests += mt2_lanes_loop(0, dimensions[0], &queue, [&](npy_intp i) MT2_LAMBDA_INLINE {
+        char *in[n_in];
+        for (int k = 0; k < n_in; ++k)
+        {
+            in[k] = args[k] + i * steps[k];
+        }
+
+        double x[8];
+        mt2_read_inputs<In, Inputs>(in, x);
+
+        if (steps[n_in - 1] != 0 || i == 0)
+        {
+            precision = std::fmax(*(In *)in[n_in - 1], min_precision);
+        }
+
+        mt2_prepare_kinematics(x[0], x[1], x[2], x[3], x[4], x[5], x[6], x[7], &kinematics);
+        queue.add(
+            &kinematics,
+            (double)*(In *)in[n_in - 3],
+            (double)*(In *)in[n_in - 2],
+            precision,
+            (Out *)(args[n_in] + i * steps[n_in]));
+    });
+
+    mt2_tally_finish(&tally, mt2_engine_tombs);
+}
+
+MT2_ISA_VARIANTS(mt2_polar_ufunc, (MT2_LOOP_ARGS),
+                 mt2_vectors_loop<T, T, lanes, 2, Method, mt2_inputs_polar>(args, dimensions, steps))
+MT2_ISA_VARIANTS(mt2_four_vector_ufunc, (MT2_LOOP_ARGS),
+                 mt2_vectors_loop<T, T, lanes, 2, Method, mt2_inputs_four_vector>(args, dimensions, steps))
+
+/*
+ * Return `x' as type Out, rounded down if Down and otherwise up, so that a
+ * bracket stays certified when narrowed to float.
+ */
+template <typename Out, bool Down>
+static Out mt2_round_outward(double x)
+{
+    Out y = (Out)x;
+    if (Down ? (double)y > x : (double)y < x)
+    {
+        const Out infinity = std::numeric_limits<Out>::infinity();
+        y = std::nextafter(y, Down ? -infinity : infinity);
+    }
+    return y;
+}
+
+/*
+ * The inner loop of mt2_bracket_ufunc, which finds a bracket on mt2 with a
+ * limited number of disjointness tests with `mt2_bracket_kinematics', for
+ * arguments of type In.
+ */
+template <typename In>
+static void mt2_bracket_loop(MT2_LOOP_ARGS)
 {
     const npy_intp n = dimensions[0];
 
@@ -182,8 +731,9 @@ static void mt2_tombs_ufunc(
     char *pyMiss = args[7];
     char *mInvis1 = args[8];
     char *mInvis2 = args[9];
-    char *desiredPrecisionOnMT2 = args[10];
-    char *out = args[11];
+    char *maxTests = args[10];
+    char *lo = args[11];
+    char *hi = args[12];
 
     const npy_intp mVis1_step = steps[0];
     const npy_intp pxVis1_step = steps[1];
@@ -195,23 +745,47 @@ static void mt2_tombs_ufunc(
     const npy_intp pyMiss_step = steps[7];
     const npy_intp mInvis1_step = steps[8];
     const npy_intp mInvis2_step = steps[9];
-    const npy_intp desiredPrecisionOnMT2_step = steps[10];
-    const npy_intp out_step = steps[11];
+    const npy_intp maxTests_step = steps[10];
+    const npy_intp lo_step = steps[11];
+    const npy_intp hi_step = steps[12];
+
+    struct mt2_kinematics<double> kinematics;
+    struct mt2_tally tally;
+    mt2_tally_start(&tally);
 
     for (npy_intp i = 0; i < n; ++i)
     {
-        *((double *)out) = mt2_bisect_impl(
-            *(double *)mVis1,
-            *(double *)pxVis1,
-            *(double *)pyVis1,
-            *(double *)mVis2,
-            *(double *)pxVis2,
-            *(double *)pyVis2,
-            *(double *)pxMiss,
-            *(double *)pyMiss,
-            *(double *)mInvis1,
-            *(double *)mInvis2,
-            *(double *)desiredPrecisionOnMT2);
+        mt2_prepare_kinematics(
+            (double)*(In *)mVis1,
+            (double)*(In *)pxVis1,
+            (double)*(In *)pyVis1,
+            (double)*(In *)mVis2,
+            (double)*(In *)pxVis2,
+            (double)*(In *)pyVis2,
+            (double)*(In *)pxMiss,
+            (double)*(In *)pyMiss,
+            &kinematics);
+
+        /* Clamp the budget to what an int holds, rather than truncating it. */
+        const npy_int64 budget = std::min<npy_int64>(
+            std::max<npy_int64>(*(npy_int64 *)maxTests, 0),
+            std::numeric_limits<int>::max());
+
+        double bracket_lo, bracket_hi;
+        const int tests = mt2_bracket_kinematics(
+            &kinematics,
+            (double)*(In *)mInvis1,
+            (double)*(In *)mInvis2,
+            (int)budget,
+            &bracket_lo,
+            &bracket_hi);
+
+        /* The lower bound is NAN where MT2 is, and never infinite. */
+        mt2_tally_result(&tally, bracket_lo);
+        tally.tests += tests;
+
+        *((In *)lo) = mt2_round_outward<In, true>(bracket_lo);
+        *((In *)hi) = mt2_round_outward<In, false>(bracket_hi);
 
         mVis1 += mVis1_step;
         pxVis1 += pxVis1_step;
@@ -223,103 +797,2034 @@ static void mt2_tombs_ufunc(
         pyMiss += pyMiss_step;
         mInvis1 += mInvis1_step;
         mInvis2 += mInvis2_step;
-        desiredPrecisionOnMT2 += desiredPrecisionOnMT2_step;
-        out += out_step;
+        maxTests += maxTests_step;
+        lo += lo_step;
+        hi += hi_step;
     }
-}
 
-/* This a pointer to mt2_lester_ufunc */
-PyUFuncGenericFunction mt2_lester_ufuncs[1] = {&mt2_lester_ufunc};
+    mt2_tally_finish(&tally, mt2_engine_tombs);
+}
 
-/* These are the input and return dtypes of mt2_lester_ufunc.*/
-static char mt2_lester_types[13] = {
-    NPY_DOUBLE, // double mVis1,
-    NPY_DOUBLE, // double pxVis1,
-    NPY_DOUBLE, // double pyVis1,
-    NPY_DOUBLE, // double mVis2,
-    NPY_DOUBLE, // double pxVis2,
-    NPY_DOUBLE, // double pyVis2,
-    NPY_DOUBLE, // double pxMiss,
-    NPY_DOUBLE, // double pyMiss,
-    NPY_DOUBLE, // double mInvis1,
-    NPY_DOUBLE, // double mInvis2,
-    NPY_DOUBLE, // double desiredPrecisionOnMT2 = 0
-    NPY_BOOL,   // bool useDeciSectionsInitially=true
-    NPY_DOUBLE  // <result>
-};
+/* Return `count' as a uint16 output, saturating rather than wrapping. */
+static npy_uint16 mt2_saturate_uint16(unsigned count)
+{
+    return count < 65535 ? (npy_uint16)count : 65535;
+}
 
-/* This a pointer to mt2_lally_ufunc */
-PyUFuncGenericFunction mt2_lally_ufuncs[1] = {&mt2_lally_ufunc};
+/*
+ * The inner loop of mt2_diagnostics_ufunc, which finds mt2 for arguments of
+ * type In one event at a time, and also writes how the search ended and the
+ * work it took.
+ *
+ * Counts only make sense per event, so this does not use lanes.
+ */
+template <typename In, mt2_method Method>
+static void mt2_diagnostics_loop(MT2_LOOP_ARGS)
+{
+    const npy_intp n = dimensions[0];
 
-/* These are the input and return dtypes of mt2_lally_ufunc.*/
-static char mt2_lally_types[12] = {
-    NPY_DOUBLE, // double mVis1,
-    NPY_DOUBLE, // double pxVis1,
-    NPY_DOUBLE, // double pyVis1,
-    NPY_DOUBLE, // double mVis2,
-    NPY_DOUBLE, // double pxVis2,
-    NPY_DOUBLE, // double pyVis2,
-    NPY_DOUBLE, // double pxMiss,
-    NPY_DOUBLE, // double pyMiss,
-    NPY_DOUBLE, // double mInvis1,
-    NPY_DOUBLE, // double mInvis2,
-    NPY_DOUBLE, // double desiredPrecisionOnMT2 = 0
-    NPY_DOUBLE  // <result>
-};
+    char *mVis1 = args[0];
+    char *pxVis1 = args[1];
+    char *pyVis1 = args[2];
+    char *mVis2 = args[3];
+    char *pxVis2 = args[4];
+    char *pyVis2 = args[5];
+    char *pxMiss = args[6];
+    char *pyMiss = args[7];
+    char *mInvis1 = args[8];
+    char *mInvis2 = args[9];
+    char *precision = args[10];
+    char *out = args[11];
+    char *status = args[12];
+    char *expansions = args[13];
+    char *tests = args[14];
 
-/* This a pointer to mt2_tombs_ufunc */
-PyUFuncGenericFunction mt2_tombs_ufuncs[1] = {&mt2_tombs_ufunc};
+    const npy_intp mVis1_step = steps[0];
+    const npy_intp pxVis1_step = steps[1];
+    const npy_intp pyVis1_step = steps[2];
+    const npy_intp mVis2_step = steps[3];
+    const npy_intp pxVis2_step = steps[4];
+    const npy_intp pyVis2_step = steps[5];
+    const npy_intp pxMiss_step = steps[6];
+    const npy_intp pyMiss_step = steps[7];
+    const npy_intp mInvis1_step = steps[8];
+    const npy_intp mInvis2_step = steps[9];
+    const npy_intp precision_step = steps[10];
+    const npy_intp out_step = steps[11];
+    const npy_intp status_step = steps[12];
+    const npy_intp expansions_step = steps[13];
+    const npy_intp tests_step = steps[14];
 
-/* These are the input and return dtypes of mt2_tombs_ufunc.*/
-static char mt2_tombs_types[12] = {
-    NPY_DOUBLE, // double mVis1,
-    NPY_DOUBLE, // double pxVis1,
-    NPY_DOUBLE, // double pyVis1,
-    NPY_DOUBLE, // double mVis2,
-    NPY_DOUBLE, // double pxVis2,
-    NPY_DOUBLE, // double pyVis2,
-    NPY_DOUBLE, // double pxMiss,
-    NPY_DOUBLE, // double pyMiss,
-    NPY_DOUBLE, // double mInvis1,
-    NPY_DOUBLE, // double mInvis2,
-    NPY_DOUBLE, // double desiredPrecisionOnMT2 = 0
-    NPY_DOUBLE  // <result>
-};
+    /* As in mt2_kernel_impl. */
+    const double min_precision = std::numeric_limits<In>::epsilon() / 8;
 
-PyDoc_STRVAR(mt2_module_doc, "Provides the mt2 stransverse mass ufunc.");
+    struct mt2_setup<double> setup;
 
-static PyMethodDef methods[] = {
-    {NULL, NULL, 0, NULL}};
+    struct mt2_tally tally;
+    mt2_tally_start(&tally);
 
-static struct PyModuleDef moduledef = {
-    PyModuleDef_HEAD_INIT,
-    "_mt2",
-    mt2_module_doc,
-    -1,
-    methods,
-    NULL,
-    NULL,
-    NULL,
-    NULL};
+    for (npy_intp i = 0; i < n; ++i)
+    {
+        struct mt2_diagnostics diagnostics = {mt2_status_ok, 0, 0};
+        double result;
 
-static void *data[1] = {NULL};
+        if (mt2_prepare(
+                (double)*(In *)mVis1,
+                (double)*(In *)pxVis1,
+                (double)*(In *)pyVis1,
+                (double)*(In *)mVis2,
+                (double)*(In *)pxVis2,
+                (double)*(In *)pyVis2,
+                (double)*(In *)pxMiss,
+                (double)*(In *)pyMiss,
+                (double)*(In *)mInvis1,
+                (double)*(In *)mInvis2,
+                &setup))
+        {
+            result = (Method == mt2_method_brent ? mt2_brent_setup<double> : mt2_bisect_setup<double>)(
+                &setup, std::fmax((double)*(In *)precision, min_precision), 0, 0, NULL, &diagnostics);
+        }
+        else
+        {
+            result = setup.scale;
+            diagnostics.status = result == 0 ? mt2_status_zero : mt2_status_nan_input;
+        }
 
-PyMODINIT_FUNC PyInit__mt2(void)
-{
-    PyObject *module = PyModule_Create(&moduledef);
-    if (!module)
-    {
-        return NULL;
-    }
+        *((In *)out) = (In)result;
+        mt2_tally_result(&tally, result);
+        tally.tests += diagnostics.tests;
+        *((npy_uint8 *)status) = (npy_uint8)diagnostics.status;
+        *((npy_uint16 *)expansions) = mt2_saturate_uint16(diagnostics.expansions);
+        *((npy_uint16 *)tests) = mt2_saturate_uint16(diagnostics.tests);
 
-#ifdef Py_GIL_DISABLED
-    PyUnstable_Module_SetGIL(module, Py_MOD_GIL_NOT_USED);
+        mVis1 += mVis1_step;
+        pxVis1 += pxVis1_step;
+        pyVis1 += pyVis1_step;
+        mVis2 += mVis2_step;
+        pxVis2 += pxVis2_step;
+        pyVis2 += pyVis2_step;
+        pxMiss += pxMiss_step;
+        pyMiss += pyMiss_step;
+        mInvis1 += mInvis1_step;
+        mInvis2 += mInvis2_step;
+        precision += precision_step;
+        out += out_step;
+        status += status_step;
+        expansions += expansions_step;
+        tests += tests_step;
+    }
+
+    mt2_tally_finish(&tally, mt2_engine_tombs);
+}
+
+/*
+ * Combinatorial MT2
+ *
+ * mt2_combinatorial_ufunc finds, for each event, the least MT2 over all ways
+ * of splitting its visible objects into two non-empty legs, each the sum of
+ * its objects' four-vectors. The objects of all events are the core dimension
+ * of the first four arguments, and each event takes those from its start to
+ * its stop index, so that jagged data is read where it lies.
+ *
+ * Each pairing is bounded below by the masses of its legs, as `lo' is in
+ * mt2_prepare_masses. Pairings are visited in order of that bound, and the
+ * search stops once it reaches the best MT2 so far. Before finding MT2 of a
+ * pairing, one disjointness test at the best so far rules it out if it is
+ * above, and otherwise bounds the search from above.
+ */
+#define MT2_MAX_OBJECTS 16
+
+struct mt2_pairing
+{
+    double lower;   // A lower bound on MT2 for the pairing
+    npy_int64 mask; // whose first leg has the objects of the set bits,
+    struct mt2_kinematics<double> kinematics; // and its kinematics.
+};
+
+/*
+ * Order pairings by their lower bound, with those whose bound is NAN (as when
+ * the masses of both legs are) last, so that the order is strict weak.
+ */
+static bool mt2_pairing_less(const struct mt2_pairing &a, const struct mt2_pairing &b)
+{
+    return a.lower < b.lower || (std::isnan(b.lower) && !std::isnan(a.lower));
+}
+
+/*
+ * Store in `*kinematics' those of the pairing given by `mask' of the `n'
+ * objects, each (e, px, py, pz).
+ */
+static void mt2_pairing_kinematics(
+    const double (*objects)[4],
+    int n,
+    npy_int64 mask,
+    double pxMiss,
+    double pyMiss,
+    struct mt2_kinematics<double> *kinematics)
+{
+    double a[4] = {0, 0, 0, 0};
+    double b[4] = {0, 0, 0, 0};
+    for (int j = 0; j < n; ++j)
+    {
+        double *leg = (mask >> j) & 1 ? a : b;
+        for (int c = 0; c < 4; ++c)
+        {
+            leg[c] += objects[j][c];
+        }
+    }
+
+    mt2_prepare_kinematics(
+        mt2_four_vector_mass(a[0], a[1], a[2], a[3]), a[1], a[2],
+        mt2_four_vector_mass(b[0], b[1], b[2], b[3]), b[1], b[2],
+        pxMiss, pyMiss, kinematics);
+}
+
+/*
+ * Return the least MT2 over pairings of the `n' objects, each (e, px, py,
+ * pz), and store the mask of the pairing which has it in `*best_mask'.
+ * Pairings whose MT2 is NAN are ignored; if all are, return NAN and store -1.
+ *
+ * With equal invisible masses, swapping the legs leaves MT2 unchanged, so
+ * only pairings with the last object in the second leg are tried.
+ */
+template <mt2_method Method>
+static double mt2_combinatorial_event(
+    const double (*objects)[4],
+    int n,
+    double pxMiss,
+    double pyMiss,
+    double mInvis1,
+    double mInvis2,
+    double precision,
+    std::vector<struct mt2_pairing> *pairings,
+    npy_int64 *best_mask,
+    struct mt2_tally *tally)
+{
+    mInvis1 = std::fmax(mInvis1, 0);
+    mInvis2 = std::fmax(mInvis2, 0);
+    const npy_int64 n_masks = mInvis1 == mInvis2 ? (npy_int64)1 << (n - 1) : ((npy_int64)1 << n) - 1;
+
+    pairings->clear();
+    for (npy_int64 mask = 1; mask < n_masks; ++mask)
+    {
+        struct mt2_pairing pairing;
+        mt2_pairing_kinematics(objects, n, mask, pxMiss, pyMiss, &pairing.kinematics);
+        pairing.lower = std::fmax(pairing.kinematics.am + mInvis1, pairing.kinematics.bm + mInvis2);
+        pairing.mask = mask;
+        pairings->push_back(pairing);
+    }
+    std::sort(pairings->begin(), pairings->end(), &mt2_pairing_less);
+
+    double best = std::numeric_limits<double>::infinity();
+    *best_mask = -1;
+    for (const struct mt2_pairing &pairing : *pairings)
+    {
+        if (pairing.lower >= best)
+        {
+            break;
+        }
+
+        struct mt2_setup<double> setup;
+        double result;
+        if (!mt2_prepare_masses(&pairing.kinematics, mInvis1, mInvis2, &setup))
+        {
+            result = setup.scale;
+        }
+        else
+        {
+            /* In the squeezed units of the setup, as for hints. A test that
+             * fails here would fail again in the search, whose MT2 would be
+             * NAN, so the pairing is ignored either way. */
+            double hi_hint = 0;
+            if (*best_mask >= 0 && best < std::numeric_limits<double>::infinity())
+            {
+                hi_hint = best / setup.scale;
+                bool error;
+                const bool above = mt2_above_setup(&setup, hi_hint, &error);
+                ++tally->tests;
+                if (above || error)
+                {
+                    continue;
+                }
+            }
+
+            struct mt2_diagnostics diagnostics = {mt2_status_ok, 0, 0};
+            result = (Method == mt2_method_brent ? mt2_brent_setup<double> : mt2_bisect_setup<double>)(
+                &setup, precision, 0, hi_hint, NULL, &diagnostics);
+            tally->tests += diagnostics.tests;
+        }
+
+        if (result < best || (*best_mask < 0 && result == best))
+        {
+            best = result;
+            *best_mask = pairing.mask;
+        }
+    }
+
+    return *best_mask < 0 ? std::numeric_limits<double>::quiet_NaN() : best;
+}
+
+/*
+ * The inner loop of mt2_combinatorial_ufunc, for arguments of type In.
+ *
+ * Events whose indices are out of range, or which have fewer than two or more
+ * than MT2_MAX_OBJECTS objects, give NAN and a mask of -1.
+ */
+template <typename In, mt2_method Method>
+static void mt2_combinatorial_loop(MT2_LOOP_ARGS)
+{
+    const npy_intp n = dimensions[0];
+    const npy_intp n_objects = dimensions[1];
+
+    char *e = args[0];
+    char *px = args[1];
+    char *py = args[2];
+    char *pz = args[3];
+    char *start = args[4];
+    char *stop = args[5];
+    char *pxMiss = args[6];
+    char *pyMiss = args[7];
+    char *mInvis1 = args[8];
+    char *mInvis2 = args[9];
+    char *desiredPrecisionOnMT2 = args[10];
+    char *out = args[11];
+    char *mask = args[12];
+
+    /* Core strides, between the objects, follow the steps between events. */
+    const npy_intp e_stride = steps[13];
+    const npy_intp px_stride = steps[14];
+    const npy_intp py_stride = steps[15];
+    const npy_intp pz_stride = steps[16];
+
+    /* As in mt2_kernel_impl. */
+    const double min_precision = std::numeric_limits<In>::epsilon() / 8;
+
+    double objects[MT2_MAX_OBJECTS][4];
+    std::vector<struct mt2_pairing> pairings;
+
+    struct mt2_tally tally;
+    mt2_tally_start(&tally);
+
+    for (npy_intp i = 0; i < n; ++i)
+    {
+        const npy_int64 begin = *(npy_int64 *)start;
+        const npy_int64 end = *(npy_int64 *)stop;
+        double result = std::numeric_limits<double>::quiet_NaN();
+        npy_int64 best_mask = -1;
+
+        if (0 <= begin && begin <= end && end <= n_objects && end - begin >= 2 && end - begin <= MT2_MAX_OBJECTS)
+        {
+            const int count = (int)(end - begin);
+            for (int j = 0; j < count; ++j)
+            {
+                objects[j][0] = (double)*(In *)(e + (begin + j) * e_stride);
+                objects[j][1] = (double)*(In *)(px + (begin + j) * px_stride);
+                objects[j][2] = (double)*(In *)(py + (begin + j) * py_stride);
+                objects[j][3] = (double)*(In *)(pz + (begin + j) * pz_stride);
+            }
+            result = mt2_combinatorial_event<Method>(
+                objects,
+                count,
+                (double)*(In *)pxMiss,
+                (double)*(In *)pyMiss,
+                (double)*(In *)mInvis1,
+                (double)*(In *)mInvis2,
+                std::fmax(*(In *)desiredPrecisionOnMT2, min_precision),
+                &pairings,
+                &best_mask,
+                &tally);
+        }
+
+        *((In *)out) = (In)result;
+        *((npy_int64 *)mask) = best_mask;
+        mt2_tally_result(&tally, result);
+
+        e += steps[0];
+        px += steps[1];
+        py += steps[2];
+        pz += steps[3];
+        start += steps[4];
+        stop += steps[5];
+        pxMiss += steps[6];
+        pyMiss += steps[7];
+        mInvis1 += steps[8];
+        mInvis2 += steps[9];
+        desiredPrecisionOnMT2 += steps[10];
+        out += steps[11];
+        mask += steps[12];
+    }
+
+    mt2_tally_finish(&tally, mt2_engine_tombs);
+}
+
+/*
+ * The inner loop of mt2_above_ufunc, which tests whether mt2 is above a
+ * threshold with `mt2_above_kinematics', for arguments of type In.
+ *
+ * Most events are settled by cheap bounds, and the rest by one disjointness
+ * test, so there is nothing to gain from lanes.
+ */
+template <typename In>
+static void mt2_above_loop(MT2_LOOP_ARGS)
+{
+    const npy_intp n = dimensions[0];
+
+    char *mVis1 = args[0];
+    char *pxVis1 = args[1];
+    char *pyVis1 = args[2];
+    char *mVis2 = args[3];
+    char *pxVis2 = args[4];
+    char *pyVis2 = args[5];
+    char *pxMiss = args[6];
+    char *pyMiss = args[7];
+    char *mInvis1 = args[8];
+    char *mInvis2 = args[9];
+    char *threshold = args[10];
+    char *out = args[11];
+
+    const npy_intp mVis1_step = steps[0];
+    const npy_intp pxVis1_step = steps[1];
+    const npy_intp pyVis1_step = steps[2];
+    const npy_intp mVis2_step = steps[3];
+    const npy_intp pxVis2_step = steps[4];
+    const npy_intp pyVis2_step = steps[5];
+    const npy_intp pxMiss_step = steps[6];
+    const npy_intp pyMiss_step = steps[7];
+    const npy_intp mInvis1_step = steps[8];
+    const npy_intp mInvis2_step = steps[9];
+    const npy_intp threshold_step = steps[10];
+    const npy_intp out_step = steps[11];
+
+    struct mt2_kinematics<double> kinematics;
+    struct mt2_tally tally;
+    mt2_tally_start(&tally);
+
+    for (npy_intp i = 0; i < n; ++i)
+    {
+        mt2_prepare_kinematics(
+            (double)*(In *)mVis1,
+            (double)*(In *)pxVis1,
+            (double)*(In *)pyVis1,
+            (double)*(In *)mVis2,
+            (double)*(In *)pxVis2,
+            (double)*(In *)pyVis2,
+            (double)*(In *)pxMiss,
+            (double)*(In *)pyMiss,
+            &kinematics);
+
+        struct mt2_diagnostics diagnostics = {mt2_status_ok, 0, 0};
+        *((npy_bool *)out) = mt2_above_kinematics(
+            &kinematics,
+            (double)*(In *)mInvis1,
+            (double)*(In *)mInvis2,
+            (double)*(In *)threshold,
+            &diagnostics);
+        mt2_tally_tests(&tally, diagnostics.tests);
+
+        mVis1 += mVis1_step;
+        pxVis1 += pxVis1_step;
+        pyVis1 += pyVis1_step;
+        mVis2 += mVis2_step;
+        pxVis2 += pxVis2_step;
+        pyVis2 += pyVis2_step;
+        pxMiss += pxMiss_step;
+        pyMiss += pyMiss_step;
+        mInvis1 += mInvis1_step;
+        mInvis2 += mInvis2_step;
+        threshold += threshold_step;
+        out += out_step;
+    }
+
+    mt2_tally_finish(&tally, mt2_engine_tombs);
+}
+
+/*
+ * Threads
+ *
+ * Every loop but those of mt2_lester_ufunc and mt2_lally_ufunc may be split
+ * across threads. Loops are run on the calling thread alone unless more
+ * threads are asked for, either globally with set_num_threads, or for calls
+ * from the current thread with _set_call_threads (which is what
+ * `mt2(..., threads=n)' and the `threads' arguments of the other functions
+ * use).
+ *
+ * Likewise, _set_call_method chooses the mt2_method for calls from the current
+ * thread (as `mt2(..., method=...)').
+ */
+static std::atomic<int> mt2_num_threads(1);
+static thread_local int mt2_call_threads = 0; // 0 when not overridden
+static thread_local mt2_method mt2_call_method = mt2_method_bisect;
+
+/* Names of each mt2_method, for Python. */
+static const char *mt2_method_names[mt2_n_methods] = {"bisect", "brent"};
+
+/* Threads to use for a loop run from this thread. */
+static int mt2_threads(void)
+{
+    return mt2_call_threads > 0 ? mt2_call_threads : mt2_num_threads.load(std::memory_order_relaxed);
+}
+
+/*
+ * A single-threaded loop for each mt2_method, with its number of arguments
+ * (inputs and outputs), and of dimensions (one, plus any core dimensions of a
+ * generalized ufunc).
+ */
+struct mt2_loop
+{
+    PyUFuncGenericFunction serial[mt2_n_methods];
+    int nargs;
+    int ndims;
+};
+
+#define MT2_MAX_ARGS 16
+#define MT2_MAX_DIMS 4
+
+struct mt2_parallel_job
+{
+    const struct mt2_loop *loop;
+    PyUFuncGenericFunction serial;
+    char **args;
+    const npy_intp *dimensions;
+    const npy_intp *steps;
+};
+
+/* Run the serial loop of a mt2_parallel_job over elements [begin, end). */
+static void mt2_parallel_task(void *context, std::ptrdiff_t begin, std::ptrdiff_t end)
+{
+    const struct mt2_parallel_job *job = (const struct mt2_parallel_job *)context;
+
+    char *args[MT2_MAX_ARGS];
+    for (int k = 0; k < job->loop->nargs; ++k)
+    {
+        args[k] = job->args[k] + begin * job->steps[k];
+    }
+    npy_intp dimensions[MT2_MAX_DIMS] = {(npy_intp)(end - begin)};
+    for (int d = 1; d < job->loop->ndims; ++d)
+    {
+        dimensions[d] = job->dimensions[d];
+    }
+
+    job->serial(args, dimensions, (npy_intp *)job->steps, NULL);
+}
+
+/*
+ * Split the serial loop given as `data', a mt2_loop, across threads. The
+ * method is chosen here, as workers do not share the caller's choice.
+ *
+ * The loops never touch Python objects, and numpy releases the GIL around
+ * them, so the workers can run freely.
+ */
+static void mt2_parallel_ufunc(MT2_LOOP_ARGS)
+{
+    const struct mt2_loop *loop = (const struct mt2_loop *)data;
+    const PyUFuncGenericFunction serial = loop->serial[mt2_call_method];
+    const int n_threads = mt2_threads();
+
+    /* Elements with core dimensions do proportionally more work, but chunks
+     * should still fill the SIMD lanes. */
+    npy_intp chunk = MT2_THREAD_CHUNK;
+    for (int d = 1; d < loop->ndims; ++d)
+    {
+        chunk /= dimensions[d] > 0 ? dimensions[d] : 1;
+    }
+    chunk = chunk > MT2_THREAD_MIN_CHUNK ? chunk : MT2_THREAD_MIN_CHUNK;
+
+    if (n_threads <= 1 || dimensions[0] <= chunk)
+    {
+        serial(args, dimensions, steps, NULL);
+        return;
+    }
+
+    struct mt2_parallel_job job = {loop, serial, args, dimensions, steps};
+    mt2_process_pool()->run(n_threads, dimensions[0], chunk, &mt2_parallel_task, &job);
+}
+
+/*
+ * Histograms
+ *
+ * mt2_histogram_ufunc is a generalized ufunc whose core dimension is the
+ * events themselves, so that each call reduces them to a histogram with no
+ * output per event. Each event is tested only until its bin is known, with
+ * mt2_count_at_or_below_kinematics. As in numpy.histogram, each bin includes
+ * its left edge, and the last its right edge too.
+ *
+ * The events are split across threads within the loop, each chunk filling a
+ * histogram of its own before adding it to the total.
+ */
+struct mt2_histogram_job
+{
+    char *args[11]; // The event arguments and weights,
+    npy_intp steps[11]; // and their strides between events.
+    const double *edges;
+    int n_edges;
+    double *counts;
+    std::mutex mutex;
+};
+
+template <typename In>
+static void mt2_histogram_task(void *context, std::ptrdiff_t begin, std::ptrdiff_t end)
+{
+    struct mt2_histogram_job *job = (struct mt2_histogram_job *)context;
+    const int n_bins = job->n_edges - 1;
+    std::vector<double> counts(n_bins, 0.0);
+    struct mt2_kinematics<double> kinematics;
+    struct mt2_tally tally;
+    mt2_tally_start(&tally);
+
+    for (std::ptrdiff_t i = begin; i < end; ++i)
+    {
+        const char *arg[11];
+        for (int a = 0; a < 11; ++a)
+        {
+            arg[a] = job->args[a] + i * job->steps[a];
+        }
+
+        mt2_prepare_kinematics(
+            (double)*(const In *)arg[0],
+            (double)*(const In *)arg[1],
+            (double)*(const In *)arg[2],
+            (double)*(const In *)arg[3],
+            (double)*(const In *)arg[4],
+            (double)*(const In *)arg[5],
+            (double)*(const In *)arg[6],
+            (double)*(const In *)arg[7],
+            &kinematics);
+
+        const double mInvis1 = (double)*(const In *)arg[8];
+        const double mInvis2 = (double)*(const In *)arg[9];
+        struct mt2_diagnostics diagnostics = {mt2_status_ok, 0, 0};
+        int k = mt2_count_at_or_below_kinematics(&kinematics, mInvis1, mInvis2, job->edges, job->n_edges, &diagnostics);
+
+        /* MT2 at the last edge is in the last bin, but not above it. */
+        if (k == job->n_edges && !mt2_above_kinematics(&kinematics, mInvis1, mInvis2, job->edges[n_bins], &diagnostics))
+        {
+            k = n_bins;
+        }
+        mt2_tally_tests(&tally, diagnostics.tests);
+
+        if (k > 0 && k <= n_bins)
+        {
+            counts[k - 1] += *(const double *)arg[10];
+        }
+    }
+
+    mt2_tally_finish(&tally, mt2_engine_tombs);
+
+    std::lock_guard<std::mutex> lock(job->mutex);
+    for (int b = 0; b < n_bins; ++b)
+    {
+        job->counts[b] += counts[b];
+    }
+}
+
+/*
+ * The loop of mt2_histogram_ufunc, with signature
+ * (n),(n),(n),(n),(n),(n),(n),(n),(n),(n),(n),(e)->(k), for event arguments
+ * of type In. The eleventh argument is the weight of each event, and k must
+ * be e - 1.
+ */
+template <typename In>
+static void mt2_histogram_loop(MT2_LOOP_ARGS)
+{
+    const npy_intp n_outer = dimensions[0];
+    const npy_intp n = dimensions[1];
+    const npy_intp n_bins = dimensions[3] < dimensions[2] - 1 ? dimensions[3] : dimensions[2] - 1;
+    if (n_bins <= 0)
+        return;
+
+    const npy_intp *core_steps = steps + 13;
+    std::vector<double> edges(n_bins + 1);
+    std::vector<double> counts(n_bins);
+    const int n_threads = mt2_threads();
+
+    for (npy_intp o = 0; o < n_outer; ++o)
+    {
+        struct mt2_histogram_job job;
+        for (int a = 0; a < 11; ++a)
+        {
+            job.args[a] = args[a] + o * steps[a];
+            job.steps[a] = core_steps[a];
+        }
+        for (npy_intp e = 0; e <= n_bins; ++e)
+        {
+            edges[e] = *(double *)(args[11] + o * steps[11] + e * core_steps[11]);
+        }
+        std::fill(counts.begin(), counts.end(), 0.0);
+        job.edges = edges.data();
+        job.n_edges = (int)(n_bins + 1);
+        job.counts = counts.data();
+
+        if (n_threads <= 1 || n <= MT2_THREAD_CHUNK)
+            mt2_histogram_task<In>(&job, 0, n);
+        else
+            mt2_process_pool()->run(n_threads, n, MT2_THREAD_CHUNK, &mt2_histogram_task<In>, &job);
+
+        for (npy_intp b = 0; b < n_bins; ++b)
+        {
+            *(double *)(args[12] + o * steps[12] + b * core_steps[12]) = counts[b];
+        }
+    }
+}
+
+/*
+ * Selections
+ *
+ * mt2_select_ufunc is a generalized ufunc whose core dimension is the events
+ * themselves, and which writes the indices of those events whose mt2 is
+ * within a window, in order, rather than a result for each. Each event is
+ * tested against the window with mt2_above_kinematics, so is usually settled
+ * by cheap bounds, and otherwise by a disjointness test at each edge.
+ *
+ * As for histograms, the events are split across threads within the loop.
+ * Each chunk writes its indices from its own start, and they are moved
+ * together once all chunks are done.
+ */
+struct mt2_select_job
+{
+    char *args[10]; // The event arguments,
+    npy_intp steps[10]; // and their strides between events.
+    double lo;
+    double hi;
+    char *out;
+    npy_intp out_step;
+    npy_intp *counts; // The number selected in each chunk of MT2_THREAD_CHUNK.
+};
+
+template <typename In>
+static void mt2_select_task(void *context, std::ptrdiff_t begin, std::ptrdiff_t end)
+{
+    const struct mt2_select_job *job = (const struct mt2_select_job *)context;
+    struct mt2_kinematics<double> kinematics;
+    struct mt2_tally tally;
+    mt2_tally_start(&tally);
+
+    /* The pool may run the whole range at once, so count by chunk here. */
+    for (std::ptrdiff_t chunk = begin; chunk < end; chunk += MT2_THREAD_CHUNK)
+    {
+        const std::ptrdiff_t chunk_end = std::min<std::ptrdiff_t>(chunk + MT2_THREAD_CHUNK, end);
+        npy_intp count = 0;
+
+        for (std::ptrdiff_t i = chunk; i < chunk_end; ++i)
+        {
+            const char *arg[10];
+            for (int a = 0; a < 10; ++a)
+            {
+                arg[a] = job->args[a] + i * job->steps[a];
+            }
+
+            mt2_prepare_kinematics(
+                (double)*(const In *)arg[0],
+                (double)*(const In *)arg[1],
+                (double)*(const In *)arg[2],
+                (double)*(const In *)arg[3],
+                (double)*(const In *)arg[4],
+                (double)*(const In *)arg[5],
+                (double)*(const In *)arg[6],
+                (double)*(const In *)arg[7],
+                &kinematics);
+
+            const double mInvis1 = (double)*(const In *)arg[8];
+            const double mInvis2 = (double)*(const In *)arg[9];
+
+            /* As mt2 > lo and mt2 <= hi; neither holds where mt2 is NAN. */
+            struct mt2_diagnostics diagnostics = {mt2_status_ok, 0, 0};
+            if (mt2_above_kinematics(&kinematics, mInvis1, mInvis2, job->lo, &diagnostics)
+                && !mt2_above_kinematics(&kinematics, mInvis1, mInvis2, job->hi, &diagnostics))
+            {
+                *(npy_int64 *)(job->out + (chunk + count) * job->out_step) = i;
+                ++count;
+            }
+            mt2_tally_tests(&tally, diagnostics.tests);
+        }
+
+        job->counts[chunk / MT2_THREAD_CHUNK] = count;
+    }
+
+    mt2_tally_finish(&tally, mt2_engine_tombs);
+}
+
+/*
+ * The loop of mt2_select_ufunc, with signature
+ * (n),(n),(n),(n),(n),(n),(n),(n),(n),(n),(),()->(n),(), for event arguments
+ * of type In. The two scalar arguments are the window lo < mt2 <= hi, and the
+ * outputs are the indices of the events within it, followed by anything, and
+ * how many there are.
+ */
+template <typename In>
+static void mt2_select_loop(MT2_LOOP_ARGS)
+{
+    const npy_intp n_outer = dimensions[0];
+    const npy_intp n = dimensions[1];
+    const npy_intp *core_steps = steps + 14;
+    std::vector<npy_intp> counts((n + MT2_THREAD_CHUNK - 1) / MT2_THREAD_CHUNK);
+    const int n_threads = mt2_threads();
+
+    for (npy_intp o = 0; o < n_outer; ++o)
+    {
+        struct mt2_select_job job;
+        for (int a = 0; a < 10; ++a)
+        {
+            job.args[a] = args[a] + o * steps[a];
+            job.steps[a] = core_steps[a];
+        }
+        job.lo = *(double *)(args[10] + o * steps[10]);
+        job.hi = *(double *)(args[11] + o * steps[11]);
+        job.out = args[12] + o * steps[12];
+        job.out_step = core_steps[10];
+        job.counts = counts.data();
+
+        if (n_threads <= 1 || n <= MT2_THREAD_CHUNK)
+            mt2_select_task<In>(&job, 0, n);
+        else
+            mt2_process_pool()->run(n_threads, n, MT2_THREAD_CHUNK, &mt2_select_task<In>, &job);
+
+        /* Move the indices of each chunk down to follow those before it. */
+        npy_intp total = 0;
+        for (std::size_t c = 0; c < counts.size(); ++c)
+        {
+            const npy_intp start = (npy_intp)c * MT2_THREAD_CHUNK;
+            for (npy_intp k = 0; k < counts[c] && start != total; ++k)
+            {
+                *(npy_int64 *)(job.out + (total + k) * job.out_step) =
+                    *(const npy_int64 *)(job.out + (start + k) * job.out_step);
+            }
+            total += counts[c];
+        }
+        *(npy_int64 *)(args[13] + o * steps[13]) = total;
+    }
+}
+
+/*
+ * Jagged events
+ *
+ * mt2_jagged_ufunc is a generalized ufunc whose core dimensions are the
+ * visible objects of all events, the events, and the results, so that jagged
+ * data is read and written where it lies. Each event takes its objects from
+ * its start to its stop index, and writes its results from its output index:
+ * one for its leading two objects, or one for each pair of its objects.
+ *
+ * As for histograms, the events are split across threads within the loop.
+ * Pairs are queued and bisected across SIMD lanes as in mt2_kernel_impl,
+ * in a task compiled for each instruction set.
+ */
+struct mt2_jagged_job
+{
+    char *args[10]; // The objects, indices and event arguments,
+    npy_intp steps[10]; // and their strides between objects or events.
+    npy_intp n_objects;
+    npy_intp n_out;
+    char *out;
+    npy_intp out_step;
+    double precision;
+    bool all_pairs;
+};
+
+/* Compute events [begin, end) of the mt2_jagged_job at `context'. */
+template <typename In, int N, int G, mt2_method Method>
+static MT2_ALWAYS_INLINE void mt2_jagged_events(void *context, std::ptrdiff_t begin, std::ptrdiff_t end)
+{
+    const struct mt2_jagged_job *job = (const struct mt2_jagged_job *)context;
+    const npy_intp *steps = job->steps;
+
+    struct mt2_kinematics<double> kinematics;
+
+    struct mt2_tally tally;
+    mt2_tally_start(&tally);
+    mt2_lane_queue<In, N, G, Method, false, mt2_tally_results> queue({&tally});
+
+    tally.tests += mt2_lanes_loop(begin, end, &queue, [&](std::ptrdiff_t i) MT2_LAMBDA_INLINE {
+        const npy_int64 start = *(const npy_int64 *)(job->args[3] + i * steps[3]);
+        const npy_int64 stop = *(const npy_int64 *)(job->args[4] + i * steps[4]);
+        npy_int64 out_index = *(const npy_int64 *)(job->args[5] + i * steps[5]);
+        const double pxMiss = (double)*(const In *)(job->args[6] + i * steps[6]);
+        const double pyMiss = (double)*(const In *)(job->args[7] + i * steps[7]);
+        const double mInvis1 = (double)*(const In *)(job->args[8] + i * steps[8]);
+        const double mInvis2 = (double)*(const In *)(job->args[9] + i * steps[9]);
+
+        const bool valid = 0 <= start && start <= stop && stop <= job->n_objects;
+        const npy_int64 count = valid ? stop - start : 0;
+        if (!job->all_pairs && count < 2 && 0 <= out_index && out_index < job->n_out)
+        {
+            *(In *)(job->out + out_index * job->out_step) = std::numeric_limits<In>::quiet_NaN();
+            mt2_tally_result(&tally, std::numeric_limits<double>::quiet_NaN());
+        }
+
+        /* Only the leading pair, unless all are wanted. */
+        const npy_int64 a_end = job->all_pairs ? count : std::min<npy_int64>(count, 1);
+        const npy_int64 b_end = job->all_pairs ? count : std::min<npy_int64>(count, 2);
+        for (npy_int64 a = 0; a < a_end; ++a)
+        {
+            for (npy_int64 b = a + 1; b < b_end; ++b, ++out_index)
+            {
+                if (!(0 <= out_index && out_index < job->n_out))
+                    continue;
+
+                const char *m = job->args[0];
+                const char *px = job->args[1];
+                const char *py = job->args[2];
+                mt2_prepare_kinematics(
+                    (double)*(const In *)(m + (start + a) * steps[0]),
+                    (double)*(const In *)(px + (start + a) * steps[1]),
+                    (double)*(const In *)(py + (start + a) * steps[2]),
+                    (double)*(const In *)(m + (start + b) * steps[0]),
+                    (double)*(const In *)(px + (start + b) * steps[1]),
+                    (double)*(const In *)(py + (start + b) * steps[2]),
+                    pxMiss,
+                    pyMiss,
+                    &kinematics);
+                queue.add(
+                    &kinematics, mInvis1, mInvis2, job->precision,
+                    (In *)(job->out + out_index * job->out_step));
+            }
+        }
+    });
+
+    mt2_tally_finish(&tally, mt2_engine_tombs);
+}
+
+MT2_ISA_VARIANTS(mt2_jagged_task, (void *context, std::ptrdiff_t begin, std::ptrdiff_t end),
+                 mt2_jagged_events<T, lanes, 2, Method>(context, begin, end))
+
+/* The tasks of the chosen instruction set variant, for each mt2_method. */
+struct mt2_jagged_tasks
+{
+    mt2_pool_task task[mt2_n_methods];
+};
+
+/*
+ * The loop of mt2_jagged_ufunc, with signature
+ * (k),(k),(k),(n),(n),(n),(n),(n),(n),(n),(),()->(p), for arguments of type
+ * In. The objects are (m, px, py), the events' indices are their start, stop
+ * and output index, and the second scalar is whether to find all pairs.
+ */
+template <typename In>
+static void mt2_jagged_loop(MT2_LOOP_ARGS)
+{
+    const struct mt2_jagged_tasks *tasks = (const struct mt2_jagged_tasks *)data;
+    const mt2_pool_task task = tasks->task[mt2_call_method];
+    const npy_intp n_outer = dimensions[0];
+    const npy_intp n = dimensions[2];
+    const npy_intp *core_steps = steps + 13;
+    const int n_threads = mt2_threads();
+
+    /* As in mt2_kernel_impl. */
+    const double min_precision = std::numeric_limits<In>::epsilon() / 8;
+
+    for (npy_intp o = 0; o < n_outer; ++o)
+    {
+        struct mt2_jagged_job job;
+        for (int a = 0; a < 10; ++a)
+        {
+            job.args[a] = args[a] + o * steps[a];
+            job.steps[a] = core_steps[a];
+        }
+        job.n_objects = dimensions[1];
+        job.n_out = dimensions[3];
+        job.out = args[12] + o * steps[12];
+        job.out_step = core_steps[10];
+        job.precision = std::fmax(*(In *)(args[10] + o * steps[10]), min_precision);
+        job.all_pairs = *(npy_bool *)(args[11] + o * steps[11]) != 0;
+
+        if (n_threads <= 1 || n <= MT2_THREAD_CHUNK)
+            task(&job, 0, n);
+        else
+            mt2_process_pool()->run(n_threads, n, MT2_THREAD_CHUNK, task, &job);
+    }
+}
+
+/* This a pointer to mt2_lester_ufunc */
+PyUFuncGenericFunction mt2_lester_ufuncs[1] = {&mt2_lester_ufunc};
+
+/* These are the input and return dtypes of mt2_lester_ufunc.*/
+static char mt2_lester_types[13] = {
+    NPY_DOUBLE, // double mVis1,
+    NPY_DOUBLE, // double pxVis1,
+    NPY_DOUBLE, // double pyVis1,
+    NPY_DOUBLE, // double mVis2,
+    NPY_DOUBLE, // double pxVis2,
+    NPY_DOUBLE, // double pyVis2,
+    NPY_DOUBLE, // double pxMiss,
+    NPY_DOUBLE, // double pyMiss,
+    NPY_DOUBLE, // double mInvis1,
+    NPY_DOUBLE, // double mInvis2,
+    NPY_DOUBLE, // double desiredPrecisionOnMT2 = 0
+    NPY_BOOL,   // bool useDeciSectionsInitially=true
+    NPY_DOUBLE  // <result>
+};
+
+/* This a pointer to mt2_lally_ufunc */
+PyUFuncGenericFunction mt2_lally_ufuncs[1] = {&mt2_lally_ufunc};
+
+/* These are the input and return dtypes of mt2_lally_ufunc.*/
+static char mt2_lally_types[12] = {
+    NPY_DOUBLE, // double mVis1,
+    NPY_DOUBLE, // double pxVis1,
+    NPY_DOUBLE, // double pyVis1,
+    NPY_DOUBLE, // double mVis2,
+    NPY_DOUBLE, // double pxVis2,
+    NPY_DOUBLE, // double pyVis2,
+    NPY_DOUBLE, // double pxMiss,
+    NPY_DOUBLE, // double pyMiss,
+    NPY_DOUBLE, // double mInvis1,
+    NPY_DOUBLE, // double mInvis2,
+    NPY_DOUBLE, // double desiredPrecisionOnMT2 = 0
+    NPY_DOUBLE  // <result>
+};
+
+/*
+ * The mt2_tombs_ufunc loops, for float32 and float64, are split across threads.
+ * Their serial loops are set to the chosen instruction set variant at import.
+ *
+ * So are those of every ufunc but mt2_lester_ufunc (behind mt2_arxiv) and
+ * mt2_lally_ufunc, either through mt2_parallel_ufunc, or, for the generalized
+ * ufuncs whose core dimension is the events, within their own loops.
+ */
+PyUFuncGenericFunction mt2_tombs_ufuncs[2] = {&mt2_parallel_ufunc, &mt2_parallel_ufunc};
+static struct mt2_loop mt2_tombs_loops[2] = {{{NULL}, 12, 1}, {{NULL}, 12, 1}};
+static void *mt2_tombs_data[2] = {&mt2_tombs_loops[0], &mt2_tombs_loops[1]};
+
+/*
+ * Likewise for mt2_tombs_hint_ufunc, mt2_tombs_valid_ufunc, and mt2_scan_ufunc,
+ * which is a generalized ufunc.
+ */
+PyUFuncGenericFunction mt2_tombs_hint_ufuncs[2] = {&mt2_parallel_ufunc, &mt2_parallel_ufunc};
+static struct mt2_loop mt2_tombs_hint_loops[2] = {{{NULL}, 14, 1}, {{NULL}, 14, 1}};
+static void *mt2_tombs_hint_data[2] = {&mt2_tombs_hint_loops[0], &mt2_tombs_hint_loops[1]};
+
+PyUFuncGenericFunction mt2_tombs_valid_ufuncs[2] = {&mt2_parallel_ufunc, &mt2_parallel_ufunc};
+static struct mt2_loop mt2_tombs_valid_loops[2] = {{{NULL}, 13, 1}, {{NULL}, 13, 1}};
+static void *mt2_tombs_valid_data[2] = {&mt2_tombs_valid_loops[0], &mt2_tombs_valid_loops[1]};
+
+PyUFuncGenericFunction mt2_scan_ufuncs[2] = {&mt2_parallel_ufunc, &mt2_parallel_ufunc};
+static struct mt2_loop mt2_scan_loops[2] = {{{NULL}, 11, 2}, {{NULL}, 11, 2}};
+static void *mt2_scan_data[2] = {&mt2_scan_loops[0], &mt2_scan_loops[1]};
+
+PyUFuncGenericFunction mt2_rows_ufuncs[2] = {&mt2_parallel_ufunc, &mt2_parallel_ufunc};
+static struct mt2_loop mt2_rows_loops[2] = {{{NULL}, 3, 2}, {{NULL}, 3, 2}};
+static void *mt2_rows_data[2] = {&mt2_rows_loops[0], &mt2_rows_loops[1]};
+
+PyUFuncGenericFunction mt2_polar_ufuncs[2] = {&mt2_parallel_ufunc, &mt2_parallel_ufunc};
+static struct mt2_loop mt2_polar_loops[2] = {{{NULL}, 12, 1}, {{NULL}, 12, 1}};
+static void *mt2_polar_data[2] = {&mt2_polar_loops[0], &mt2_polar_loops[1]};
+
+PyUFuncGenericFunction mt2_four_vector_ufuncs[2] = {&mt2_parallel_ufunc, &mt2_parallel_ufunc};
+static struct mt2_loop mt2_four_vector_loops[2] = {{{NULL}, 14, 1}, {{NULL}, 14, 1}};
+static void *mt2_four_vector_data[2] = {&mt2_four_vector_loops[0], &mt2_four_vector_loops[1]};
+
+/* The mt2_jagged_ufunc loops split themselves across threads; their tasks are set to the chosen instruction set variant at import. */
+PyUFuncGenericFunction mt2_jagged_ufuncs[2] = {&mt2_jagged_loop<float>, &mt2_jagged_loop<double>};
+static struct mt2_jagged_tasks mt2_jagged_loops[2] = {{{NULL}}, {{NULL}}};
+static void *mt2_jagged_data[2] = {&mt2_jagged_loops[0], &mt2_jagged_loops[1]};
+
+/* These are the input and return dtypes of the mt2_jagged_ufunc loops. */
+static char mt2_jagged_types[26] = {
+    NPY_FLOAT,  // float mVis[k],
+    NPY_FLOAT,  // float pxVis[k],
+    NPY_FLOAT,  // float pyVis[k],
+    NPY_INT64,  // npy_int64 start[n],
+    NPY_INT64,  // npy_int64 stop[n],
+    NPY_INT64,  // npy_int64 outIndex[n],
+    NPY_FLOAT,  // float pxMiss[n],
+    NPY_FLOAT,  // float pyMiss[n],
+    NPY_FLOAT,  // float mInvis1[n],
+    NPY_FLOAT,  // float mInvis2[n],
+    NPY_FLOAT,  // float desiredPrecisionOnMT2,
+    NPY_BOOL,   // bool allPairs
+    NPY_FLOAT,  // <result>[p]
+    NPY_DOUBLE, // double mVis[k],
+    NPY_DOUBLE, // double pxVis[k],
+    NPY_DOUBLE, // double pyVis[k],
+    NPY_INT64,  // npy_int64 start[n],
+    NPY_INT64,  // npy_int64 stop[n],
+    NPY_INT64,  // npy_int64 outIndex[n],
+    NPY_DOUBLE, // double pxMiss[n],
+    NPY_DOUBLE, // double pyMiss[n],
+    NPY_DOUBLE, // double mInvis1[n],
+    NPY_DOUBLE, // double mInvis2[n],
+    NPY_DOUBLE, // double desiredPrecisionOnMT2,
+    NPY_BOOL,   // bool allPairs
+    NPY_DOUBLE  // <result>[p]
+};
+
+/* The mt2_above_ufunc loops have no method, nor instruction set variants. */
+PyUFuncGenericFunction mt2_above_ufuncs[2] = {&mt2_parallel_ufunc, &mt2_parallel_ufunc};
+static struct mt2_loop mt2_above_loops[2] = {
+    {{&mt2_above_loop<float>, &mt2_above_loop<float>}, 12, 1},
+    {{&mt2_above_loop<double>, &mt2_above_loop<double>}, 12, 1}};
+static void *mt2_above_data[2] = {&mt2_above_loops[0], &mt2_above_loops[1]};
+
+/* The mt2_bracket_ufunc loops have no method, nor instruction set variants. */
+PyUFuncGenericFunction mt2_bracket_ufuncs[2] = {&mt2_parallel_ufunc, &mt2_parallel_ufunc};
+static struct mt2_loop mt2_bracket_loops[2] = {
+    {{&mt2_bracket_loop<float>, &mt2_bracket_loop<float>}, 13, 1},
+    {{&mt2_bracket_loop<double>, &mt2_bracket_loop<double>}, 13, 1}};
+static void *mt2_bracket_data[2] = {&mt2_bracket_loops[0], &mt2_bracket_loops[1]};
+
+/* These are the input and return dtypes of the mt2_bracket_ufunc loops. */
+static char mt2_bracket_types[26] = {
+    NPY_FLOAT,  // float mVis1,
+    NPY_FLOAT,  // float pxVis1,
+    NPY_FLOAT,  // float pyVis1,
+    NPY_FLOAT,  // float mVis2,
+    NPY_FLOAT,  // float pxVis2,
+    NPY_FLOAT,  // float pyVis2,
+    NPY_FLOAT,  // float pxMiss,
+    NPY_FLOAT,  // float pyMiss,
+    NPY_FLOAT,  // float mInvis1,
+    NPY_FLOAT,  // float mInvis2,
+    NPY_INT64,  // int64 maxTests,
+    NPY_FLOAT,  // <result> lo
+    NPY_FLOAT,  // <result> hi
+    NPY_DOUBLE, // double mVis1,
+    NPY_DOUBLE, // double pxVis1,
+    NPY_DOUBLE, // double pyVis1,
+    NPY_DOUBLE, // double mVis2,
+    NPY_DOUBLE, // double pxVis2,
+    NPY_DOUBLE, // double pyVis2,
+    NPY_DOUBLE, // double pxMiss,
+    NPY_DOUBLE, // double pyMiss,
+    NPY_DOUBLE, // double mInvis1,
+    NPY_DOUBLE, // double mInvis2,
+    NPY_INT64,  // int64 maxTests,
+    NPY_DOUBLE, // <result> lo
+    NPY_DOUBLE  // <result> hi
+};
+
+/* The mt2_diagnostics_ufunc loops have a method, but no instruction set variants. */
+PyUFuncGenericFunction mt2_diagnostics_ufuncs[2] = {&mt2_parallel_ufunc, &mt2_parallel_ufunc};
+static struct mt2_loop mt2_diagnostics_loops[2] = {
+    {{&mt2_diagnostics_loop<float, mt2_method_bisect>, &mt2_diagnostics_loop<float, mt2_method_brent>}, 15, 1},
+    {{&mt2_diagnostics_loop<double, mt2_method_bisect>, &mt2_diagnostics_loop<double, mt2_method_brent>}, 15, 1}};
+static void *mt2_diagnostics_data[2] = {&mt2_diagnostics_loops[0], &mt2_diagnostics_loops[1]};
+
+/* Likewise the mt2_combinatorial_ufunc loops, which have a method, but no instruction set variants. */
+PyUFuncGenericFunction mt2_combinatorial_ufuncs[2] = {&mt2_parallel_ufunc, &mt2_parallel_ufunc};
+static struct mt2_loop mt2_combinatorial_loops[2] = {
+    {{&mt2_combinatorial_loop<float, mt2_method_bisect>, &mt2_combinatorial_loop<float, mt2_method_brent>}, 13, 2},
+    {{&mt2_combinatorial_loop<double, mt2_method_bisect>, &mt2_combinatorial_loop<double, mt2_method_brent>}, 13, 2}};
+static void *mt2_combinatorial_data[2] = {&mt2_combinatorial_loops[0], &mt2_combinatorial_loops[1]};
+
+/* These are the input and return dtypes of the mt2_combinatorial_ufunc loops. */
+static char mt2_combinatorial_types[26] = {
+    NPY_FLOAT,  // float e[k],
+    NPY_FLOAT,  // float px[k],
+    NPY_FLOAT,  // float py[k],
+    NPY_FLOAT,  // float pz[k],
+    NPY_INT64,  // npy_int64 start,
+    NPY_INT64,  // npy_int64 stop,
+    NPY_FLOAT,  // float pxMiss,
+    NPY_FLOAT,  // float pyMiss,
+    NPY_FLOAT,  // float mInvis1,
+    NPY_FLOAT,  // float mInvis2,
+    NPY_FLOAT,  // float desiredPrecisionOnMT2 = 0
+    NPY_FLOAT,  // <result>
+    NPY_INT64,  // <mask>
+    NPY_DOUBLE, // double e[k],
+    NPY_DOUBLE, // double px[k],
+    NPY_DOUBLE, // double py[k],
+    NPY_DOUBLE, // double pz[k],
+    NPY_INT64,  // npy_int64 start,
+    NPY_INT64,  // npy_int64 stop,
+    NPY_DOUBLE, // double pxMiss,
+    NPY_DOUBLE, // double pyMiss,
+    NPY_DOUBLE, // double mInvis1,
+    NPY_DOUBLE, // double mInvis2,
+    NPY_DOUBLE, // double desiredPrecisionOnMT2 = 0
+    NPY_DOUBLE, // <result>
+    NPY_INT64   // <mask>
+};
+
+/* These are the input and return dtypes of the mt2_diagnostics_ufunc loops. */
+static char mt2_diagnostics_types[30] = {
+    NPY_FLOAT,  // float mVis1,
+    NPY_FLOAT,  // float pxVis1,
+    NPY_FLOAT,  // float pyVis1,
+    NPY_FLOAT,  // float mVis2,
+    NPY_FLOAT,  // float pxVis2,
+    NPY_FLOAT,  // float pyVis2,
+    NPY_FLOAT,  // float pxMiss,
+    NPY_FLOAT,  // float pyMiss,
+    NPY_FLOAT,  // float mInvis1,
+    NPY_FLOAT,  // float mInvis2,
+    NPY_FLOAT,  // float precision,
+    NPY_FLOAT,  // <result>
+    NPY_UINT8,  // <result> status
+    NPY_UINT16, // <result> expansions
+    NPY_UINT16, // <result> tests
+    NPY_DOUBLE, // double mVis1,
+    NPY_DOUBLE, // double pxVis1,
+    NPY_DOUBLE, // double pyVis1,
+    NPY_DOUBLE, // double mVis2,
+    NPY_DOUBLE, // double pxVis2,
+    NPY_DOUBLE, // double pyVis2,
+    NPY_DOUBLE, // double pxMiss,
+    NPY_DOUBLE, // double pyMiss,
+    NPY_DOUBLE, // double mInvis1,
+    NPY_DOUBLE, // double mInvis2,
+    NPY_DOUBLE, // double precision,
+    NPY_DOUBLE, // <result>
+    NPY_UINT8,  // <result> status
+    NPY_UINT16, // <result> expansions
+    NPY_UINT16  // <result> tests
+};
+
+/* These are the input and return dtypes of the mt2_above_ufunc loops. */
+static char mt2_above_types[24] = {
+    NPY_FLOAT, // float mVis1,
+    NPY_FLOAT, // float pxVis1,
+    NPY_FLOAT, // float pyVis1,
+    NPY_FLOAT, // float mVis2,
+    NPY_FLOAT, // float pxVis2,
+    NPY_FLOAT, // float pyVis2,
+    NPY_FLOAT, // float pxMiss,
+    NPY_FLOAT, // float pyMiss,
+    NPY_FLOAT, // float mInvis1,
+    NPY_FLOAT, // float mInvis2,
+    NPY_FLOAT, // float threshold,
+    NPY_BOOL,  // <result>
+    NPY_DOUBLE, // double mVis1,
+    NPY_DOUBLE, // double pxVis1,
+    NPY_DOUBLE, // double pyVis1,
+    NPY_DOUBLE, // double mVis2,
+    NPY_DOUBLE, // double pxVis2,
+    NPY_DOUBLE, // double pyVis2,
+    NPY_DOUBLE, // double pxMiss,
+    NPY_DOUBLE, // double pyMiss,
+    NPY_DOUBLE, // double mInvis1,
+    NPY_DOUBLE, // double mInvis2,
+    NPY_DOUBLE, // double threshold,
+    NPY_BOOL    // <result>
+};
+
+/* These are the input and return dtypes of the mt2_scan_ufunc loops. */
+static char mt2_scan_types[22] = {
+    NPY_FLOAT, // float mVis1,
+    NPY_FLOAT, // float pxVis1,
+    NPY_FLOAT, // float pyVis1,
+    NPY_FLOAT, // float mVis2,
+    NPY_FLOAT, // float pxVis2,
+    NPY_FLOAT, // float pyVis2,
+    NPY_FLOAT, // float pxMiss,
+    NPY_FLOAT, // float pyMiss,
+    NPY_FLOAT, // float mInvis[k],
+    NPY_FLOAT, // float desiredPrecisionOnMT2 = 0
+    NPY_FLOAT, // <result>[k]
+    NPY_DOUBLE, // double mVis1,
+    NPY_DOUBLE, // double pxVis1,
+    NPY_DOUBLE, // double pyVis1,
+    NPY_DOUBLE, // double mVis2,
+    NPY_DOUBLE, // double pxVis2,
+    NPY_DOUBLE, // double pyVis2,
+    NPY_DOUBLE, // double pxMiss,
+    NPY_DOUBLE, // double pyMiss,
+    NPY_DOUBLE, // double mInvis[k],
+    NPY_DOUBLE, // double desiredPrecisionOnMT2 = 0
+    NPY_DOUBLE  // <result>[k]
+};
+
+/*
+ * These are the input and return dtypes of the mt2_tombs_ufunc loops.
+ * numpy uses the first loop to which all inputs can be cast safely, so the
+ * float32 loop must come first.
+ */
+static char mt2_tombs_types[24] = {
+    NPY_FLOAT, // float mVis1,
+    NPY_FLOAT, // float pxVis1,
+    NPY_FLOAT, // float pyVis1,
+    NPY_FLOAT, // float mVis2,
+    NPY_FLOAT, // float pxVis2,
+    NPY_FLOAT, // float pyVis2,
+    NPY_FLOAT, // float pxMiss,
+    NPY_FLOAT, // float pyMiss,
+    NPY_FLOAT, // float mInvis1,
+    NPY_FLOAT, // float mInvis2,
+    NPY_FLOAT, // float desiredPrecisionOnMT2 = 0
+    NPY_FLOAT, // <result>
+    NPY_DOUBLE, // double mVis1,
+    NPY_DOUBLE, // double pxVis1,
+    NPY_DOUBLE, // double pyVis1,
+    NPY_DOUBLE, // double mVis2,
+    NPY_DOUBLE, // double pxVis2,
+    NPY_DOUBLE, // double pyVis2,
+    NPY_DOUBLE, // double pxMiss,
+    NPY_DOUBLE, // double pyMiss,
+    NPY_DOUBLE, // double mInvis1,
+    NPY_DOUBLE, // double mInvis2,
+    NPY_DOUBLE, // double desiredPrecisionOnMT2 = 0
+    NPY_DOUBLE  // <result>
+};
+
+/* Likewise for mt2_tombs_hint_ufunc, which takes two more inputs. */
+static char mt2_tombs_hint_types[28] = {
+    NPY_FLOAT, // float mVis1,
+    NPY_FLOAT, // float pxVis1,
+    NPY_FLOAT, // float pyVis1,
+    NPY_FLOAT, // float mVis2,
+    NPY_FLOAT, // float pxVis2,
+    NPY_FLOAT, // float pyVis2,
+    NPY_FLOAT, // float pxMiss,
+    NPY_FLOAT, // float pyMiss,
+    NPY_FLOAT, // float mInvis1,
+    NPY_FLOAT, // float mInvis2,
+    NPY_FLOAT, // float desiredPrecisionOnMT2 = 0
+    NPY_FLOAT, // float loHint,
+    NPY_FLOAT, // float hiHint,
+    NPY_FLOAT, // <result>
+    NPY_DOUBLE, // double mVis1,
+    NPY_DOUBLE, // double pxVis1,
+    NPY_DOUBLE, // double pyVis1,
+    NPY_DOUBLE, // double mVis2,
+    NPY_DOUBLE, // double pxVis2,
+    NPY_DOUBLE, // double pyVis2,
+    NPY_DOUBLE, // double pxMiss,
+    NPY_DOUBLE, // double pyMiss,
+    NPY_DOUBLE, // double mInvis1,
+    NPY_DOUBLE, // double mInvis2,
+    NPY_DOUBLE, // double desiredPrecisionOnMT2 = 0
+    NPY_DOUBLE, // double loHint,
+    NPY_DOUBLE, // double hiHint,
+    NPY_DOUBLE  // <result>
+};
+
+/* Likewise for mt2_tombs_valid_ufunc, which takes whether each event is valid. */
+static char mt2_tombs_valid_types[26] = {
+    NPY_FLOAT, // float mVis1,
+    NPY_FLOAT, // float pxVis1,
+    NPY_FLOAT, // float pyVis1,
+    NPY_FLOAT, // float mVis2,
+    NPY_FLOAT, // float pxVis2,
+    NPY_FLOAT, // float pyVis2,
+    NPY_FLOAT, // float pxMiss,
+    NPY_FLOAT, // float pyMiss,
+    NPY_FLOAT, // float mInvis1,
+    NPY_FLOAT, // float mInvis2,
+    NPY_FLOAT, // float desiredPrecisionOnMT2 = 0
+    NPY_BOOL,  // bool valid,
+    NPY_FLOAT, // <result>
+    NPY_DOUBLE, // double mVis1,
+    NPY_DOUBLE, // double pxVis1,
+    NPY_DOUBLE, // double pyVis1,
+    NPY_DOUBLE, // double mVis2,
+    NPY_DOUBLE, // double pxVis2,
+    NPY_DOUBLE, // double pyVis2,
+    NPY_DOUBLE, // double pxMiss,
+    NPY_DOUBLE, // double pyMiss,
+    NPY_DOUBLE, // double mInvis1,
+    NPY_DOUBLE, // double mInvis2,
+    NPY_DOUBLE, // double desiredPrecisionOnMT2 = 0
+    NPY_BOOL,   // bool valid,
+    NPY_DOUBLE  // <result>
+};
+
+/* The mt2_histogram_ufunc loops, for float32 and float64 events. */
+PyUFuncGenericFunction mt2_histogram_ufuncs[2] = {&mt2_histogram_loop<float>, &mt2_histogram_loop<double>};
+
+/* These are the input and return dtypes of the mt2_histogram_ufunc loops. */
+static char mt2_histogram_types[26] = {
+    NPY_FLOAT, // float mVis1,
+    NPY_FLOAT, // float pxVis1,
+    NPY_FLOAT, // float pyVis1,
+    NPY_FLOAT, // float mVis2,
+    NPY_FLOAT, // float pxVis2,
+    NPY_FLOAT, // float pyVis2,
+    NPY_FLOAT, // float pxMiss,
+    NPY_FLOAT, // float pyMiss,
+    NPY_FLOAT, // float mInvis1,
+    NPY_FLOAT, // float mInvis2,
+    NPY_DOUBLE, // double weight,
+    NPY_DOUBLE, // double edges,
+    NPY_DOUBLE, // <result>
+    NPY_DOUBLE, // double mVis1,
+    NPY_DOUBLE, // double pxVis1,
+    NPY_DOUBLE, // double pyVis1,
+    NPY_DOUBLE, // double mVis2,
+    NPY_DOUBLE, // double pxVis2,
+    NPY_DOUBLE, // double pyVis2,
+    NPY_DOUBLE, // double pxMiss,
+    NPY_DOUBLE, // double pyMiss,
+    NPY_DOUBLE, // double mInvis1,
+    NPY_DOUBLE, // double mInvis2,
+    NPY_DOUBLE, // double weight,
+    NPY_DOUBLE, // double edges,
+    NPY_DOUBLE  // <result>
+};
+
+/* The mt2_select_ufunc loops, for float32 and float64 events. */
+PyUFuncGenericFunction mt2_select_ufuncs[2] = {&mt2_select_loop<float>, &mt2_select_loop<double>};
+
+/* These are the input and return dtypes of the mt2_select_ufunc loops. */
+static char mt2_select_types[28] = {
+    NPY_FLOAT, // float mVis1,
+    NPY_FLOAT, // float pxVis1,
+    NPY_FLOAT, // float pyVis1,
+    NPY_FLOAT, // float mVis2,
+    NPY_FLOAT, // float pxVis2,
+    NPY_FLOAT, // float pyVis2,
+    NPY_FLOAT, // float pxMiss,
+    NPY_FLOAT, // float pyMiss,
+    NPY_FLOAT, // float mInvis1,
+    NPY_FLOAT, // float mInvis2,
+    NPY_DOUBLE, // double lo,
+    NPY_DOUBLE, // double hi,
+    NPY_INT64, // <indices>
+    NPY_INT64, // <count>
+    NPY_DOUBLE, // double mVis1,
+    NPY_DOUBLE, // double pxVis1,
+    NPY_DOUBLE, // double pyVis1,
+    NPY_DOUBLE, // double mVis2,
+    NPY_DOUBLE, // double pxVis2,
+    NPY_DOUBLE, // double pyVis2,
+    NPY_DOUBLE, // double pxMiss,
+    NPY_DOUBLE, // double pyMiss,
+    NPY_DOUBLE, // double mInvis1,
+    NPY_DOUBLE, // double mInvis2,
+    NPY_DOUBLE, // double lo,
+    NPY_DOUBLE, // double hi,
+    NPY_INT64, // <indices>
+    NPY_INT64  // <count>
+};
+
+/* These are the input and return dtypes of the mt2_rows_ufunc loops. */
+static char mt2_rows_types[6] = {
+    NPY_FLOAT,  // float row[10],
+    NPY_FLOAT,  // float desiredPrecisionOnMT2 = 0
+    NPY_FLOAT,  // <result>
+    NPY_DOUBLE, // double row[10],
+    NPY_DOUBLE, // double desiredPrecisionOnMT2 = 0
+    NPY_DOUBLE  // <result>
+};
+
+/* These are the input and return dtypes of the mt2_polar_ufunc loops. */
+static char mt2_polar_types[24] = {
+    NPY_FLOAT,  // float ptVis1,
+    NPY_FLOAT,  // float phiVis1,
+    NPY_FLOAT,  // float mVis1,
+    NPY_FLOAT,  // float ptVis2,
+    NPY_FLOAT,  // float phiVis2,
+    NPY_FLOAT,  // float mVis2,
+    NPY_FLOAT,  // float ptMiss,
+    NPY_FLOAT,  // float phiMiss,
+    NPY_FLOAT,  // float mInvis1,
+    NPY_FLOAT,  // float mInvis2,
+    NPY_FLOAT,  // float desiredPrecisionOnMT2 = 0
+    NPY_FLOAT,  // <result>
+    NPY_DOUBLE, // double ptVis1,
+    NPY_DOUBLE, // double phiVis1,
+    NPY_DOUBLE, // double mVis1,
+    NPY_DOUBLE, // double ptVis2,
+    NPY_DOUBLE, // double phiVis2,
+    NPY_DOUBLE, // double mVis2,
+    NPY_DOUBLE, // double ptMiss,
+    NPY_DOUBLE, // double phiMiss,
+    NPY_DOUBLE, // double mInvis1,
+    NPY_DOUBLE, // double mInvis2,
+    NPY_DOUBLE, // double desiredPrecisionOnMT2 = 0
+    NPY_DOUBLE  // <result>
+};
+
+/* Likewise for mt2_four_vector_ufunc, which takes four-vectors of the visible particles. */
+static char mt2_four_vector_types[28] = {
+    NPY_FLOAT,  // float eVis1,
+    NPY_FLOAT,  // float pxVis1,
+    NPY_FLOAT,  // float pyVis1,
+    NPY_FLOAT,  // float pzVis1,
+    NPY_FLOAT,  // float eVis2,
+    NPY_FLOAT,  // float pxVis2,
+    NPY_FLOAT,  // float pyVis2,
+    NPY_FLOAT,  // float pzVis2,
+    NPY_FLOAT,  // float ptMiss,
+    NPY_FLOAT,  // float phiMiss,
+    NPY_FLOAT,  // float mInvis1,
+    NPY_FLOAT,  // float mInvis2,
+    NPY_FLOAT,  // float desiredPrecisionOnMT2 = 0
+    NPY_FLOAT,  // <result>
+    NPY_DOUBLE, // double eVis1,
+    NPY_DOUBLE, // double pxVis1,
+    NPY_DOUBLE, // double pyVis1,
+    NPY_DOUBLE, // double pzVis1,
+    NPY_DOUBLE, // double eVis2,
+    NPY_DOUBLE, // double pxVis2,
+    NPY_DOUBLE, // double pyVis2,
+    NPY_DOUBLE, // double pzVis2,
+    NPY_DOUBLE, // double ptMiss,
+    NPY_DOUBLE, // double phiMiss,
+    NPY_DOUBLE, // double mInvis1,
+    NPY_DOUBLE, // double mInvis2,
+    NPY_DOUBLE, // double desiredPrecisionOnMT2 = 0
+    NPY_DOUBLE  // <result>
+};
+
+/* Instruction set variants of the ufunc loops, for each mt2_method. */
+struct mt2_isa_loops
+{
+    PyUFuncGenericFunction tombs[mt2_n_methods];
+    PyUFuncGenericFunction tombs_float[mt2_n_methods];
+    PyUFuncGenericFunction tombs_hint[mt2_n_methods];
+    PyUFuncGenericFunction tombs_hint_float[mt2_n_methods];
+    PyUFuncGenericFunction tombs_valid[mt2_n_methods];
+    PyUFuncGenericFunction tombs_valid_float[mt2_n_methods];
+    PyUFuncGenericFunction scan[mt2_n_methods];
+    PyUFuncGenericFunction scan_float[mt2_n_methods];
+    PyUFuncGenericFunction rows[mt2_n_methods];
+    PyUFuncGenericFunction rows_float[mt2_n_methods];
+    PyUFuncGenericFunction polar[mt2_n_methods];
+    PyUFuncGenericFunction polar_float[mt2_n_methods];
+    PyUFuncGenericFunction four_vector[mt2_n_methods];
+    PyUFuncGenericFunction four_vector_float[mt2_n_methods];
+    mt2_pool_task jagged[mt2_n_methods];
+    mt2_pool_task jagged_float[mt2_n_methods];
+};
+
+#define MT2_ISA_LOOPS(isa)                                                                                  \
+    {MT2_METHODS(mt2_tombs_ufunc##isa, double), MT2_METHODS(mt2_tombs_ufunc##isa, float),                 \
+     MT2_METHODS(mt2_tombs_hint_ufunc##isa, double), MT2_METHODS(mt2_tombs_hint_ufunc##isa, float),       \
+     MT2_METHODS(mt2_tombs_valid_ufunc##isa, double), MT2_METHODS(mt2_tombs_valid_ufunc##isa, float),     \
+     MT2_METHODS(mt2_scan_ufunc##isa, double), MT2_METHODS(mt2_scan_ufunc##isa, float),                   \
+     MT2_METHODS(mt2_rows_ufunc##isa, double), MT2_METHODS(mt2_rows_ufunc##isa, float),                   \
+     MT2_METHODS(mt2_polar_ufunc##isa, double), MT2_METHODS(mt2_polar_ufunc##isa, float),                 \
+     MT2_METHODS(mt2_four_vector_ufunc##isa, double), MT2_METHODS(mt2_four_vector_ufunc##isa, float),     \
+     MT2_METHODS(mt2_jagged_task##isa, double), MT2_METHODS(mt2_jagged_task##isa, float)}
+
+/* For each of mt2_isas. */
+static const struct mt2_isa_loops mt2_isa_loops[] = {MT2_FOR_EACH_ISA(MT2_ISA_LOOPS)};
+
+/*
+ * Choose the best variant supported by this CPU, or that named by the MT2_ISA
+ * environment variable, and return its index in mt2_isas. Returns a negative
+ * number, with an exception set, if MT2_ISA names a variant that is unknown
+ * or unsupported.
+ */
+static int mt2_import_isa(void)
+{
+    const char *forced = std::getenv("MT2_ISA");
+    const int isa = mt2_select_isa(forced);
+    if (isa == mt2_isa_unsupported)
+        PyErr_Format(PyExc_ImportError, "MT2_ISA=%s is not supported by this CPU", forced);
+    else if (isa == mt2_isa_unknown)
+        PyErr_Format(PyExc_ImportError, "MT2_ISA=%s is not a known instruction set variant", forced);
+    return isa;
+}
+
+/* Resolve a requested number of threads, where 0 means one per CPU. */
+static int mt2_parse_threads(PyObject *args, int *n_threads)
+{
+    if (!PyArg_ParseTuple(args, "i", n_threads))
+        return 0;
+    if (*n_threads < 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "number of threads must be non-negative");
+        return 0;
+    }
+    if (*n_threads == 0)
+    {
+        const unsigned int n_cpus = std::thread::hardware_concurrency();
+        *n_threads = n_cpus > 0 ? (int)n_cpus : 1;
+    }
+    return 1;
+}
+
+static PyObject *mt2_set_num_threads(PyObject *self, PyObject *args)
+{
+    int n_threads;
+    if (!mt2_parse_threads(args, &n_threads))
+        return NULL;
+    mt2_num_threads.store(n_threads, std::memory_order_relaxed);
+    Py_RETURN_NONE;
+}
+
+static PyObject *mt2_get_num_threads(PyObject *self, PyObject *args)
+{
+    return PyLong_FromLong(mt2_threads());
+}
+
+static PyObject *mt2_set_call_threads(PyObject *self, PyObject *args)
+{
+    PyObject *arg;
+    if (!PyArg_ParseTuple(args, "O", &arg))
+        return NULL;
+    /* None removes the override, which is stored as 0. */
+    int n_threads = 0;
+    if (arg != Py_None && !mt2_parse_threads(args, &n_threads))
+        return NULL;
+    const int previous = mt2_call_threads;
+    mt2_call_threads = n_threads;
+    if (previous == 0)
+        Py_RETURN_NONE;
+    return PyLong_FromLong(previous);
+}
+
+static PyObject *mt2_set_call_method(PyObject *self, PyObject *args)
+{
+    const char *name;
+    if (!PyArg_ParseTuple(args, "s", &name))
+        return NULL;
+    int method = 0;
+    while (method < mt2_n_methods && strcmp(name, mt2_method_names[method]) != 0)
+        ++method;
+    if (method == mt2_n_methods)
+    {
+        PyErr_Format(PyExc_ValueError, "unknown method '%s'; expected 'bisect' or 'brent'", name);
+        return NULL;
+    }
+    const mt2_method previous = mt2_call_method;
+    mt2_call_method = (mt2_method)method;
+    return PyUnicode_FromString(mt2_method_names[previous]);
+}
+
+PyDoc_STRVAR(mt2_module_doc, "Provides the mt2 stransverse mass ufunc.");
+
+static PyObject *mt2_get_stats(PyObject *self, PyObject *args)
+{
+    PyObject *stats = PyDict_New();
+    if (!stats)
+        return NULL;
+
+    for (int e = 0; e < mt2_n_engines; ++e)
+    {
+        const struct mt2_counters *counters = &mt2_stats[e];
+        PyObject *engine = Py_BuildValue(
+            "{s:K,s:K,s:K,s:K,s:K,s:d}",
+            "events", counters->events.load(std::memory_order_relaxed),
+            "tests", counters->tests.load(std::memory_order_relaxed),
+            "errors", counters->errors.load(std::memory_order_relaxed),
+            "infinities", counters->infinities.load(std::memory_order_relaxed),
+            "nans", counters->nans.load(std::memory_order_relaxed),
+            "seconds", 1e-9 * (double)counters->nanoseconds.load(std::memory_order_relaxed));
+        if (!engine || PyDict_SetItemString(stats, mt2_engine_names[e], engine) < 0)
+        {
+            Py_XDECREF(engine);
+            Py_DECREF(stats);
+            return NULL;
+        }
+        Py_DECREF(engine);
+    }
+    return stats;
+}
+
+static PyObject *mt2_reset_stats(PyObject *self, PyObject *args)
+{
+    for (int e = 0; e < mt2_n_engines; ++e)
+    {
+        struct mt2_counters *counters = &mt2_stats[e];
+        counters->events.store(0, std::memory_order_relaxed);
+        counters->tests.store(0, std::memory_order_relaxed);
+        counters->errors.store(0, std::memory_order_relaxed);
+        counters->infinities.store(0, std::memory_order_relaxed);
+        counters->nans.store(0, std::memory_order_relaxed);
+        counters->nanoseconds.store(0, std::memory_order_relaxed);
+    }
+    Py_RETURN_NONE;
+}
+
+/*
+ * Arrow
+ *
+ * Arrays are shared with Arrow libraries through the Arrow PyCapsule
+ * interface: capsules of the ArrowSchema, ArrowArray and ArrowArrayStream
+ * structures of the C data interface. Imported arrays are moved into a capsule
+ * of our own, which releases them once the numpy views of their buffers, whose
+ * base it is, are gone. mt2.mt2_arrow walks the views and their validity
+ * bitmaps in Python, calling mt2_tombs_valid_ufunc on them in place.
+ */
+static void mt2_arrow_owner_destructor(PyObject *capsule)
+{
+    struct ArrowArray *array = (struct ArrowArray *)PyCapsule_GetPointer(capsule, "mt2.arrow_owner");
+    if (array->release)
+    {
+        /* The owner may die with an import error pending, and a producer's
+         * release callback may itself call into Python. */
+        PyObject *type, *value, *traceback;
+        PyErr_Fetch(&type, &value, &traceback);
+        array->release(array);
+        PyErr_Restore(type, value, traceback);
+    }
+    delete array;
+}
+
+/* Return a 1-d numpy view of `length' elements at `data', kept alive by `owner'. */
+static PyObject *mt2_arrow_view(const void *data, npy_intp length, int type, PyObject *owner)
+{
+    PyObject *view = PyArray_SimpleNewFromData(1, &length, type, const_cast<void *>(data));
+    if (!view)
+        return NULL;
+    PyArray_CLEARFLAGS((PyArrayObject *)view, NPY_ARRAY_WRITEABLE);
+    Py_INCREF(owner);
+    if (PyArray_SetBaseObject((PyArrayObject *)view, owner) < 0)
+    {
+        Py_DECREF(view);
+        return NULL;
+    }
+    return view;
+}
+
+/*
+ * Return (name, values, validity, bit_offset, children) for `length' elements
+ * of `array', starting `offset' elements into it, as well as its own offset.
+ * `values' is a view of the data of a float64 or float32 array; `children' a
+ * tuple of the same for each field of a struct. `validity' is a view of the
+ * bytes of the validity bitmap holding the first element at `bit_offset', or
+ * None if there are no nulls.
+ *
+ * Raises ValueError unless `array' holds those elements, as each child of a
+ * struct must hold those of its parent.
+ */
+static PyObject *mt2_arrow_column(
+    const struct ArrowSchema *schema, const struct ArrowArray *array,
+    int64_t offset, int64_t length, PyObject *owner)
+{
+    if (array->length < 0 || array->offset < 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "Arrow array has a negative length or offset");
+        return NULL;
+    }
+    if (array->length - offset < length)
+    {
+        PyErr_SetString(PyExc_ValueError, "Arrow array is shorter than its parent");
+        return NULL;
+    }
+    /* So that the byte offsets of the buffers cannot overflow. */
+    if (array->offset > std::numeric_limits<int64_t>::max() / 8 - array->length)
+    {
+        PyErr_SetString(PyExc_ValueError, "Arrow array offset is out of range");
+        return NULL;
+    }
+    offset += array->offset;
+    if (schema->dictionary || array->dictionary)
+    {
+        PyErr_SetString(PyExc_TypeError, "dictionary-encoded Arrow arrays are not supported");
+        return NULL;
+    }
+    const bool is_struct = strcmp(schema->format, "+s") == 0;
+    int type = NPY_NOTYPE;
+    if (strcmp(schema->format, "g") == 0)
+        type = NPY_DOUBLE;
+    else if (strcmp(schema->format, "f") == 0)
+        type = NPY_FLOAT;
+    else if (!is_struct)
+    {
+        PyErr_Format(
+            PyExc_TypeError,
+            "unsupported Arrow format '%s'; expected float64, float32, or a struct of them",
+            schema->format);
+        return NULL;
+    }
+    if (array->n_buffers != (is_struct ? 1 : 2) || array->n_children != (is_struct ? schema->n_children : 0))
+    {
+        PyErr_SetString(PyExc_ValueError, "Arrow array does not match its schema");
+        return NULL;
+    }
+
+    const char *data = is_struct ? NULL : (const char *)array->buffers[1];
+    if (!is_struct && !data && length > 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "Arrow array has no data buffer");
+        return NULL;
+    }
+
+    PyObject *values = Py_None, *validity = Py_None, *children = Py_None;
+    Py_INCREF(Py_None);
+    Py_INCREF(Py_None);
+    Py_INCREF(Py_None);
+    if (!is_struct)
+    {
+        const int itemsize = type == NPY_DOUBLE ? 8 : 4;
+        Py_SETREF(values, mt2_arrow_view(data ? data + offset * itemsize : NULL, length, type, owner));
+        if (!values)
+            goto error;
+    }
+    if (array->buffers[0] && array->null_count != 0)
+    {
+        const char *bitmap = (const char *)array->buffers[0] + offset / 8;
+        Py_SETREF(validity, mt2_arrow_view(bitmap, (offset % 8 + length + 7) / 8, NPY_UINT8, owner));
+        if (!validity)
+            goto error;
+    }
+    if (is_struct)
+    {
+        Py_SETREF(children, PyTuple_New(schema->n_children));
+        if (!children)
+            goto error;
+        for (int64_t i = 0; i < schema->n_children; ++i)
+        {
+            PyObject *child = mt2_arrow_column(schema->children[i], array->children[i], offset, length, owner);
+            if (!child)
+                goto error;
+            PyTuple_SET_ITEM(children, i, child);
+        }
+    }
+    return Py_BuildValue("zNNLN", schema->name, values, validity, (long long)(offset % 8), children);
+
+error:
+    Py_XDECREF(values);
+    Py_XDECREF(validity);
+    Py_XDECREF(children);
+    return NULL;
+}
+
+/* Import `*array', moving it into an owner, and return its mt2_arrow_column. */
+static PyObject *mt2_arrow_move(const struct ArrowSchema *schema, struct ArrowArray *array)
+{
+    struct ArrowArray *moved = new struct ArrowArray(*array);
+    array->release = NULL;
+    PyObject *owner = PyCapsule_New(moved, "mt2.arrow_owner", mt2_arrow_owner_destructor);
+    if (!owner)
+    {
+        moved->release(moved);
+        delete moved;
+        return NULL;
+    }
+    PyObject *column = mt2_arrow_column(schema, moved, 0, moved->length, owner);
+    Py_DECREF(owner);
+    return column;
+}
+
+static PyObject *mt2_arrow_import(PyObject *self, PyObject *args)
+{
+    PyObject *schema_capsule, *array_capsule;
+    if (!PyArg_ParseTuple(args, "OO", &schema_capsule, &array_capsule))
+        return NULL;
+    struct ArrowSchema *schema = (struct ArrowSchema *)PyCapsule_GetPointer(schema_capsule, "arrow_schema");
+    if (!schema)
+        return NULL;
+    struct ArrowArray *array = (struct ArrowArray *)PyCapsule_GetPointer(array_capsule, "arrow_array");
+    if (!array)
+        return NULL;
+    if (!schema->release || !array->release)
+    {
+        PyErr_SetString(PyExc_ValueError, "Arrow array has already been released");
+        return NULL;
+    }
+    return mt2_arrow_move(schema, array);
+}
+
+static PyObject *mt2_arrow_stream_error(struct ArrowArrayStream *stream, int code)
+{
+    const char *message = stream->get_last_error(stream);
+    PyErr_Format(PyExc_OSError, "reading Arrow stream failed with code %d: %s", code, message ? message : "");
+    return NULL;
+}
+
+static PyObject *mt2_arrow_import_stream(PyObject *self, PyObject *args)
+{
+    PyObject *stream_capsule;
+    if (!PyArg_ParseTuple(args, "O", &stream_capsule))
+        return NULL;
+    struct ArrowArrayStream *stream =
+        (struct ArrowArrayStream *)PyCapsule_GetPointer(stream_capsule, "arrow_array_stream");
+    if (!stream)
+        return NULL;
+    if (!stream->release)
+    {
+        PyErr_SetString(PyExc_ValueError, "Arrow stream has already been released");
+        return NULL;
+    }
+
+    struct ArrowSchema schema;
+    int code = stream->get_schema(stream, &schema);
+    if (code != 0)
+        return mt2_arrow_stream_error(stream, code);
+    PyObject *chunks = PyList_New(0);
+    while (chunks)
+    {
+        struct ArrowArray array;
+        code = stream->get_next(stream, &array);
+        if (code != 0)
+        {
+            Py_CLEAR(chunks);
+            mt2_arrow_stream_error(stream, code);
+            break;
+        }
+        /* A released array marks the end of the stream. */
+        if (!array.release)
+            break;
+        PyObject *chunk = mt2_arrow_move(&schema, &array);
+        if (!chunk || PyList_Append(chunks, chunk) < 0)
+            Py_CLEAR(chunks);
+        Py_XDECREF(chunk);
+    }
+    schema.release(&schema);
+    return chunks;
+}
+
+/* The buffers of an exported float64 array, and the numpy arrays holding them. */
+struct mt2_arrow_export_data
+{
+    const void *buffers[2];
+    PyObject *values;
+    PyObject *validity;
+};
+
+static void mt2_arrow_release_schema(struct ArrowSchema *schema)
+{
+    schema->release = NULL;
+}
+
+/* Arrow may release arrays from any thread, with or without the GIL. */
+static void mt2_arrow_release_array(struct ArrowArray *array)
+{
+    struct mt2_arrow_export_data *export_data = (struct mt2_arrow_export_data *)array->private_data;
+    const PyGILState_STATE state = PyGILState_Ensure();
+    Py_DECREF(export_data->values);
+    Py_XDECREF(export_data->validity);
+    PyGILState_Release(state);
+    delete export_data;
+    array->release = NULL;
+}
+
+static void mt2_arrow_schema_destructor(PyObject *capsule)
+{
+    struct ArrowSchema *schema = (struct ArrowSchema *)PyCapsule_GetPointer(capsule, "arrow_schema");
+    if (schema->release)
+        schema->release(schema);
+    delete schema;
+}
+
+static void mt2_arrow_array_destructor(PyObject *capsule)
+{
+    struct ArrowArray *array = (struct ArrowArray *)PyCapsule_GetPointer(capsule, "arrow_array");
+    if (array->release)
+        array->release(array);
+    delete array;
+}
+
+static PyObject *mt2_arrow_export(PyObject *self, PyObject *args)
+{
+    PyArrayObject *values;
+    PyObject *validity;
+    long long null_count;
+    if (!PyArg_ParseTuple(args, "O!OL", &PyArray_Type, &values, &validity, &null_count))
+        return NULL;
+    const npy_intp length = PyArray_SIZE(values);
+    if (PyArray_TYPE(values) != NPY_DOUBLE || PyArray_NDIM(values) != 1 || !PyArray_IS_C_CONTIGUOUS(values))
+    {
+        PyErr_SetString(PyExc_ValueError, "values must be a contiguous 1-d float64 array");
+        return NULL;
+    }
+    if (validity == Py_None)
+        validity = NULL;
+    else if (!PyArray_Check(validity) || PyArray_TYPE((PyArrayObject *)validity) != NPY_UINT8 ||
+             PyArray_NDIM((PyArrayObject *)validity) != 1 ||
+             !PyArray_IS_C_CONTIGUOUS((PyArrayObject *)validity) ||
+             PyArray_SIZE((PyArrayObject *)validity) < (length + 7) / 8)
+    {
+        PyErr_SetString(PyExc_ValueError, "validity must be a contiguous bitmap of uint8 covering values");
+        return NULL;
+    }
+
+    struct ArrowSchema *schema = new struct ArrowSchema();
+    schema->format = "g";
+    schema->name = "";
+    schema->flags = ARROW_FLAG_NULLABLE;
+    schema->release = mt2_arrow_release_schema;
+    PyObject *schema_capsule = PyCapsule_New(schema, "arrow_schema", mt2_arrow_schema_destructor);
+    if (!schema_capsule)
+    {
+        delete schema;
+        return NULL;
+    }
+
+    struct mt2_arrow_export_data *export_data = new struct mt2_arrow_export_data();
+    export_data->buffers[0] = validity ? PyArray_DATA((PyArrayObject *)validity) : NULL;
+    export_data->buffers[1] = PyArray_DATA(values);
+    export_data->values = (PyObject *)values;
+    export_data->validity = validity;
+    Py_INCREF(values);
+    Py_XINCREF(validity);
+    struct ArrowArray *array = new struct ArrowArray();
+    array->length = length;
+    array->null_count = validity ? null_count : 0;
+    array->n_buffers = 2;
+    array->buffers = export_data->buffers;
+    array->release = mt2_arrow_release_array;
+    array->private_data = export_data;
+    PyObject *array_capsule = PyCapsule_New(array, "arrow_array", mt2_arrow_array_destructor);
+    if (!array_capsule)
+    {
+        mt2_arrow_release_array(array);
+        delete array;
+        Py_DECREF(schema_capsule);
+        return NULL;
+    }
+    return Py_BuildValue("NN", schema_capsule, array_capsule);
+}
+
+static PyMethodDef methods[] = {
+    {"set_num_threads", mt2_set_num_threads, METH_VARARGS,
+     "Set the number of threads used by every ufunc but mt2_lester_ufunc (behind mt2_arxiv) and mt2_lally_ufunc; 0 means one per CPU, and 1 (the default) disables threading."},
+    {"get_num_threads", mt2_get_num_threads, METH_NOARGS,
+     "Get the number of threads used by every ufunc but mt2_lester_ufunc (behind mt2_arxiv) and mt2_lally_ufunc, when called from this thread."},
+    {"_set_call_threads", mt2_set_call_threads, METH_VARARGS,
+     "Override the number of threads for calls from this thread, returning the previous override; None removes it."},
+    {"_set_call_method", mt2_set_call_method, METH_VARARGS,
+     "Set the root-finding method ('bisect' or 'brent') for calls from this thread, returning the previous one."},
+    {"stats", mt2_get_stats, METH_NOARGS,
+     "Return the process-wide counters of each engine, as a dict of dicts. lally makes no disjointness tests, so its tests are always 0."},
+    {"reset_stats", mt2_reset_stats, METH_NOARGS,
+     "Reset the process-wide counters of every engine to zero."},
+    {"_arrow_import", mt2_arrow_import, METH_VARARGS,
+     "Import an Arrow array from its schema and array capsules, as numpy views of its values and validity."},
+    {"_arrow_import_stream", mt2_arrow_import_stream, METH_VARARGS,
+     "Import each chunk of an Arrow array stream capsule, as for _arrow_import."},
+    {"_arrow_export", mt2_arrow_export, METH_VARARGS,
+     "Export a float64 array, with a validity bitmap or None and its null count, as Arrow schema and array capsules."},
+    {NULL, NULL, 0, NULL}};
+
+static struct PyModuleDef moduledef = {
+    PyModuleDef_HEAD_INIT,
+    "_mt2",
+    mt2_module_doc,
+    -1,
+    methods,
+    NULL,
+    NULL,
+    NULL,
+    NULL};
+
+static void *data[2] = {NULL, NULL};
+
+PyMODINIT_FUNC PyInit__mt2(void)
+{
+    PyObject *module = PyModule_Create(&moduledef);
+    if (!module)
+    {
+        return NULL;
+    }
+
+#ifdef Py_GIL_DISABLED
+    PyUnstable_Module_SetGIL(module, Py_MOD_GIL_NOT_USED);
 #endif
     
     import_array();
     import_ufunc();
     import_umath();
 
+    const int isa = mt2_import_isa();
+    if (isa < 0)
+    {
+        Py_DECREF(module);
+        return NULL;
+    }
+    const struct mt2_isa_loops *loops = &mt2_isa_loops[isa];
+    for (int m = 0; m < mt2_n_methods; ++m)
+    {
+        mt2_tombs_loops[0].serial[m] = loops->tombs_float[m];
+        mt2_tombs_loops[1].serial[m] = loops->tombs[m];
+        mt2_tombs_hint_loops[0].serial[m] = loops->tombs_hint_float[m];
+        mt2_tombs_hint_loops[1].serial[m] = loops->tombs_hint[m];
+        mt2_tombs_valid_loops[0].serial[m] = loops->tombs_valid_float[m];
+        mt2_tombs_valid_loops[1].serial[m] = loops->tombs_valid[m];
+        mt2_scan_loops[0].serial[m] = loops->scan_float[m];
+        mt2_scan_loops[1].serial[m] = loops->scan[m];
+        mt2_rows_loops[0].serial[m] = loops->rows_float[m];
+        mt2_rows_loops[1].serial[m] = loops->rows[m];
+        mt2_polar_loops[0].serial[m] = loops->polar_float[m];
+        mt2_polar_loops[1].serial[m] = loops->polar[m];
+        mt2_four_vector_loops[0].serial[m] = loops->four_vector_float[m];
+        mt2_four_vector_loops[1].serial[m] = loops->four_vector[m];
+        mt2_jagged_loops[0].task[m] = loops->jagged_float[m];
+        mt2_jagged_loops[1].task[m] = loops->jagged[m];
+    }
+
     PyObject *mt2_lester_ufunc = PyUFunc_FromFuncAndData(
         mt2_lester_ufuncs,                 // func
         data,                              // data. The documentation claims we can pass NULL here, but then it segfaults!
@@ -348,9 +2853,9 @@ PyMODINIT_FUNC PyInit__mt2(void)
 
     PyObject *mt2_tombs_ufunc = PyUFunc_FromFuncAndData(
         mt2_tombs_ufuncs,                                                    // func
-        data,                                                                // data. The documentation claims we can pass NULL here, but then it segfaults!
+        mt2_tombs_data,                                                      // data. Each is the mt2_loop to split across threads.
         mt2_tombs_types,                                                     // types
-        1,                                                                   // ntypes
+        2,                                                                   // ntypes
         11,                                                                  // nin
         1,                                                                   // nout
         PyUFunc_None,                                                        // identity
@@ -359,14 +2864,237 @@ PyMODINIT_FUNC PyInit__mt2(void)
         0                                                                    // unused
     );
 
+    PyObject *mt2_tombs_hint_ufunc = PyUFunc_FromFuncAndData(
+        mt2_tombs_hint_ufuncs,                                    // func
+        mt2_tombs_hint_data,                                      // data. Each is the mt2_loop to split across threads.
+        mt2_tombs_hint_types,                                     // types
+        2,                                                        // ntypes
+        13,                                                       // nin
+        1,                                                        // nout
+        PyUFunc_None,                                             // identity
+        "mt2_tombs_hint_ufunc",                                   // name
+        "Numpy ufunc to compute mt2, given hints on its bracket", // doc
+        0                                                         // unused
+    );
+
+    PyObject *mt2_tombs_valid_ufunc = PyUFunc_FromFuncAndData(
+        mt2_tombs_valid_ufuncs,                                           // func
+        mt2_tombs_valid_data,                                             // data. Each is the mt2_loop to split across threads.
+        mt2_tombs_valid_types,                                            // types
+        2,                                                                // ntypes
+        12,                                                               // nin
+        1,                                                                // nout
+        PyUFunc_None,                                                     // identity
+        "mt2_tombs_valid_ufunc",                                          // name
+        "Numpy ufunc to compute mt2 of valid events, and NaN for others", // doc
+        0                                                                 // unused
+    );
+
+    PyObject *mt2_scan_ufunc = PyUFunc_FromFuncAndDataAndSignature(
+        mt2_scan_ufuncs,                                               // func
+        mt2_scan_data,                                                 // data. Each is the mt2_loop to split across threads.
+        mt2_scan_types,                                                // types
+        2,                                                             // ntypes
+        10,                                                            // nin
+        1,                                                             // nout
+        PyUFunc_None,                                                  // identity
+        "mt2_scan_ufunc",                                              // name
+        "Numpy gufunc to compute mt2 over a grid of invisible masses", // doc
+        0,                                                             // unused
+        "(),(),(),(),(),(),(),(),(k),()->(k)"                          // signature
+    );
+
+    PyObject *mt2_rows_ufunc = PyUFunc_FromFuncAndDataAndSignature(
+        mt2_rows_ufuncs,                                     // func
+        mt2_rows_data,                                       // data. Each is the mt2_loop to split across threads.
+        mt2_rows_types,                                      // types
+        2,                                                   // ntypes
+        2,                                                   // nin
+        1,                                                   // nout
+        PyUFunc_None,                                        // identity
+        "mt2_rows_ufunc",                                    // name
+        "Numpy gufunc to compute mt2 from rows of 10 inputs", // doc
+        0,                                                   // unused
+        "(10),()->()"                                        // signature
+    );
+
+    PyObject *mt2_polar_ufunc = PyUFunc_FromFuncAndData(
+        mt2_polar_ufuncs,                                   // func
+        mt2_polar_data,                                     // data. Each is the mt2_loop to split across threads.
+        mt2_polar_types,                                    // types
+        2,                                                  // ntypes
+        11,                                                 // nin
+        1,                                                  // nout
+        PyUFunc_None,                                       // identity
+        "mt2_polar_ufunc",                                  // name
+        "Numpy ufunc to compute mt2 from pt, phi and mass", // doc
+        0                                                   // unused
+    );
+
+    PyObject *mt2_four_vector_ufunc = PyUFunc_FromFuncAndData(
+        mt2_four_vector_ufuncs,                         // func
+        mt2_four_vector_data,                           // data. Each is the mt2_loop to split across threads.
+        mt2_four_vector_types,                          // types
+        2,                                              // ntypes
+        13,                                             // nin
+        1,                                              // nout
+        PyUFunc_None,                                   // identity
+        "mt2_four_vector_ufunc",                        // name
+        "Numpy ufunc to compute mt2 from four-vectors", // doc
+        0                                               // unused
+    );
+
+    PyObject *mt2_combinatorial_ufunc = PyUFunc_FromFuncAndDataAndSignature(
+        mt2_combinatorial_ufuncs,                                         // func
+        mt2_combinatorial_data,                                           // data. Each is the mt2_loop to split across threads.
+        mt2_combinatorial_types,                                          // types
+        2,                                                                // ntypes
+        11,                                                               // nin
+        2,                                                                // nout
+        PyUFunc_None,                                                     // identity
+        "mt2_combinatorial_ufunc",                                        // name
+        "Numpy gufunc to compute the least mt2 over pairings of objects", // doc
+        0,                                                                // unused
+        "(k),(k),(k),(k),(),(),(),(),(),(),()->(),()"                     // signature
+    );
+
+    PyObject *mt2_jagged_ufunc = PyUFunc_FromFuncAndDataAndSignature(
+        mt2_jagged_ufuncs,                                        // func
+        mt2_jagged_data,                                          // data. Each is the mt2_jagged_tasks to run.
+        mt2_jagged_types,                                         // types
+        2,                                                        // ntypes
+        12,                                                       // nin
+        1,                                                        // nout
+        PyUFunc_None,                                             // identity
+        "mt2_jagged_ufunc",                                       // name
+        "Numpy gufunc to compute mt2 of pairs of jagged objects", // doc
+        0,                                                        // unused
+        "(k),(k),(k),(n),(n),(n),(n),(n),(n),(n),(),()->(p)"      // signature
+    );
+
+    PyObject *mt2_above_ufunc = PyUFunc_FromFuncAndData(
+        mt2_above_ufuncs,                                       // func
+        mt2_above_data,                                         // data. Each is the mt2_loop to split across threads.
+        mt2_above_types,                                        // types
+        2,                                                      // ntypes
+        11,                                                     // nin
+        1,                                                      // nout
+        PyUFunc_None,                                           // identity
+        "mt2_above_ufunc",                                      // name
+        "Numpy ufunc to test whether mt2 is above a threshold", // doc
+        0                                                       // unused
+    );
+
+    PyObject *mt2_bracket_ufunc = PyUFunc_FromFuncAndData(
+        mt2_bracket_ufuncs,                                                       // func
+        mt2_bracket_data,                                                         // data. Each is the mt2_loop to split across threads.
+        mt2_bracket_types,                                                        // types
+        2,                                                                        // ntypes
+        11,                                                                       // nin
+        2,                                                                        // nout
+        PyUFunc_None,                                                             // identity
+        "mt2_bracket_ufunc",                                                      // name
+        "Numpy ufunc to bracket mt2 with a limited number of disjointness tests", // doc
+        0                                                                         // unused
+    );
+
+    PyObject *mt2_diagnostics_ufunc = PyUFunc_FromFuncAndData(
+        mt2_diagnostics_ufuncs,                                                 // func
+        mt2_diagnostics_data,                                                   // data. Each is the mt2_loop to split across threads.
+        mt2_diagnostics_types,                                                  // types
+        2,                                                                      // ntypes
+        11,                                                                     // nin
+        4,                                                                      // nout
+        PyUFunc_None,                                                           // identity
+        "mt2_diagnostics_ufunc",                                                // name
+        "Numpy ufunc to compute mt2, with the status and counts of its search", // doc
+        0                                                                       // unused
+    );
+
+    PyObject *mt2_histogram_ufunc = PyUFunc_FromFuncAndDataAndSignature(
+        mt2_histogram_ufuncs,                                            // func
+        data,                                                            // data
+        mt2_histogram_types,                                             // types
+        2,                                                               // ntypes
+        12,                                                              // nin
+        1,                                                               // nout
+        PyUFunc_None,                                                    // identity
+        "mt2_histogram_ufunc",                                           // name
+        "Numpy gufunc to histogram mt2 over events, with given weights", // doc
+        0,                                                               // unused
+        "(n),(n),(n),(n),(n),(n),(n),(n),(n),(n),(n),(e)->(k)"           // signature
+    );
+
+    PyObject *mt2_select_ufunc = PyUFunc_FromFuncAndDataAndSignature(
+        mt2_select_ufuncs,                                                  // func
+        data,                                                               // data
+        mt2_select_types,                                                   // types
+        2,                                                                  // ntypes
+        12,                                                                 // nin
+        2,                                                                  // nout
+        PyUFunc_None,                                                       // identity
+        "mt2_select_ufunc",                                                 // name
+        "Numpy gufunc to find the indices of events with mt2 in a window", // doc
+        0,                                                                  // unused
+        "(n),(n),(n),(n),(n),(n),(n),(n),(n),(n),(),()->(n),()"             // signature
+    );
+
     PyObject *module_dict = PyModule_GetDict(module);
     PyDict_SetItemString(module_dict, "mt2_lester_ufunc", mt2_lester_ufunc);
     PyDict_SetItemString(module_dict, "mt2_lally_ufunc", mt2_lally_ufunc);
     PyDict_SetItemString(module_dict, "mt2_tombs_ufunc", mt2_tombs_ufunc);
+    PyDict_SetItemString(module_dict, "mt2_tombs_hint_ufunc", mt2_tombs_hint_ufunc);
+    PyDict_SetItemString(module_dict, "mt2_tombs_valid_ufunc", mt2_tombs_valid_ufunc);
+    PyDict_SetItemString(module_dict, "mt2_scan_ufunc", mt2_scan_ufunc);
+    PyDict_SetItemString(module_dict, "mt2_rows_ufunc", mt2_rows_ufunc);
+    PyDict_SetItemString(module_dict, "mt2_polar_ufunc", mt2_polar_ufunc);
+    PyDict_SetItemString(module_dict, "mt2_four_vector_ufunc", mt2_four_vector_ufunc);
+    PyDict_SetItemString(module_dict, "mt2_above_ufunc", mt2_above_ufunc);
+    PyDict_SetItemString(module_dict, "mt2_bracket_ufunc", mt2_bracket_ufunc);
+    PyDict_SetItemString(module_dict, "mt2_diagnostics_ufunc", mt2_diagnostics_ufunc);
+    PyDict_SetItemString(module_dict, "mt2_combinatorial_ufunc", mt2_combinatorial_ufunc);
+    PyDict_SetItemString(module_dict, "mt2_jagged_ufunc", mt2_jagged_ufunc);
+    PyDict_SetItemString(module_dict, "mt2_histogram_ufunc", mt2_histogram_ufunc);
+    PyDict_SetItemString(module_dict, "mt2_select_ufunc", mt2_select_ufunc);
     PyDict_SetItemString(module_dict, "__version__", PyUnicode_FromString(MACRO_STRINGIFY(VERSION_INFO)));
+    PyObject *isa_name = PyUnicode_FromString(mt2_isas[isa].name);
+    PyDict_SetItemString(module_dict, "isa", isa_name);
+    Py_DECREF(isa_name);
+
+    PyObject *max_objects = PyLong_FromLong(MT2_MAX_OBJECTS);
+    PyDict_SetItemString(module_dict, "max_objects", max_objects);
+    Py_DECREF(max_objects);
+
+    PyObject *isas = PyList_New(0);
+    for (int i = 0; i < mt2_n_isas; ++i)
+    {
+        if (mt2_isas[i].supported())
+        {
+            PyObject *name = PyUnicode_FromString(mt2_isas[i].name);
+            PyList_Append(isas, name);
+            Py_DECREF(name);
+        }
+    }
+    PyObject *isas_tuple = PyList_AsTuple(isas);
+    PyDict_SetItemString(module_dict, "supported_isas", isas_tuple);
+    Py_DECREF(isas_tuple);
+    Py_DECREF(isas);
     Py_DECREF(mt2_lester_ufunc);
     Py_DECREF(mt2_lally_ufunc);
     Py_DECREF(mt2_tombs_ufunc);
+    Py_DECREF(mt2_tombs_hint_ufunc);
+    Py_DECREF(mt2_tombs_valid_ufunc);
+    Py_DECREF(mt2_scan_ufunc);
+    Py_DECREF(mt2_rows_ufunc);
+    Py_DECREF(mt2_polar_ufunc);
+    Py_DECREF(mt2_four_vector_ufunc);
+    Py_DECREF(mt2_above_ufunc);
+    Py_DECREF(mt2_bracket_ufunc);
+    Py_DECREF(mt2_diagnostics_ufunc);
+    Py_DECREF(mt2_combinatorial_ufunc);
+    Py_DECREF(mt2_jagged_ufunc);
+    Py_DECREF(mt2_histogram_ufunc);
+    Py_DECREF(mt2_select_ufunc);
 
     return module;
 }
@@ -0,0 +1,158 @@
+/*
+ * The C++ interface to MT2, for calling from compiled code without Python.
+ *
+ * This header, and those it includes, may be included in any number of
+ * translation units: the helpers of mt2_bisect.h are static, so that each
+ * unit inlines its own, and all other functions are inline. With CMake, after
+ * installing this package:
+ *
+ *     find_package(mt2 REQUIRED)
+ *     target_link_libraries(analysis PRIVATE mt2::mt2)
+ *
+ * and then, e.g.,
+ *
+ *     #include <mt2/mt2.h>
+ *
+ *     double m = mt2::mt2(100., 410., 20., 150., -210., -300., -200., 280.,
+ *                         100., 100.);
+ *
+ * Arguments are as for the Python function `mt2', in the same order:
+ *
+ *     am, apx, apy:
+ *         mass and transverse momentum components of one visible child
+ *     bm, bpx, bpy:
+ *         mass and transverse momentum components of the other visible child
+ *     sspx, sspy:
+ *         missing transverse momentum components
+ *     ssam, ssbm
+ *         masses of the invisible particles associated with `a' and `b'
+ *
+ * The Lester implementation prints a copyright notice on first use unless
+ * DISABLE_COPYRIGHT_PRINTING is defined. Please cite arxiv.org/abs/1411.4312
+ * and arxiv.org/abs/hep-ph/9906349 .
+ */
+#ifndef MT2_H
+#define MT2_H
+
+#include "lester_mt2_bisect_v7.h"
+#include "mt2_Lallyver2.h"
+#include "mt2_bisect.h"
+
+
+namespace mt2 {
+
+/* Types */
+typedef enum mt2_status status;
+typedef struct mt2_diagnostics diagnostics;
+
+
+/* Functions */
+/*
+ * Return MT2, by bisection to relative `precision', or the best possible if
+ * 0. This is the engine of the Python `mt2'.
+ */
+template <typename T>
+inline T
+mt2(T am, T apx, T apy, T bm, T bpx, T bpy, T sspx, T sspy, T ssam, T ssbm,
+    T precision=0)
+{
+    return mt2_bisect_impl(am, apx, apy, bm, bpx, bpy, sspx, sspy, ssam, ssbm,
+                           precision);
+}
+
+/*
+ * Return MT2 as for `mt2', and store how the search went in `*diagnostics';
+ * if `use_brent', search with Brent's method rather than bisection.
+ */
+template <typename T>
+inline T
+diagnose(T am, T apx, T apy, T bm, T bpx, T bpy, T sspx, T sspy, T ssam,
+         T ssbm, T precision, struct mt2_diagnostics *diagnostics,
+         bool use_brent=false)
+{
+    struct mt2_setup<T> setup;
+    if (!mt2_prepare(am, apx, apy, bm, bpx, bpy, sspx, sspy, ssam, ssbm,
+                     &setup)) {
+        if (diagnostics) {
+            diagnostics->status = setup.scale == 0 ? mt2_status_zero
+                                                   : mt2_status_nan_input;
+            diagnostics->expansions = diagnostics->tests = 0;
+        }
+        return setup.scale;
+    }
+    if (diagnostics)
+        *diagnostics = {mt2_status_ok, 0, 0};
+    return (use_brent ? mt2_brent_setup<T> : mt2_bisect_setup<T>)(
+        &setup, precision, 0, 0, NULL, diagnostics);
+}
+
+/*
+ * Return MT2 as for `mt2', but searching with Brent's method, and optionally
+ * store how the search went in `*diagnostics'.
+ */
+template <typename T>
+inline T
+brent(T am, T apx, T apy, T bm, T bpx, T bpy, T sspx, T sspy, T ssam, T ssbm,
+      T precision=0, struct mt2_diagnostics *diagnostics=NULL)
+{
+    return diagnose(am, apx, apy, bm, bpx, bpy, sspx, sspy, ssam, ssbm,
+                    precision, diagnostics, true);
+}
+
+/*
+ * Return whether MT2 is above `threshold', usually without finding it. NAN
+ * is never above.
+ */
+template <typename T>
+inline bool
+above(T am, T apx, T apy, T bm, T bpx, T bpy, T sspx, T sspy, T ssam, T ssbm,
+      T threshold)
+{
+    return mt2_above_impl(am, apx, apy, bm, bpx, bpy, sspx, sspy, ssam, ssbm,
+                          threshold);
+}
+
+/*
+ * Store in `*lo' and `*hi' bounds on MT2, made with at most `max_tests'
+ * disjointness tests, and return the number of tests made.
+ */
+template <typename T>
+inline int
+bracket(T am, T apx, T apy, T bm, T bpx, T bpy, T sspx, T sspy, T ssam,
+        T ssbm, int max_tests, T *lo, T *hi)
+{
+    struct mt2_kinematics<T> kinematics;
+    mt2_prepare_kinematics(am, apx, apy, bm, bpx, bpy, sspx, sspy,
+                           &kinematics);
+    return mt2_bracket_kinematics(&kinematics, ssam, ssbm, max_tests, lo, hi);
+}
+
+/*
+ * Return MT2 from the implementation of arxiv.org/abs/1411.4312, to absolute
+ * `precision'. This is the engine of the Python `mt2_arxiv'.
+ */
+inline double
+lester(double am, double apx, double apy, double bm, double bpx, double bpy,
+       double sspx, double sspy, double ssam, double ssbm,
+       double precision=0, bool use_deci_sections_initially=true)
+{
+    return asymm_mt2_lester_bisect::get_mT2(
+        am, apx, apy, bm, bpx, bpy, sspx, sspy, ssam, ssbm, precision,
+        use_deci_sections_initially);
+}
+
+/*
+ * Return MT2 from the implementation of arxiv.org/abs/1509.01831, to absolute
+ * `precision'.
+ */
+inline double
+lally(double am, double apx, double apy, double bm, double bpx, double bpy,
+      double sspx, double sspy, double ssam, double ssbm, double precision=0)
+{
+    return ::mt2_lally(am, apx, apy, bm, bpx, bpy, sspx, sspy, ssam, ssbm,
+                       precision);
+}
+
+}  /* namespace mt2 */
+
+#endif  /* MT2_H */
@@ -105,11 +105,11 @@ struct CubicCoeffs
 };
 
 // Define the key functions used by the algorithm - first one is self-evident, second one contains the Regula Falsi root-finding method, the third function is the check to see we have the right form of the lambda function
-double NewtonRootFinder(double, double, const DiscriminantCoeffs &, const CubicCoeffs &, double);
-double NewDeltaFinder(double, double, int, int, const DiscriminantCoeffs &, const CubicCoeffs &, double);
-int lambdaSgnchanges(double, const CubicCoeffs &);
+inline double NewtonRootFinder(double, double, const DiscriminantCoeffs &, const CubicCoeffs &, double);
+inline double NewDeltaFinder(double, double, int, int, const DiscriminantCoeffs &, const CubicCoeffs &, double);
+inline int lambdaSgnchanges(double, const CubicCoeffs &);
 
-double mt2_lally(
+inline double mt2_lally(
 
     double ma, // side "a" visible variables
     double pax,
@@ -400,7 +400,7 @@ double mt2_lally(
     return MT2;
 }
 
-double NewtonRootFinder(double LB, double UB, const DiscriminantCoeffs &discCoeffs, const CubicCoeffs &cubeCoeffs, double accuracy)
+inline double NewtonRootFinder(double LB, double UB, const DiscriminantCoeffs &discCoeffs, const CubicCoeffs &cubeCoeffs, double accuracy)
 {
     int maxIterations = 45; // for vast majority of events should find the root well before this, typically reach required accuracy after 10 iterations  - 45 has been found to be a reasonable number of iterations before N-R method should be abandoned.
     bool solutionFound = false;
@@ -502,7 +502,7 @@ double NewtonRootFinder(double LB, double UB, const DiscriminantCoeffs &discCoef
     return x1;
 }
 
-double NewDeltaFinder(double l_delta0, double l_delta, int bisectDivisor, int bisectMaxLoops, const DiscriminantCoeffs &discPolynomial, const CubicCoeffs &cubicPolynomial, double accuracy)
+inline double NewDeltaFinder(double l_delta0, double l_delta, int bisectDivisor, int bisectMaxLoops, const DiscriminantCoeffs &discPolynomial, const CubicCoeffs &cubicPolynomial, double accuracy)
 {
     double FunctionVal(double, const DiscriminantCoeffs &);                  // simple function to evaluate f(LB)*f(UB) if negative we know there is a root inbetween
     double RFRootFinder(double, double, const DiscriminantCoeffs &, double); // Regula Falsi function
@@ -665,7 +665,7 @@ double NewDeltaFinder(double l_delta0, double l_delta, int bisectDivisor, int bi
 }
 
 // Regula Falsi Method for root finding - used if original (NR) interation did not find correct root
-double RFRootFinder(double LB, double UB, const DiscriminantCoeffs &discCoeffs, double accuracy)
+inline double RFRootFinder(double LB, double UB, const DiscriminantCoeffs &discCoeffs, double accuracy)
 {
     double x0 = UB;             // starting guess for root value in RF method (using the kinematic lower bound)
     int maxIterationsRF = 1000; // second time around we definitely have bounds solvable by RF, so give it whatever time it needs (within reason!)
@@ -730,7 +730,7 @@ double RFRootFinder(double LB, double UB, const DiscriminantCoeffs &discCoeffs,
     return x0;
 }
 
-int lambdaSgnchanges(double deltaFunc, const CubicCoeffs &cubeCoeffs)
+inline int lambdaSgnchanges(double deltaFunc, const CubicCoeffs &cubeCoeffs)
 {
     const double l3 = cubeCoeffs.Coeffa2 * deltaFunc * deltaFunc + cubeCoeffs.Coeffa1 * deltaFunc + cubeCoeffs.Coeffa0;
     const double l2 = cubeCoeffs.Coeffb2 * deltaFunc * deltaFunc + cubeCoeffs.Coeffb1 * deltaFunc + cubeCoeffs.Coeffb0;
@@ -747,7 +747,7 @@ int lambdaSgnchanges(double deltaFunc, const CubicCoeffs &cubeCoeffs)
     return nsc;
 }
 
-double FunctionVal(double LB, const DiscriminantCoeffs &discCoeffs)
+inline double FunctionVal(double LB, const DiscriminantCoeffs &discCoeffs)
 {
     const double LBsq = LB * LB;
     const double LBsqsq = LBsq * LBsq;
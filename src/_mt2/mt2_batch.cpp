@@ -0,0 +1,587 @@
+/*
+ * mt2_batch, a command-line driver for MT2 of datasets larger than memory.
+ *
+ *     mt2_batch [-c chunk] [-j threads] [-p precision] [-m bisect|brent]
+ *               [-t f8|f4] [-s first] [-n count] -o out.npy name=column ...
+ *
+ * Each of the ten arguments of MT2 is given as `name=column', with the names
+ * of the Python `mt2' (m_vis_1, px_vis_1, ..., m_invis_2). The column is either
+ * a number, used for every event, or the path of a file of values: a 1-d .npy
+ * file of little-endian float64 or float32, or a raw file of native values of
+ * the dtype given by -t (f8, the default, or f4).
+ *
+ * Files are memory-mapped, and events are computed `chunk' at a time (2^20 by
+ * default) by the SIMD and threaded loops of libmt2, with `threads' threads
+ * (1 by default, 0 for one per CPU). While a chunk is computed, the inputs of
+ * the next are read in, and the results of the last written back. Once a
+ * chunk is done, its pages of the inputs are dropped, and those of the output
+ * written back and dropped, so that the memory resident is bounded by the
+ * chunk size rather than the dataset. Events from `first' (0 by default),
+ * `count' of them (the rest by default), are computed, so that a job array
+ * may split one dataset.
+ *
+ * The results are written as a float64 .npy file, itself memory-mapped. The
+ * program prints its path and returns 0 on success, or prints an error and
+ * returns 1.
+ */
+
+/*
+ * Includes
+ *
+ * cerrno
+ *     errno
+ * chrono
+ *     std::chrono::steady_clock
+ * cstdio
+ *     std::fprintf, std::printf
+ * cstdlib
+ *     std::strtod, std::strtol, std::strtoull
+ * cstring
+ *     std::memcmp, std::memcpy, std::strchr, std::strcmp, std::strerror
+ * limits
+ *     std::numeric_limits
+ * string
+ *     std::string, std::to_string
+ * vector
+ *     std::vector
+ * fcntl.h
+ *     open
+ * sys/mman.h
+ *     mmap, munmap, madvise, msync
+ * sys/stat.h
+ *     fstat
+ * unistd.h
+ *     close, ftruncate, sysconf
+ */
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "mt2_c.h"
+
+
+/* The arguments of MT2, in order. */
+static const char *const mt2_batch_names[10] = {
+    "m_vis_1", "px_vis_1", "py_vis_1", "m_vis_2", "px_vis_2",
+    "py_vis_2", "px_miss", "py_miss", "m_invis_1", "m_invis_2"};
+
+static const char mt2_batch_npy_magic[6] = {'\x93', 'N', 'U', 'M', 'P', 'Y'};
+
+
+/* Files */
+/* A memory-mapped file. */
+struct mt2_batch_map
+{
+    char *base;
+    size_t length;
+    /* Bytes from the start of `base' before which pages have been dropped. */
+    size_t dropped;
+};
+
+static size_t
+mt2_batch_page_size(void)
+{
+    static const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    return page;
+}
+
+/*
+ * Drop the pages of `map' wholly before byte `end', which are no longer
+ * needed, first starting the write back of any that are dirty.
+ */
+static void
+mt2_batch_drop(struct mt2_batch_map *map, size_t end, bool dirty)
+{
+    end -= end % mt2_batch_page_size();
+    if (end <= map->dropped)
+        return;
+    if (dirty)
+        msync(map->base + map->dropped, end - map->dropped, MS_ASYNC);
+    madvise(map->base + map->dropped, end - map->dropped, MADV_DONTNEED);
+    map->dropped = end;
+}
+
+/*
+ * Ask for bytes [begin, end) of `map' to be read in, without waiting, so that
+ * reading them overlaps whatever is done meanwhile.
+ */
+static void
+mt2_batch_prefetch(struct mt2_batch_map *map, size_t begin, size_t end)
+{
+    begin -= begin % mt2_batch_page_size();
+    if (end > map->length)
+        end = map->length;
+    if (begin < end)
+        madvise(map->base + begin, end - begin, MADV_WILLNEED);
+}
+
+static void
+mt2_batch_unmap(struct mt2_batch_map *map)
+{
+    if (map->length > 0)
+        munmap(map->base, map->length);
+    map->base = NULL;
+    map->length = 0;
+}
+
+/*
+ * Map the file at `path', read-only or, if `create', created or truncated to
+ * `length' bytes for reading and writing. Returns false with `*error' set on
+ * failure.
+ */
+static bool
+mt2_batch_map_file(const char *path, bool create, size_t length,
+                   struct mt2_batch_map *map, std::string *error)
+{
+    const int fd = create ? open(path, O_RDWR | O_CREAT | O_TRUNC, 0644)
+                          : open(path, O_RDONLY);
+    struct stat status;
+    bool ok = fd >= 0;
+    if (ok && create)
+        ok = ftruncate(fd, (off_t)length) == 0;
+    else if (ok)
+    {
+        ok = fstat(fd, &status) == 0;
+        length = ok ? (size_t)status.st_size : 0;
+    }
+
+    map->base = NULL;
+    map->length = length;
+    map->dropped = 0;
+    if (ok && length > 0)
+    {
+        void *base = mmap(NULL, length, create ? PROT_READ | PROT_WRITE : PROT_READ,
+                          MAP_SHARED, fd, 0);
+        ok = base != MAP_FAILED;
+        if (ok)
+        {
+            map->base = (char *)base;
+            madvise(base, length, MADV_SEQUENTIAL);
+        }
+    }
+    if (!ok)
+    {
+        *error = std::string(path) + ": " + std::strerror(errno);
+        map->length = 0;
+    }
+    if (fd >= 0)
+        close(fd);
+    return ok;
+}
+
+/*
+ * Parse the header of the .npy file mapped by `map', setting `*offset' to the
+ * start of its data, `*dtype' to its descr and `*n' to its length.
+ */
+static bool
+mt2_batch_parse_npy(const struct mt2_batch_map *map, size_t *offset,
+                    std::string *dtype, size_t *n, std::string *error)
+{
+    const unsigned char *bytes = (const unsigned char *)map->base;
+    size_t header_length = 0;
+    size_t start = 0;
+    if (map->length >= 10 && bytes[6] == 1)
+    {
+        header_length = bytes[8] | (size_t)bytes[9] << 8;
+        start = 10;
+    }
+    else if (map->length >= 12 && (bytes[6] == 2 || bytes[6] == 3))
+    {
+        header_length = bytes[8] | (size_t)bytes[9] << 8 | (size_t)bytes[10] << 16 |
+                        (size_t)bytes[11] << 24;
+        start = 12;
+    }
+    if (start == 0 || start + header_length > map->length)
+    {
+        *error = "unsupported .npy version";
+        return false;
+    }
+    const std::string header(map->base + start, header_length);
+    *offset = start + header_length;
+
+    /* The header is a Python dict literal, as written by numpy. */
+    size_t at = header.find("'descr':");
+    const size_t quote = at == std::string::npos ? at : header.find('\'', at + 8);
+    const size_t end = quote == std::string::npos ? quote : header.find('\'', quote + 1);
+    if (end == std::string::npos)
+    {
+        *error = "no descr in .npy header";
+        return false;
+    }
+    *dtype = header.substr(quote + 1, end - quote - 1);
+
+    at = header.find("'shape':");
+    const size_t left = at == std::string::npos ? at : header.find('(', at);
+    const size_t right = left == std::string::npos ? left : header.find(')', left);
+    if (right == std::string::npos)
+    {
+        *error = "no shape in .npy header";
+        return false;
+    }
+    const std::string shape = header.substr(left + 1, right - left - 1);
+    char *shape_end = NULL;
+    *n = std::strtoull(shape.c_str(), &shape_end, 10);
+    while (*shape_end == ' ' || *shape_end == ',')
+        ++shape_end;
+    if (shape_end == shape.c_str() || *shape_end != '\0')
+    {
+        *error = "not a 1-d array, with shape (" + shape + ")";
+        return false;
+    }
+    return true;
+}
+
+/*
+ * Create the .npy file of `n' float64 at `path', mapped by `map', and set
+ * `*data' to its values.
+ */
+static bool
+mt2_batch_create_npy(const char *path, size_t n, struct mt2_batch_map *map,
+                     double **data, std::string *error)
+{
+    std::string header = "{'descr': '<f8', 'fortran_order': False, 'shape': (" +
+                         std::to_string(n) + ",), }";
+    /* The data are aligned to 64 bytes, as numpy aligns them. */
+    const size_t length = 10 + header.size() + 1;
+    header.append((64 - length % 64) % 64, ' ');
+    header += '\n';
+
+    if (!mt2_batch_map_file(path, true, 10 + header.size() + n * sizeof(double), map, error))
+        return false;
+    std::memcpy(map->base, mt2_batch_npy_magic, 6);
+    map->base[6] = 1;
+    map->base[7] = 0;
+    map->base[8] = (char)(header.size() & 0xff);
+    map->base[9] = (char)(header.size() >> 8);
+    std::memcpy(map->base + 10, header.data(), header.size());
+    *data = (double *)(map->base + 10 + header.size());
+    return true;
+}
+
+
+/* Columns */
+/* An argument of MT2, as a number or as a mapped file of values. */
+struct mt2_batch_column
+{
+    const char *path;
+    double value;
+    struct mt2_batch_map map;
+    const char *data;
+    /* Bytes per value: 8 or 4, or 0 for a number. */
+    int itemsize;
+    size_t n;
+    /* Values of the chunk, when they are not float64 in the file. */
+    std::vector<double> chunk;
+};
+
+/* Map the file of `column', whose raw values have bytes per value `itemsize'. */
+static bool
+mt2_batch_open_column(struct mt2_batch_column *column, int raw_itemsize,
+                      std::string *error)
+{
+    if (!mt2_batch_map_file(column->path, false, 0, &column->map, error))
+        return false;
+
+    size_t offset = 0;
+    if (column->map.length >= 6 && std::memcmp(column->map.base, mt2_batch_npy_magic, 6) == 0)
+    {
+        std::string dtype;
+        if (!mt2_batch_parse_npy(&column->map, &offset, &dtype, &column->n, error))
+        {
+            *error = std::string(column->path) + ": " + *error;
+            return false;
+        }
+        if (dtype == "<f8")
+            column->itemsize = 8;
+        else if (dtype == "<f4")
+            column->itemsize = 4;
+        else
+        {
+            *error = std::string(column->path) + ": unsupported dtype " + dtype +
+                     "; expected <f8 or <f4";
+            return false;
+        }
+        if (offset + column->n * column->itemsize > column->map.length)
+        {
+            *error = std::string(column->path) + ": truncated";
+            return false;
+        }
+    }
+    else
+    {
+        column->itemsize = raw_itemsize;
+        if (column->map.length % raw_itemsize != 0)
+        {
+            *error = std::string(column->path) + ": length is not a whole number of values";
+            return false;
+        }
+        column->n = column->map.length / raw_itemsize;
+    }
+    column->data = column->map.base + offset;
+    return true;
+}
+
+/*
+ * Return the values of `column' for events [begin, begin + n), converting
+ * them into its chunk if they are not float64 in the file.
+ */
+static const double *
+mt2_batch_read(struct mt2_batch_column *column, size_t begin, size_t n)
+{
+    if (column->itemsize == 8)
+        return (const double *)column->data + begin;
+    if (column->itemsize == 4)
+    {
+        const float *values = (const float *)column->data + begin;
+        for (size_t i = 0; i < n; ++i)
+            column->chunk[i] = values[i];
+    }
+    return column->chunk.data();
+}
+
+
+/* The driver */
+
+/*
+ * Parse the whole of `text' as a number, returning false if any of it is left
+ * over, or the number is out of range of `*value'.
+ */
+static bool
+parse(const char *text, size_t *value)
+{
+    /* strtoull would take a sign, and negate what follows. */
+    if (*text < '0' || *text > '9')
+        return false;
+    char *end = NULL;
+    errno = 0;
+    const unsigned long long parsed = std::strtoull(text, &end, 10);
+    if (errno || *end != '\0' || parsed > std::numeric_limits<size_t>::max())
+        return false;
+    *value = (size_t)parsed;
+    return true;
+}
+
+static bool
+parse(const char *text, int *value)
+{
+    char *end = NULL;
+    errno = 0;
+    const long parsed = std::strtol(text, &end, 10);
+    if (errno || end == text || *end != '\0' || parsed < std::numeric_limits<int>::min() ||
+        parsed > std::numeric_limits<int>::max())
+        return false;
+    *value = (int)parsed;
+    return true;
+}
+
+static bool
+parse(const char *text, double *value)
+{
+    char *end = NULL;
+    errno = 0;
+    *value = std::strtod(text, &end);
+    return !errno && end != text && *end == '\0';
+}
+
+static int
+usage(const char *program)
+{
+    std::fprintf(stderr,
+                 "usage: %s [-c chunk] [-j threads] [-p precision] "
+                 "[-m bisect|brent] [-t f8|f4] [-s first] [-n count] "
+                 "-o out.npy name=column ...\n",
+                 program);
+    return 1;
+}
+
+static int
+fail(const char *program, const std::string &error)
+{
+    std::fprintf(stderr, "%s: %s\n", program, error.c_str());
+    return 1;
+}
+
+int
+main(int argc, char **argv)
+{
+    size_t chunk = (size_t)1 << 20;
+    size_t first = 0;
+    size_t count = (size_t)-1;
+    int raw_itemsize = 8;
+    const char *out_path = NULL;
+    mt2_options options;
+    mt2_options_init(&options);
+
+    struct mt2_batch_column columns[10];
+    bool given[10] = {false};
+    for (int i = 1; i < argc; ++i)
+    {
+        const bool has_value = i + 1 < argc;
+        const char *equals = std::strchr(argv[i], '=');
+        if (!std::strcmp(argv[i], "-c") && has_value)
+        {
+            if (!parse(argv[++i], &chunk))
+                return usage(argv[0]);
+        }
+        else if (!std::strcmp(argv[i], "-j") && has_value)
+        {
+            if (!parse(argv[++i], &options.threads))
+                return usage(argv[0]);
+        }
+        else if (!std::strcmp(argv[i], "-p") && has_value)
+        {
+            if (!parse(argv[++i], &options.precision))
+                return usage(argv[0]);
+        }
+        else if (!std::strcmp(argv[i], "-m") && has_value)
+        {
+            ++i;
+            if (!std::strcmp(argv[i], "bisect"))
+                options.method = MT2_METHOD_BISECT;
+            else if (!std::strcmp(argv[i], "brent"))
+                options.method = MT2_METHOD_BRENT;
+            else
+                return usage(argv[0]);
+        }
+        else if (!std::strcmp(argv[i], "-t") && has_value)
+        {
+            ++i;
+            if (!std::strcmp(argv[i], "f8") || !std::strcmp(argv[i], "f4"))
+                raw_itemsize = argv[i][1] - '0';
+            else
+                return usage(argv[0]);
+        }
+        else if (!std::strcmp(argv[i], "-s") && has_value)
+        {
+            if (!parse(argv[++i], &first))
+                return usage(argv[0]);
+        }
+        else if (!std::strcmp(argv[i], "-n") && has_value)
+        {
+            if (!parse(argv[++i], &count))
+                return usage(argv[0]);
+        }
+        else if (!std::strcmp(argv[i], "-o") && has_value)
+            out_path = argv[++i];
+        else if (equals)
+        {
+            const std::string name(argv[i], equals - argv[i]);
+            int k = 0;
+            while (k < 10 && name != mt2_batch_names[k])
+                ++k;
+            if (k == 10)
+                return fail(argv[0], "unknown argument " + name);
+            struct mt2_batch_column *column = &columns[k];
+            column->path = equals + 1;
+            char *end = NULL;
+            column->value = std::strtod(column->path, &end);
+            column->itemsize = end != column->path && *end == '\0' ? 0 : -1;
+            column->map.length = 0;
+            given[k] = true;
+        }
+        else
+            return usage(argv[0]);
+    }
+    if (!out_path || chunk == 0 || options.threads < 0 || !(options.precision >= 0))
+        return usage(argv[0]);
+
+    /* Map the files, which must all have the same length. */
+    std::string error;
+    size_t n = (size_t)-1;
+    for (int k = 0; k < 10; ++k)
+    {
+        if (!given[k])
+            return fail(argv[0], std::string("no column for ") + mt2_batch_names[k]);
+        struct mt2_batch_column *column = &columns[k];
+        if (column->itemsize == 0)
+            continue;
+        if (!mt2_batch_open_column(column, raw_itemsize, &error))
+            return fail(argv[0], error);
+        if (n != (size_t)-1 && column->n != n)
+            return fail(argv[0], std::string(column->path) + ": length " +
+                                     std::to_string(column->n) + " differs from " +
+                                     std::to_string(n));
+        n = column->n;
+    }
+    if (n == (size_t)-1)
+        return fail(argv[0], "at least one column must be a file");
+    if (first > n)
+        return fail(argv[0], "first event is beyond the last");
+    if (count > n - first)
+        count = n - first;
+
+    struct mt2_batch_map out_map;
+    double *out = NULL;
+    if (!mt2_batch_create_npy(out_path, count, &out_map, &out, &error))
+        return fail(argv[0], error);
+
+    const size_t chunk_capacity = count < chunk ? count : chunk;
+    for (int k = 0; k < 10; ++k)
+    {
+        struct mt2_batch_column *column = &columns[k];
+        if (column->itemsize != 8)
+            column->chunk.assign(chunk_capacity, column->value);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t done = 0; done < count; done += chunk)
+    {
+        const size_t size = count - done < chunk ? count - done : chunk;
+        const double *in[10];
+        for (int k = 0; k < 10; ++k)
+            in[k] = mt2_batch_read(&columns[k], first + done, size);
+
+        /* The next chunk is read in while this one is computed, and the last
+         * written back, so that I/O overlaps the computation. */
+        for (int k = 0; k < 10; ++k)
+        {
+            struct mt2_batch_column *column = &columns[k];
+            if (column->itemsize > 0)
+            {
+                const size_t next = column->data - column->map.base +
+                                    (first + done + size) * column->itemsize;
+                mt2_batch_prefetch(&column->map, next, next + chunk * column->itemsize);
+            }
+        }
+
+        const int status = mt2_batch_f64(in[0], in[1], in[2], in[3], in[4], in[5], in[6],
+                                         in[7], in[8], in[9], size, out + done, &options);
+        if (status != MT2_OK)
+            return fail(argv[0], "mt2_batch_f64 failed with status " + std::to_string(status));
+
+        for (int k = 0; k < 10; ++k)
+        {
+            struct mt2_batch_column *column = &columns[k];
+            if (column->itemsize > 0)
+            {
+                const size_t end = column->data - column->map.base +
+                                   (first + done + size) * column->itemsize;
+                mt2_batch_drop(&column->map, end, false);
+            }
+        }
+        mt2_batch_drop(&out_map, (char *)(out + done + size) - out_map.base, true);
+    }
+    const double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (out_map.length > 0 && msync(out_map.base, out_map.length, MS_SYNC) != 0)
+        return fail(argv[0], std::string(out_path) + ": " + std::strerror(errno));
+    mt2_batch_unmap(&out_map);
+    for (int k = 0; k < 10; ++k)
+        mt2_batch_unmap(&columns[k].map);
+
+    std::fprintf(stderr, "%zu events in %.3f s, %.0f ns per event\n", count, seconds,
+                 count > 0 ? 1e9 * seconds / count : 0.0);
+    std::printf("%s\n", out_path);
+    return 0;
+}
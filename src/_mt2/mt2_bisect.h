@@ -5,16 +5,24 @@
  *
  * C++-subset version.
  */
+#ifndef MT2_BISECT_H
+#define MT2_BISECT_H
 
 /*
  * Includes
  *
+ * algorithm
+ *     std::lower_bound
  * cmath
  *     std::sqrt, std::fabs, std::fmax
+ * cstddef
+ *     NULL
  * limits
  *     std::numeric_limits
  */
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
 #include <limits>
 
 
@@ -54,8 +62,117 @@ struct mt2_trio {
     T c2;
 };
 
+/*
+ * The visible and missing momenta of an event, with masses clipped, and their
+ * contributions to the physical scale. These do not depend on the invisible
+ * masses, so can be shared when scanning over them.
+ */
+template <typename T>
+struct mt2_kinematics {
+    T am;
+    T apx;
+    T apy;
+    T bm;
+    T bpx;
+    T bpy;
+    T sspx;
+    T sspy;
+    T ss2;
+    T vis2;
+};
+
+/* How the bracket on MT2 is narrowed, once found. */
+enum mt2_method {
+    mt2_method_bisect,
+    mt2_method_brent,
+    mt2_n_methods
+};
+
+/* How the search for MT2 ended, for one event. */
+enum mt2_status {
+    mt2_status_ok,          /* MT2 was found to the requested precision. */
+    mt2_status_zero,        /* All inputs were 0, so MT2 is 0. */
+    mt2_status_nan_input,   /* A momentum was NAN, so MT2 is NAN. */
+    mt2_status_no_bracket,  /* A test failed while expanding; MT2 is NAN. */
+    mt2_status_unbounded,   /* No upper bound was found; MT2 is infinite. */
+    mt2_status_imprecise    /* A test failed while narrowing the bracket,
+                               whose lower end is returned. */
+};
+
+/* The work done to find MT2 for one event, and how it ended. */
+struct mt2_diagnostics {
+    enum mt2_status status;
+    unsigned expansions;  /* Tests which expanded the upper bound. */
+    unsigned tests;       /* All disjointness tests, including expansions. */
+};
+
+/* An event ready for bisection, in units squeezed by `scale'. */
+template <typename T>
+struct mt2_setup {
+    struct mt2_trio<T> quadratics[4];
+    T lo;
+    T scale;
+};
+
 
 /* Template declarations */
+template <typename T>
+static bool mt2_prepare(T am, T apx, T apy,
+                        T bm, T bpx, T bpy,
+                        T sspx, T sspy,
+                        T ssam, T ssbm,
+                        struct mt2_setup<T> *setup);
+
+template <typename T>
+static void mt2_prepare_kinematics(T am, T apx, T apy,
+                                   T bm, T bpx, T bpy,
+                                   T sspx, T sspy,
+                                   struct mt2_kinematics<T> *kinematics);
+
+template <typename T>
+static bool mt2_prepare_masses(const struct mt2_kinematics<T> *kinematics,
+                               T ssam, T ssbm,
+                               struct mt2_setup<T> *setup);
+
+template <typename T>
+static T mt2_scale(const struct mt2_kinematics<T> *kinematics, T ssam, T ssbm);
+
+template <typename T>
+static bool mt2_above_kinematics(const struct mt2_kinematics<T> *kinematics,
+                                 T ssam, T ssbm, T threshold,
+                                 struct mt2_diagnostics *diagnostics=NULL);
+
+template <typename T>
+static int mt2_count_at_or_below_kinematics(
+    const struct mt2_kinematics<T> *kinematics,
+    T ssam, T ssbm, const T *edges, int n_edges,
+    struct mt2_diagnostics *diagnostics=NULL);
+
+template <typename T>
+static int mt2_bracket_kinematics(const struct mt2_kinematics<T> *kinematics,
+                                  T ssam, T ssbm, int max_tests,
+                                  T *lo, T *hi);
+
+template <typename T>
+static bool mt2_above_setup(const struct mt2_setup<T> *setup, T m, bool *error);
+
+template <typename T>
+static T mt2_upper_bound(const struct mt2_kinematics<T> *kinematics,
+                         T ssam, T ssbm, T squeeze);
+
+template <typename T>
+static T mt2_transverse_mass2(T m, T px, T py, T ssm, T sspx, T sspy);
+
+template <typename T>
+static T mt2_bisect_setup(const struct mt2_setup<T> *setup, T precision,
+                          T lo_hint=0, T hi_hint=0, T *bracket_lo=NULL,
+                          struct mt2_diagnostics *diagnostics=NULL);
+
+template <typename T>
+static T mt2_brent_setup(const struct mt2_setup<T> *setup, T precision,
+                         T lo_hint=0, T hi_hint=0, T *bracket_lo=NULL,
+                         struct mt2_diagnostics *diagnostics=NULL);
+
 template <typename T>
 static struct mt2_conic<T> mt2_ellipse(T m, T px, T py, T ssm, T sspx, T sspy);
 
@@ -70,7 +187,8 @@ static struct mt2_trio<T> mt2_lester(const struct mt2_conic<T> *a,
                                      const struct mt2_conic<T> *b);
 
 template <typename T>
-static bool mt2_disjoint(const struct mt2_trio<T> qs[4], T m, bool *error);
+static bool mt2_disjoint(const struct mt2_trio<T> qs[4], T m, bool *error,
+                         T *discriminant=NULL);
 
 template <typename T>
 static inline T mt2_eval_quadratic(const struct mt2_trio<T> *p, T x);
@@ -110,6 +228,69 @@ mt2_bisect_impl(T am, T apx, T apy,
                 T sspx, T sspy,
                 T ssam, T ssbm,
                 T precision=0)
+{
+    struct mt2_setup<T> setup;
+    if (mt2_rare(!mt2_prepare(am, apx, apy, bm, bpx, bpy,
+                              sspx, sspy, ssam, ssbm, &setup)))
+        return setup.scale;
+
+    return mt2_bisect_setup(&setup, precision);
+}
+
+/*
+ * Return whether asymmetric MT2 is above `threshold', usually without
+ * finding it.
+ *
+ * Arguments are as for `mt2_bisect_impl'. The result agrees with
+ * `mt2_bisect_impl(...) > threshold', except that NAN results are never
+ * above, and thresholds within the precision of MT2 may go either way.
+ */
+template <typename T>
+bool
+mt2_above_impl(T am, T apx, T apy,
+               T bm, T bpx, T bpy,
+               T sspx, T sspy,
+               T ssam, T ssbm,
+               T threshold)
+{
+    struct mt2_kinematics<T> kinematics;
+    mt2_prepare_kinematics(am, apx, apy, bm, bpx, bpy, sspx, sspy,
+                           &kinematics);
+    return mt2_above_kinematics(&kinematics, ssam, ssbm, threshold);
+}
+
+/*
+ * Do the per-event work that precedes bisection.
+ *
+ * Masses are clipped, the legs sorted and squeezed by a physical scale, and
+ * the ellipse properties built as quadratics in mass squared.
+ *
+ * Returns:
+ *     false if the scale is 0 or NAN, in which case mt2 is `setup->scale'.
+ */
+template <typename T>
+static bool
+mt2_prepare(T am, T apx, T apy,
+            T bm, T bpx, T bpy,
+            T sspx, T sspy,
+            T ssam, T ssbm,
+            struct mt2_setup<T> *setup)
+{
+    struct mt2_kinematics<T> kinematics;
+    mt2_prepare_kinematics(am, apx, apy, bm, bpx, bpy, sspx, sspy,
+                           &kinematics);
+    return mt2_prepare_masses(&kinematics, ssam, ssbm, setup);
+}
+
+/*
+ * The part of `mt2_prepare' which does not depend on the invisible masses.
+ */
+template <typename T>
+static void
+mt2_prepare_kinematics(T am, T apx, T apy,
+                       T bm, T bpx, T bpy,
+                       T sspx, T sspy,
+                       struct mt2_kinematics<T> *kinematics)
 {
     /* A previous version did not define behaviour for negative masses.
      * In response to user feedback, we now define this function to treat any
@@ -117,20 +298,50 @@ mt2_bisect_impl(T am, T apx, T apy,
      */
     am = std::fmax(am, 0);
     bm = std::fmax(bm, 0);
+
+    kinematics->am = am;
+    kinematics->apx = apx;
+    kinematics->apy = apy;
+    kinematics->bm = bm;
+    kinematics->bpx = bpx;
+    kinematics->bpy = bpy;
+    kinematics->sspx = sspx;
+    kinematics->sspy = sspy;
+    kinematics->ss2 = sspx*sspx + sspy*sspy;
+    kinematics->vis2 = (
+        (apx*apx + apy*apy + am*am) + (bpx*bpx + bpy*bpy + bm*bm));
+}
+
+/*
+ * The rest of `mt2_prepare', for kinematics from `mt2_prepare_kinematics'.
+ */
+template <typename T>
+static bool
+mt2_prepare_masses(const struct mt2_kinematics<T> *kinematics,
+                   T ssam, T ssbm,
+                   struct mt2_setup<T> *setup)
+{
+    auto am = kinematics->am;
+    auto apx = kinematics->apx;
+    auto apy = kinematics->apy;
+    auto bm = kinematics->bm;
+    auto bpx = kinematics->bpx;
+    auto bpy = kinematics->bpy;
+    auto sspx = kinematics->sspx;
+    auto sspy = kinematics->sspy;
+
     ssam = std::fmax(ssam, 0);
     ssbm = std::fmax(ssbm, 0);
 
-    /* This physical scale is used for initial bounding and input testing. */
-    const auto scale = std::sqrt(0.125f*(
-        sspx*sspx + sspy*sspy + (ssam*ssam + ssbm*ssbm)
-        + ((apx*apx + apy*apy + am*am) + (bpx*bpx + bpy*bpy + bm*bm))
-    ));
+    const auto scale = mt2_scale(kinematics, ssam, ssbm);
 
-    const auto squeeze = 1 / scale;
+    setup->scale = scale;
 
     /* If scale is 0 or NAN, then mt2 is also. */
     if (mt2_rare(!(scale > 0)))
-        return scale;
+        return false;
+
+    const auto squeeze = 1 / scale;
 
     /* Sort legs by lower bounds on the parent mass. */
     if (am + ssam > bm + ssbm) {
@@ -153,35 +364,340 @@ mt2_bisect_impl(T am, T apx, T apy,
     ssbm *= squeeze;
 
     /* At `lo', the ellipses will be disjoint. */
-    auto lo = bm + ssbm;
-    auto hi = lo + 1;
+    setup->lo = bm + ssbm;
 
     /* Construct the ellipses and their properties as quadratics. */
-    auto a_ellipse = mt2_ellipse_rest(am, -apx, -apy, ssam);
-    auto b_ellipse = mt2_ellipse(bm, bpx, bpy, ssbm, sspx, sspy);
+    const auto a_ellipse = mt2_ellipse_rest(am, -apx, -apy, ssam);
+    const auto b_ellipse = mt2_ellipse(bm, bpx, bpy, ssbm, sspx, sspy);
+
+    setup->quadratics[0] = mt2_det(&a_ellipse);
+    setup->quadratics[1] = mt2_det(&b_ellipse);
+    setup->quadratics[2] = mt2_lester(&a_ellipse, &b_ellipse);
+    setup->quadratics[3] = mt2_lester(&b_ellipse, &a_ellipse);
+    return true;
+}
+
+/*
+ * Return the physical scale of an event, for clipped invisible masses.
+ *
+ * This is used for initial bounding and input testing.
+ */
+template <typename T>
+static T
+mt2_scale(const struct mt2_kinematics<T> *kinematics, T ssam, T ssbm)
+{
+    return std::sqrt(0.125f*(
+        kinematics->ss2 + (ssam*ssam + ssbm*ssbm) + kinematics->vis2
+    ));
+}
+
+/*
+ * The rest of `mt2_above_impl', for kinematics from `mt2_prepare_kinematics'.
+ *
+ * Cheap bounds settle most events: MT2 is at least the larger sum of masses
+ * on either side, and at most `mt2_upper_bound'. Otherwise, the ellipses are
+ * built and tested once, at the threshold.
+ *
+ * If `diagnostics' is not NULL, its count of tests is increased by any made.
+ */
+template <typename T>
+static bool
+mt2_above_kinematics(const struct mt2_kinematics<T> *kinematics,
+                     T ssam, T ssbm, T threshold,
+                     struct mt2_diagnostics *diagnostics)
+{
+    ssam = std::fmax(ssam, 0);
+    ssbm = std::fmax(ssbm, 0);
+
+    /* As in `mt2_prepare_masses', mt2 is the scale if it is 0 or NAN; if it
+     * is infinite, nothing survives squeezing and mt2 is NAN. */
+    const auto scale = mt2_scale(kinematics, ssam, ssbm);
+    const auto infinity = std::numeric_limits<T>::infinity();
+    if (mt2_rare(!(scale > 0 && scale < infinity)))
+        return scale < infinity && scale > threshold;
+
+    if (threshold < std::fmax(kinematics->am + ssam, kinematics->bm + ssbm))
+        return true;
+
+    /* Bound in squeezed units, as `mt2_prepare_masses' works. */
+    const auto squeeze = 1 / scale;
+    const auto m = threshold * squeeze;
+    if (mt2_upper_bound(kinematics, ssam, ssbm, squeeze) <= m)
+        return false;
+
+    struct mt2_setup<T> setup;
+    mt2_prepare_masses(kinematics, ssam, ssbm, &setup);
+    bool error;
+    const auto above = mt2_above_setup(&setup, m, &error);
+    if (diagnostics)
+        ++diagnostics->tests;
+    return above && !error;
+}
+
+/*
+ * Return how many of the ascending `edges' are at or below asymmetric MT2,
+ * for kinematics from `mt2_prepare_kinematics', or -1 if MT2 is NAN.
+ *
+ * The event is in the bin from edges[k - 1] up to but not including
+ * edges[k], where k is the result, as in `numpy.histogram'. As in
+ * `mt2_above_kinematics', cheap bounds on MT2 narrow down the edges, and then
+ * a binary search over those left tests one edge at a time. Edges within the
+ * precision of MT2 may go either way, except where MT2 is 0 or its lower
+ * bound exactly.
+ *
+ * If `diagnostics' is not NULL, its count of tests is increased by those made.
+ */
+template <typename T>
+static int
+mt2_count_at_or_below_kinematics(const struct mt2_kinematics<T> *kinematics,
+                                 T ssam, T ssbm, const T *edges, int n_edges,
+                                 struct mt2_diagnostics *diagnostics)
+{
+    ssam = std::fmax(ssam, 0);
+    ssbm = std::fmax(ssbm, 0);
+
+    const auto scale = mt2_scale(kinematics, ssam, ssbm);
+    const auto infinity = std::numeric_limits<T>::infinity();
+    if (mt2_rare(!(scale > 0 && scale < infinity))) {
+        if (!(scale < infinity))
+            return -1;
+        return (int)(std::upper_bound(edges, edges + n_edges, scale) - edges);
+    }
+
+    /* Edges at or below the lower bound are at or below MT2. */
+    const auto lower = std::fmax(kinematics->am + ssam, kinematics->bm + ssbm);
+    int lo = (int)(std::upper_bound(edges, edges + n_edges, lower) - edges);
+    if (lo == n_edges)
+        return lo;
+
+    /* Edges above the upper bound are not. */
+    const auto squeeze = 1 / scale;
+    const auto upper = mt2_upper_bound(kinematics, ssam, ssbm, squeeze) * scale;
+    int hi = (int)(std::upper_bound(edges + lo, edges + n_edges, upper) - edges);
+    if (lo == hi)
+        return lo;
 
-    const struct mt2_trio<T> quadratics[4] = {
-        mt2_det(&a_ellipse),
-        mt2_det(&b_ellipse),
-        mt2_lester(&a_ellipse, &b_ellipse),
-        mt2_lester(&b_ellipse, &a_ellipse),
-    };
+    struct mt2_setup<T> setup;
+    mt2_prepare_masses(kinematics, ssam, ssbm, &setup);
+    while (lo < hi) {
+        const int mid = lo + (hi - lo) / 2;
+        bool error;
+        const auto above = mt2_above_setup(&setup, edges[mid] * squeeze, &error);
+        if (diagnostics)
+            ++diagnostics->tests;
+        if (mt2_rare(error))
+            return -1;
+        if (above)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/*
+ * Find a bracket on asymmetric MT2 with at most `max_tests' disjointness
+ * tests, for kinematics from `mt2_prepare_kinematics'.
+ *
+ * The bracket starts from the cheap bounds of `mt2_above_kinematics', so
+ * costs no tests, and is then bisected until it is as tight as
+ * `mt2_bisect_setup' would make it or the tests run out. MT2 is within
+ * [`*lo', `*hi'], up to the precision of the tests themselves, and both are
+ * MT2 itself if it is 0 or NAN.
+ *
+ * Returns:
+ *     The number of tests made.
+ */
+template <typename T>
+static int
+mt2_bracket_kinematics(const struct mt2_kinematics<T> *kinematics,
+                       T ssam, T ssbm, int max_tests, T *lo, T *hi)
+{
+    ssam = std::fmax(ssam, 0);
+    ssbm = std::fmax(ssbm, 0);
+
+    const auto scale = mt2_scale(kinematics, ssam, ssbm);
+    const auto infinity = std::numeric_limits<T>::infinity();
+    if (mt2_rare(!(scale > 0 && scale < infinity))) {
+        *lo = *hi = scale < infinity ? scale
+                                     : std::numeric_limits<T>::quiet_NaN();
+        return 0;
+    }
+
+    const auto squeeze = 1 / scale;
+    struct mt2_setup<T> setup;
+    mt2_prepare_masses(kinematics, ssam, ssbm, &setup);
+    auto bracket_lo = setup.lo;
+    auto bracket_hi = std::fmax(
+        mt2_upper_bound(kinematics, ssam, ssbm, squeeze), bracket_lo);
+
+    /* Bisect, with the tolerances of `mt2_bisect_setup' at full precision. */
+    const auto epsilon = std::numeric_limits<T>::epsilon();
+    int tests = 0;
+    while (tests < max_tests
+           && bracket_hi > bracket_lo*(1 + 2*epsilon) + 2*epsilon) {
+        const auto m = 0.5f*(bracket_lo + bracket_hi);
+        bool error;
+        const auto disjoint = mt2_disjoint(setup.quadratics, m, &error);
+        ++tests;
+        if (mt2_rare(error))
+            break;
+        if (disjoint)
+            bracket_lo = m;
+        else
+            bracket_hi = m;
+    }
+
+    *lo = bracket_lo * scale;
+    *hi = bracket_hi * scale;
+    return tests;
+}
+
+/*
+ * Return whether MT2 is above `m', for an event prepared by `mt2_prepare' and
+ * in its squeezed units, with a single disjointness test.
+ *
+ * MT2 is at least `lo', where bisection always returns a little above.
+ */
+template <typename T>
+static bool
+mt2_above_setup(const struct mt2_setup<T> *setup, T m, bool *error)
+{
+    if (m <= setup->lo) {
+        *error = false;
+        return true;
+    }
+    return mt2_disjoint(setup->quadratics, m, error);
+}
+
+/*
+ * Return an upper bound on MT2 in units squeezed by `squeeze', for kinematics
+ * from `mt2_prepare_kinematics' and clipped invisible masses.
+ *
+ * MT2 minimizes, over all splits of the missing momentum between the two
+ * invisible particles, the larger transverse mass of the two parents. So any
+ * one split bounds it; we take the best of all to `a', all to `b', and half
+ * to each.
+ */
+template <typename T>
+static T
+mt2_upper_bound(const struct mt2_kinematics<T> *kinematics,
+                T ssam, T ssbm, T squeeze)
+{
+    const auto am = kinematics->am * squeeze;
+    const auto apx = kinematics->apx * squeeze;
+    const auto apy = kinematics->apy * squeeze;
+    const auto bm = kinematics->bm * squeeze;
+    const auto bpx = kinematics->bpx * squeeze;
+    const auto bpy = kinematics->bpy * squeeze;
+    const auto sspx = kinematics->sspx * squeeze;
+    const auto sspy = kinematics->sspy * squeeze;
+    ssam *= squeeze;
+    ssbm *= squeeze;
+
+    const T splits[3] = {1, 0, 0.5f};
+    auto bound2 = std::numeric_limits<T>::infinity();
+    for (int i = 0; i < 3; ++i) {
+        const auto f = splits[i];
+        const auto a2 = mt2_transverse_mass2(
+            am, apx, apy, ssam, f*sspx, f*sspy);
+        const auto b2 = mt2_transverse_mass2(
+            bm, bpx, bpy, ssbm, (1 - f)*sspx, (1 - f)*sspy);
+        const auto split2 = a2 < b2 ? b2 : a2;
+        if (split2 < bound2)
+            bound2 = split2;
+    }
+    return std::sqrt(bound2);
+}
+
+/*
+ * Return the squared transverse mass of a parent which decayed to a visible
+ * particle of mass `m' and momentum (`px', `py'), and an invisible particle
+ * of mass `ssm' and momentum (`sspx', `sspy').
+ */
+template <typename T>
+static T
+mt2_transverse_mass2(T m, T px, T py, T ssm, T sspx, T sspy)
+{
+    const auto e2 = m*m + (px*px + py*py);
+    const auto sse2 = ssm*ssm + (sspx*sspx + sspy*sspy);
+    return (m*m + ssm*ssm) + 2*(std::sqrt(e2*sse2) - (px*sspx + py*sspy));
+}
+
+/*
+ * Return MT2 for an event prepared by `mt2_prepare'.
+ *
+ * The search first expands an upper bound, then bisects to the tolerance
+ * implied by `precision'.
+ *
+ * Optionally, `lo_hint' and `hi_hint' suggest a tighter bracket, in the same
+ * squeezed units as `setup->lo'. Each is ignored unless it is above `lo', and
+ * each is tested before use: a valid `lo_hint' raises the lower bound, and a
+ * valid `hi_hint' replaces the expansion. An invalid `hi_hint' is still a
+ * lower bound, from which we expand by steps which start at its distance
+ * above `lo', and double.
+ *
+ * If `bracket_lo' is not NULL, it is set to the final lower bound, which is
+ * no greater than MT2 (unless the result is NAN).
+ *
+ * If `diagnostics' is not NULL, its status is set, and its counts are
+ * incremented by the work done.
+ */
+template <typename T>
+static T
+mt2_bisect_setup(const struct mt2_setup<T> *setup, T precision,
+                 T lo_hint, T hi_hint, T *bracket_lo,
+                 struct mt2_diagnostics *diagnostics)
+{
+    const auto quadratics = setup->quadratics;
+    const auto scale = setup->scale;
+
+    /* At `lo', the ellipses will be disjoint. */
+    auto lo = setup->lo;
+
+    if (lo_hint > lo) {
+        bool error;
+        const auto disjoint = mt2_disjoint(quadratics, lo_hint, &error);
+        if (diagnostics)
+            ++diagnostics->tests;
+        if (disjoint && !error)
+            lo = lo_hint;
+    }
+
+    auto hi = hi_hint > lo ? hi_hint : lo + 1;
+    auto step = hi_hint > lo ? hi_hint - lo : hi;
 
     /* Expand to find an upper bound. */
     for (;;) {
         bool error;
         const auto disjoint = mt2_disjoint(quadratics, hi, &error);
+        if (diagnostics) {
+            ++diagnostics->expansions;
+            ++diagnostics->tests;
+        }
 
-        if (mt2_rare(error))
+        if (mt2_rare(error)) {
+            if (bracket_lo)
+                *bracket_lo = lo * scale;
+            if (diagnostics)
+                diagnostics->status = mt2_status_no_bracket;
             return std::numeric_limits<T>::quiet_NaN();
-        if (mt2_rare(hi >= std::numeric_limits<T>::max()))
+        }
+        if (mt2_rare(hi >= std::numeric_limits<T>::max())) {
+            if (bracket_lo)
+                *bracket_lo = lo * scale;
+            if (diagnostics)
+                diagnostics->status = mt2_status_unbounded;
             return std::numeric_limits<T>::infinity();
+        }
 
         if (!disjoint)
             break;
 
+        /* Without hints, this doubles `hi'. */
         lo = hi;
-        hi *= 2;
+        hi += step;
+        step *= 2;
     }
 
     /* Set termination tolerances. If precision is NAN, rel_tol is epsilon. */
@@ -193,19 +709,227 @@ mt2_bisect_impl(T am, T apx, T apy,
     for (;;) {
         const auto m = 0.5f*(lo + hi);
 
-        if (mt2_rare(hi <= lo*(1 + 2*rel_tol) + 2*abs_tol))
+        if (mt2_rare(hi <= lo*(1 + 2*rel_tol) + 2*abs_tol)) {
+            if (bracket_lo)
+                *bracket_lo = lo * scale;
+            if (diagnostics)
+                diagnostics->status = mt2_status_ok;
             return m * scale;
+        }
 
         bool error;
         const auto disjoint = mt2_disjoint(quadratics, m, &error);
+        if (diagnostics)
+            ++diagnostics->tests;
 
         if (disjoint)
             lo = m;
         else
             hi = m;
 
-        if (mt2_rare(error))
+        if (mt2_rare(error)) {
+            if (bracket_lo)
+                *bracket_lo = lo * scale;
+            if (diagnostics)
+                diagnostics->status = mt2_status_imprecise;
             return lo * scale;
+        }
+    }
+}
+
+/*
+ * Return MT2 for an event prepared by `mt2_prepare', like `mt2_bisect_setup'
+ * but usually with far fewer disjointness tests.
+ *
+ * As the ellipses come to touch, the discriminant of the cubic in
+ * `mt2_disjoint' passes through zero, almost linearly. Once MT2 is bracketed,
+ * Brent's method (zeroin) interpolates that discriminant to choose each next
+ * test, and bisects whenever interpolation is not making progress. Which side
+ * of MT2 a test lies is still decided by `mt2_disjoint' alone, so the bracket
+ * is as reliable as with bisection.
+ *
+ * MT2 is often exactly `lo', where bisection would creep towards it one step
+ * at a time. So the first test is just above `lo' (or at `lo_hint', if that is
+ * larger); if that is not disjoint, we are done.
+ *
+ * Hints, `bracket_lo' and `diagnostics' are as for `mt2_bisect_setup',
+ * except that a lower hint which turns out to be above MT2 becomes the upper bound.
+ */
+template <typename T>
+static T
+mt2_brent_setup(const struct mt2_setup<T> *setup, T precision,
+                T lo_hint, T hi_hint, T *bracket_lo,
+                struct mt2_diagnostics *diagnostics)
+{
+    const auto quadratics = setup->quadratics;
+    const auto scale = setup->scale;
+
+    /* Set termination tolerances. If precision is NAN, rel_tol is epsilon. */
+    const auto epsilon = std::numeric_limits<T>::epsilon();
+    const auto rel_tol = epsilon < precision ? precision : epsilon;
+    const auto abs_tol = epsilon;
+
+    /*
+     * Discriminants are signed by disjointness: positive below MT2, and
+     * otherwise not. At `lo' itself it is unknown, and often unbounded.
+     */
+    auto lo = setup->lo;
+    auto f_lo = std::numeric_limits<T>::infinity();
+    auto hi = lo;
+    auto f_hi = f_lo;
+    bool bracketed = false;
+
+    {
+        const auto x = lo_hint > lo ? lo_hint : lo*(1 + 2*rel_tol) + 2*abs_tol;
+        bool error;
+        T f;
+        const auto disjoint = mt2_disjoint(quadratics, x, &error, &f);
+        if (diagnostics)
+            ++diagnostics->tests;
+        if (!error && disjoint) {
+            lo = x;
+            f_lo = std::fabs(f);
+        } else if (!error) {
+            hi = x;
+            f_hi = -std::fabs(f);
+            bracketed = true;
+        }
+    }
+
+    if (!bracketed) {
+        hi = hi_hint > lo ? hi_hint : lo + 1;
+        auto step = hi_hint > lo ? hi_hint - lo : hi;
+
+        /* Expand to find an upper bound, as in `mt2_bisect_setup'. */
+        for (;;) {
+            bool error;
+            T f;
+            const auto disjoint = mt2_disjoint(quadratics, hi, &error, &f);
+            if (diagnostics) {
+                ++diagnostics->expansions;
+                ++diagnostics->tests;
+            }
+
+            if (mt2_rare(error)) {
+                if (bracket_lo)
+                    *bracket_lo = lo * scale;
+                if (diagnostics)
+                    diagnostics->status = mt2_status_no_bracket;
+                return std::numeric_limits<T>::quiet_NaN();
+            }
+            if (mt2_rare(hi >= std::numeric_limits<T>::max())) {
+                if (bracket_lo)
+                    *bracket_lo = lo * scale;
+                if (diagnostics)
+                    diagnostics->status = mt2_status_unbounded;
+                return std::numeric_limits<T>::infinity();
+            }
+
+            if (!disjoint) {
+                f_hi = -std::fabs(f);
+                break;
+            }
+
+            lo = hi;
+            f_lo = std::fabs(f);
+            hi += step;
+            step *= 2;
+        }
+    }
+
+    /*
+     * Brent's method: `b' is the best estimate so far, `c' is on the other
+     * side of MT2, and `a' is the previous `b'. Steps `d' which interpolate
+     * are only taken while they shrink faster than bisection would (`e').
+     */
+    auto a = lo;
+    auto f_a = f_lo;
+    auto b = hi;
+    auto f_b = f_hi;
+    auto c = a;
+    auto f_c = f_a;
+    auto d = b - a;
+    auto e = d;
+
+    for (;;) {
+        if ((f_b > 0) == (f_c > 0)) {
+            c = a;
+            f_c = f_a;
+            d = b - a;
+            e = d;
+        }
+        if (std::fabs(f_c) < std::fabs(f_b)) {
+            a = b;
+            b = c;
+            c = a;
+            f_a = f_b;
+            f_b = f_c;
+            f_c = f_a;
+        }
+
+        lo = b < c ? b : c;
+        hi = b < c ? c : b;
+        if (mt2_rare(hi <= lo*(1 + 2*rel_tol) + 2*abs_tol)) {
+            if (bracket_lo)
+                *bracket_lo = lo * scale;
+            if (diagnostics)
+                diagnostics->status = mt2_status_ok;
+            return 0.5f*(lo + hi) * scale;
+        }
+
+        const auto tol = lo*rel_tol + abs_tol;
+        const auto half = 0.5f*(c - b);
+
+        if (std::fabs(e) >= tol && std::fabs(f_a) > std::fabs(f_b)
+                && std::fabs(f_a) < std::numeric_limits<T>::infinity()) {
+            /* Secant if we have only two points, else inverse quadratic. */
+            const auto s = f_b / f_a;
+            auto p = 2*half*s;
+            auto q = 1 - s;
+            if (a != c && f_c != 0) {
+                const auto qa = f_a / f_c;
+                const auto r = f_b / f_c;
+                p = s*(2*half*qa*(qa - r) - (b - a)*(r - 1));
+                q = (qa - 1)*(r - 1)*(s - 1);
+            }
+            if (p > 0)
+                q = -q;
+            else
+                p = -p;
+
+            const auto limit_half = 3*half*q - std::fabs(tol*q);
+            const auto limit_e = std::fabs(e*q);
+            if (2*p < (limit_half < limit_e ? limit_half : limit_e)) {
+                e = d;
+                d = p / q;
+            } else {
+                d = half;
+                e = d;
+            }
+        } else {
+            d = half;
+            e = d;
+        }
+
+        a = b;
+        f_a = f_b;
+        b += std::fabs(d) > tol ? d : (half > 0 ? tol : -tol);
+
+        bool error;
+        T f;
+        const auto disjoint = mt2_disjoint(quadratics, b, &error, &f);
+        if (diagnostics)
+            ++diagnostics->tests;
+        f_b = disjoint ? std::fabs(f) : -std::fabs(f);
+
+        if (mt2_rare(error)) {
+            lo = a < c ? a : c;
+            if (bracket_lo)
+                *bracket_lo = lo * scale;
+            if (diagnostics)
+                diagnostics->status = mt2_status_imprecise;
+            return lo * scale;
+        }
     }
 }
 
@@ -363,10 +1087,15 @@ mt2_lester(const struct mt2_conic<T> *a, const struct mt2_conic<T> *b)
  * Are our ellipses disjoint?
  *
  * Ellipse properties are specified as quadratics in mass `m' squared.
+ *
+ * If `discriminant' is not NULL, it is set to the discriminant of the cubic
+ * whose roots decide the answer; this is positive if the ellipses are
+ * disjoint, and passes through zero as they come to touch.
  */
 template <typename T>
 static bool
-mt2_disjoint(const struct mt2_trio<T> quadratics[4], T m, bool *error)
+mt2_disjoint(const struct mt2_trio<T> quadratics[4], T m, bool *error,
+             T *discriminant)
 {
     auto a_det = mt2_eval_quadratic(quadratics + 0, m*m);
     auto b_det = mt2_eval_quadratic(quadratics + 1, m*m);
@@ -386,6 +1115,11 @@ mt2_disjoint(const struct mt2_trio<T> quadratics[4], T m, bool *error)
 
     *error = a_det == 0;
 
+    if (discriminant) {
+        *discriminant = (
+            a*c*(b*18 - a*a*4) - (c*c*27 + b*b*(b*4 - a*a)));
+    }
+
     /* Using some branching logic to aid early escapes. */
     return (
         (a*a > b*3) &&
@@ -426,3 +1160,5 @@ mt2_swap(T *x, T *y)
 
 /* Clean-up */
 #undef mt2_rare
+
+#endif /* MT2_BISECT_H */
@@ -0,0 +1,714 @@
+/*
+ * Asymmetric MT2 for several events at once, with the Lester-Nachman
+ * bisection algorithm (or its Brent variant) run in lockstep across SIMD
+ * lanes.
+ *
+ * Please cite arxiv.org/abs/1411.4312 and arxiv.org/abs/hep-ph/9906349 .
+ */
+#ifndef MT2_BISECT_LANES_H
+#define MT2_BISECT_LANES_H
+
+/*
+ * Includes
+ *
+ * cstring
+ *     std::memcpy
+ * limits
+ *     std::numeric_limits
+ * mt2_bisect.h
+ *     mt2_setup, mt2_method, mt2_bisect_setup, mt2_brent_setup
+ */
+#include <cstring>
+#include <limits>
+
+#include "mt2_bisect.h"
+
+
+/* Macros */
+/*
+ * GCC and Clang vector extensions let us write lane-wise arithmetic directly.
+ * Without them, events in a group are simply bisected one after another.
+ */
+#if defined(__GNUC__) && !defined(MT2_NO_VECTOR_LANES)
+#define MT2_VECTOR_LANES 1
+#else
+#define MT2_VECTOR_LANES 0
+#endif
+
+/*
+ * Lane functions are forced inline, so that they are compiled for the
+ * instruction set of the function using them; see `main.cpp'.
+ */
+#ifdef __GNUC__
+#define mt2_lanes_inline inline __attribute__((always_inline))
+#else
+#define mt2_lanes_inline inline
+#endif
+
+/* Register width, in bytes, of the instruction set we are compiled for. */
+#if defined(__AVX512F__)
+#define MT2_VECTOR_BYTES 64
+#elif defined(__AVX__)
+#define MT2_VECTOR_BYTES 32
+#else
+#define MT2_VECTOR_BYTES 16
+#endif
+
+
+#if MT2_VECTOR_LANES
+/* Types */
+/* Unsigned integers of the same width as T, for lane masks. */
+template <typename T>
+struct mt2_lane_bits;
+
+template <>
+struct mt2_lane_bits<float> {
+    typedef unsigned int type;
+};
+
+template <>
+struct mt2_lane_bits<double> {
+    typedef unsigned long long type;
+};
+
+/*
+ * N lanes of T, and masks with all bits of a lane either set or clear.
+ *
+ * Lanes may be wider than the baseline ISA's registers, so they are only
+ * passed to functions by pointer or reference; that keeps the calling
+ * convention out of the picture.
+ */
+template <typename T, int N>
+struct mt2_lanes {
+    typedef T real __attribute__((vector_size(N * sizeof(T))));
+    typedef typename mt2_lane_bits<T>::type bits;
+    typedef bits mask __attribute__((vector_size(N * sizeof(T))));
+};
+
+
+/* Template declarations */
+template <typename T, int N, int G, bool Hints>
+static mt2_lanes_inline int mt2_bisect_loop_lanes(
+    const typename mt2_lanes<T, N>::real q[G][12],
+    typename mt2_lanes<T, N>::real lo[G],
+    const typename mt2_lanes<T, N>::real lo_hint[G],
+    const typename mt2_lanes<T, N>::real hi_hint[G],
+    const typename mt2_lanes<T, N>::real rel_tol[G],
+    typename mt2_lanes<T, N>::real result[G]);
+
+template <typename T, int N, int G, bool Hints>
+static mt2_lanes_inline int mt2_brent_loop_lanes(
+    const typename mt2_lanes<T, N>::real q[G][12],
+    typename mt2_lanes<T, N>::real lo[G],
+    const typename mt2_lanes<T, N>::real lo_hint[G],
+    const typename mt2_lanes<T, N>::real hi_hint[G],
+    const typename mt2_lanes<T, N>::real rel_tol[G],
+    typename mt2_lanes<T, N>::real result[G]);
+
+template <typename T, int N>
+static mt2_lanes_inline void mt2_disjoint_lanes(
+    const typename mt2_lanes<T, N>::real q[12],
+    const typename mt2_lanes<T, N>::real &m,
+    typename mt2_lanes<T, N>::mask *disjoint,
+    typename mt2_lanes<T, N>::mask *error,
+    typename mt2_lanes<T, N>::real *discriminant=NULL);
+
+template <typename T, int N>
+static mt2_lanes_inline void mt2_abs_lanes(typename mt2_lanes<T, N>::real *x);
+
+template <typename T, int N>
+static mt2_lanes_inline void mt2_min_lanes(
+    typename mt2_lanes<T, N>::real *x,
+    const typename mt2_lanes<T, N>::real &y);
+
+template <typename T, int N>
+static mt2_lanes_inline void mt2_blend_lanes(
+    typename mt2_lanes<T, N>::real *x,
+    const typename mt2_lanes<T, N>::mask &m,
+    const typename mt2_lanes<T, N>::real &y);
+#endif
+
+
+/* Template definitions */
+/*
+ * Compute MT2 for up to N*G events prepared by `mt2_prepare'.
+ *
+ * This follows the same steps as `mt2_bisect_setup', and gives identical
+ * results, but each step evaluates the disjointness test for all events with
+ * straight-line arithmetic on G vectors of N lanes. Events which have finished
+ * are masked out; they repeat their last evaluation until every lane is done.
+ *
+ * N should match the width of the target's registers: wider vectors are split
+ * by the compiler, often with scalar comparisons. Independent groups (G > 1)
+ * instead give the processor more work to overlap with the long dependency
+ * chain through each step.
+ *
+ * With Method mt2_method_brent, the steps instead follow `mt2_brent_setup'.
+ *
+ * If Hints, `lo_hint' and `hi_hint' are used as for `mt2_bisect_setup'.
+ * Lower hints are tested in one extra step, for each group with any.
+ *
+ * Arguments:
+ *     setups:
+ *         n events, as filled by `mt2_prepare'
+ *     precision:
+ *         n precisions, as for `mt2_bisect_impl'
+ *     n:
+ *         number of events, with 0 < n <= N*G
+ *     out:
+ *         n results
+ *     lo_hint, hi_hint:
+ *         if Hints, n hints each, as for `mt2_bisect_setup'
+ *     bracket_lo:
+ *         NULL, or n final lower bounds, as for `mt2_bisect_setup'
+ *
+ * Returns:
+ *     The number of disjointness tests made, counting every lane of each
+ *     vector test, including those of finished or spare lanes.
+ */
+template <typename T, int N, int G, mt2_method Method, bool Hints>
+static mt2_lanes_inline int
+mt2_bisect_lanes(const struct mt2_setup<T> *setups, const T *precision,
+                 int n, T *out, const T *lo_hint=NULL, const T *hi_hint=NULL,
+                 T *bracket_lo=NULL)
+{
+#if MT2_VECTOR_LANES
+    typedef typename mt2_lanes<T, N>::real real;
+
+    /* Gather into lanes; spare lanes repeat the first event. */
+    T q_gather[G][12][N];
+    T lo_gather[G][N];
+    T lo_hint_gather[G][N];
+    T hi_hint_gather[G][N];
+    T rel_tol_gather[G][N];
+    const auto epsilon = std::numeric_limits<T>::epsilon();
+
+    for (int l = 0; l < N*G; ++l) {
+        const int k = l < n ? l : 0;
+        const int g = l / N;
+        for (int j = 0; j < 4; ++j) {
+            q_gather[g][3*j + 0][l % N] = setups[k].quadratics[j].c0;
+            q_gather[g][3*j + 1][l % N] = setups[k].quadratics[j].c1;
+            q_gather[g][3*j + 2][l % N] = setups[k].quadratics[j].c2;
+        }
+        lo_gather[g][l % N] = setups[k].lo;
+        if (Hints) {
+            lo_hint_gather[g][l % N] = lo_hint[k];
+            hi_hint_gather[g][l % N] = hi_hint[k];
+        }
+        rel_tol_gather[g][l % N] = (
+            epsilon < precision[k] ? precision[k] : epsilon);
+    }
+
+    real q[G][12];
+    real lo[G];
+    real lo_hint_lanes[G];
+    real hi_hint_lanes[G];
+    real rel_tol[G];
+    std::memcpy(q, q_gather, sizeof(q));
+    std::memcpy(lo, lo_gather, sizeof(lo));
+    std::memcpy(rel_tol, rel_tol_gather, sizeof(rel_tol));
+    if (Hints) {
+        std::memcpy(lo_hint_lanes, lo_hint_gather, sizeof(lo_hint_lanes));
+        std::memcpy(hi_hint_lanes, hi_hint_gather, sizeof(hi_hint_lanes));
+    }
+
+    real result[G];
+    int tests;
+    if (Method == mt2_method_brent) {
+        tests = mt2_brent_loop_lanes<T, N, G, Hints>(
+            q, lo, lo_hint_lanes, hi_hint_lanes, rel_tol, result);
+    } else {
+        tests = mt2_bisect_loop_lanes<T, N, G, Hints>(
+            q, lo, lo_hint_lanes, hi_hint_lanes, rel_tol, result);
+    }
+
+    for (int l = 0; l < n; ++l)
+        out[l] = result[l / N][l % N] * setups[l].scale;
+    if (bracket_lo) {
+        for (int l = 0; l < n; ++l)
+            bracket_lo[l] = lo[l / N][l % N] * setups[l].scale;
+    }
+    return N * tests;
+#else
+    struct mt2_diagnostics diagnostics = {mt2_status_ok, 0, 0};
+    for (int l = 0; l < n; ++l) {
+        out[l] = (Method == mt2_method_brent ? mt2_brent_setup<T> : mt2_bisect_setup<T>)(
+            setups + l, precision[l],
+            Hints ? lo_hint[l] : T(0),
+            Hints ? hi_hint[l] : T(0),
+            bracket_lo ? bracket_lo + l : NULL,
+            &diagnostics);
+    }
+    return (int)diagnostics.tests;
+#endif
+}
+
+#if MT2_VECTOR_LANES
+/*
+ * The steps of `mt2_bisect_lanes' after gathering, for the bisection method.
+ *
+ * On return, `lo' holds the final lower bounds. Returns the number of vector
+ * disjointness tests made.
+ */
+template <typename T, int N, int G, bool Hints>
+static mt2_lanes_inline int
+mt2_bisect_loop_lanes(const typename mt2_lanes<T, N>::real q[G][12],
+                      typename mt2_lanes<T, N>::real lo[G],
+                      const typename mt2_lanes<T, N>::real lo_hint[G],
+                      const typename mt2_lanes<T, N>::real hi_hint[G],
+                      const typename mt2_lanes<T, N>::real rel_tol[G],
+                      typename mt2_lanes<T, N>::real result[G])
+{
+    typedef typename mt2_lanes<T, N>::real real;
+    typedef typename mt2_lanes<T, N>::mask mask;
+
+    const real nan = real() + std::numeric_limits<T>::quiet_NaN();
+    const real inf = real() + std::numeric_limits<T>::infinity();
+    const real max = real() + std::numeric_limits<T>::max();
+    const real abs_tol = real() + std::numeric_limits<T>::epsilon();
+
+    real hi[G];
+    real step[G];
+    real x[G];
+    mask live[G];
+    mask expanding[G];
+    int tests = 0;
+
+    for (int g = 0; g < G; ++g) {
+        /* Lanes with a lower hint test it once, and take it if valid; then
+         * lanes with an upper hint above `lo' start expanding from it. */
+        if (Hints) {
+            const real &lo_h = lo_hint[g];
+            const mask check = (mask)(lo_h > lo[g]);
+            typename mt2_lanes<T, N>::bits any_check = 0;
+            for (int l = 0; l < N; ++l)
+                any_check |= check[l];
+            if (any_check) {
+                mask disjoint;
+                mask error;
+                mt2_disjoint_lanes<T, N>(q[g], lo_h, &disjoint, &error);
+                ++tests;
+                mt2_blend_lanes<T, N>(&lo[g], check & disjoint & ~error, lo_h);
+            }
+        }
+
+        hi[g] = lo[g] + T(1);
+        step[g] = hi[g];
+        if (Hints) {
+            const real &hi_h = hi_hint[g];
+            const mask use_hi = (mask)(hi_h > lo[g]);
+            mt2_blend_lanes<T, N>(&hi[g], use_hi, hi_h);
+            mt2_blend_lanes<T, N>(&step[g], use_hi, hi_h - lo[g]);
+        }
+
+        x[g] = hi[g];
+        result[g] = real();
+        live[g] = ~mask();
+        expanding[g] = ~mask();
+    }
+
+    for (;;) {
+        mask any = mask();
+        tests += G;
+
+        for (int g = 0; g < G; ++g) {
+            mask disjoint;
+            mask error;
+            mt2_disjoint_lanes<T, N>(q[g], x[g], &disjoint, &error);
+
+            /* Expanding lanes stop on error or overflow, else double `hi'
+             * until the ellipses intersect; with hints, it is the step from
+             * the upper hint which doubles. */
+            const mask expand = live[g] & expanding[g];
+            const mask fail_nan = expand & error;
+            const mask fail_inf = expand & ~error & (mask)(hi[g] >= max);
+            const mask widen = expand & ~error & ~fail_inf & disjoint;
+            const mask turn = expand & ~error & ~fail_inf & ~disjoint;
+
+            /* Bisecting lanes move a bound to `x', and stop on error. */
+            const mask bisect = live[g] & ~expanding[g];
+            const mask fail_lo = bisect & error;
+
+            mt2_blend_lanes<T, N>(&lo[g], bisect & disjoint, x[g]);
+            mt2_blend_lanes<T, N>(&lo[g], widen, hi[g]);
+            mt2_blend_lanes<T, N>(&hi[g], bisect & ~disjoint, x[g]);
+            if (Hints) {
+                mt2_blend_lanes<T, N>(&hi[g], widen, hi[g] + step[g]);
+                mt2_blend_lanes<T, N>(&step[g], widen, step[g]*T(2));
+            } else {
+                mt2_blend_lanes<T, N>(&hi[g], widen, hi[g]*T(2));
+            }
+
+            /* Lanes due to bisect either converge or test the middle. */
+            const mask next = (bisect & ~error) | turn;
+            const real m = T(0.5f)*(lo[g] + hi[g]);
+            const mask converged = next & (mask)(
+                hi[g] <= lo[g]*(T(1) + T(2)*rel_tol[g]) + T(2)*abs_tol);
+
+            mt2_blend_lanes<T, N>(&result[g], fail_nan, nan);
+            mt2_blend_lanes<T, N>(&result[g], fail_inf, inf);
+            mt2_blend_lanes<T, N>(&result[g], fail_lo, lo[g]);
+            mt2_blend_lanes<T, N>(&result[g], converged, m);
+
+            mt2_blend_lanes<T, N>(&x[g], widen, hi[g]);
+            mt2_blend_lanes<T, N>(&x[g], next & ~converged, m);
+
+            expanding[g] &= ~turn;
+            live[g] &= ~(fail_nan | fail_inf | fail_lo | converged);
+            any |= live[g];
+        }
+
+        typename mt2_lanes<T, N>::bits any_lane = 0;
+        for (int l = 0; l < N; ++l)
+            any_lane |= any[l];
+        if (!any_lane)
+            break;
+    }
+    return tests;
+}
+
+/*
+ * The steps of `mt2_bisect_lanes' after gathering, for Brent's method; see
+ * `mt2_brent_setup', whose variables these follow.
+ *
+ * Every lane first tests its lower hint, or just above `lo', and then
+ * expands. Lanes whose first test was above MT2 "expand" to it again, which
+ * costs nothing in lockstep unless their whole group is done.
+ *
+ * On return, `lo' holds the final lower bounds. Returns the number of vector
+ * disjointness tests made.
+ */
+template <typename T, int N, int G, bool Hints>
+static mt2_lanes_inline int
+mt2_brent_loop_lanes(const typename mt2_lanes<T, N>::real q[G][12],
+                     typename mt2_lanes<T, N>::real lo[G],
+                     const typename mt2_lanes<T, N>::real lo_hint[G],
+                     const typename mt2_lanes<T, N>::real hi_hint[G],
+                     const typename mt2_lanes<T, N>::real rel_tol[G],
+                     typename mt2_lanes<T, N>::real result[G])
+{
+    typedef typename mt2_lanes<T, N>::real real;
+    typedef typename mt2_lanes<T, N>::mask mask;
+
+    const real nan = real() + std::numeric_limits<T>::quiet_NaN();
+    const real inf = real() + std::numeric_limits<T>::infinity();
+    const real max = real() + std::numeric_limits<T>::max();
+    const real abs_tol = real() + std::numeric_limits<T>::epsilon();
+
+    real hi[G];
+    real step[G];
+    real x[G];
+    real f_lo[G];
+    real a[G];
+    real f_a[G];
+    real b[G];
+    real f_b[G];
+    real c[G];
+    real f_c[G];
+    real d[G];
+    real e[G];
+    mask live[G];
+    mask expanding[G];
+    int tests = G;
+
+    for (int g = 0; g < G; ++g) {
+        /* Test the first point; take it as `lo' if disjoint, or else as
+         * the point to expand to. */
+        x[g] = lo[g]*(T(1) + T(2)*rel_tol[g]) + T(2)*abs_tol;
+        if (Hints)
+            mt2_blend_lanes<T, N>(&x[g], (mask)(lo_hint[g] > lo[g]), lo_hint[g]);
+
+        mask disjoint;
+        mask error;
+        real f;
+        mt2_disjoint_lanes<T, N>(q[g], x[g], &disjoint, &error, &f);
+        const mask take = disjoint & ~error;
+        const mask above = ~disjoint & ~error;
+        mt2_abs_lanes<T, N>(&f);
+        f_lo[g] = inf;
+        mt2_blend_lanes<T, N>(&lo[g], take, x[g]);
+        mt2_blend_lanes<T, N>(&f_lo[g], take, f);
+        const real first = x[g];
+
+        hi[g] = lo[g] + T(1);
+        step[g] = hi[g];
+        if (Hints) {
+            const real &hi_h = hi_hint[g];
+            const mask use_hi = (mask)(hi_h > lo[g]);
+            mt2_blend_lanes<T, N>(&hi[g], use_hi, hi_h);
+            mt2_blend_lanes<T, N>(&step[g], use_hi, hi_h - lo[g]);
+        }
+        mt2_blend_lanes<T, N>(&hi[g], above, first);
+
+        x[g] = hi[g];
+        result[g] = real();
+        live[g] = ~mask();
+        expanding[g] = ~mask();
+        a[g] = real();
+        f_a[g] = real();
+        b[g] = real();
+        f_b[g] = real();
+        c[g] = real();
+        f_c[g] = real();
+        d[g] = real();
+        e[g] = real();
+    }
+
+    for (;;) {
+        mask any = mask();
+        tests += G;
+
+        for (int g = 0; g < G; ++g) {
+            mask disjoint;
+            mask error;
+            real f;
+            mt2_disjoint_lanes<T, N>(q[g], x[g], &disjoint, &error, &f);
+            mt2_abs_lanes<T, N>(&f);
+            mt2_blend_lanes<T, N>(&f, ~disjoint, -f);
+
+            /* Expanding lanes are as for bisection, but also keep the
+             * discriminant at `lo'. */
+            const mask expand = live[g] & expanding[g];
+            const mask fail_nan = expand & error;
+            const mask fail_inf = expand & ~error & (mask)(hi[g] >= max);
+            const mask widen = expand & ~error & ~fail_inf & disjoint;
+            const mask turn = expand & ~error & ~fail_inf & ~disjoint;
+
+            mt2_blend_lanes<T, N>(&lo[g], widen, hi[g]);
+            mt2_blend_lanes<T, N>(&f_lo[g], widen, f);
+            mt2_blend_lanes<T, N>(&hi[g], widen, hi[g] + step[g]);
+            mt2_blend_lanes<T, N>(&step[g], widen, step[g]*T(2));
+            mt2_blend_lanes<T, N>(&x[g], widen, hi[g]);
+
+            /* Lanes already interpolating have tested `b', and stop on
+             * error with the lower end of their previous bracket. */
+            const mask brent = live[g] & ~expanding[g];
+            const mask fail_lo = brent & error;
+            real below = a[g];
+            mt2_min_lanes<T, N>(&below, c[g]);
+            mt2_blend_lanes<T, N>(&lo[g], fail_lo, below);
+            mt2_blend_lanes<T, N>(&result[g], fail_lo, below);
+            mt2_blend_lanes<T, N>(&f_b[g], brent, f);
+
+            /* Lanes which have just found an upper bound start Brent's method. */
+            mt2_blend_lanes<T, N>(&a[g], turn, lo[g]);
+            mt2_blend_lanes<T, N>(&f_a[g], turn, f_lo[g]);
+            mt2_blend_lanes<T, N>(&b[g], turn, hi[g]);
+            mt2_blend_lanes<T, N>(&f_b[g], turn, f);
+            mt2_blend_lanes<T, N>(&c[g], turn, lo[g]);
+            mt2_blend_lanes<T, N>(&f_c[g], turn, f_lo[g]);
+            mt2_blend_lanes<T, N>(&d[g], turn, hi[g] - lo[g]);
+            mt2_blend_lanes<T, N>(&e[g], turn, hi[g] - lo[g]);
+
+            const mask run = (brent & ~error) | turn;
+
+            /* Keep `c' on the other side of MT2 from `b'... */
+            const mask same = run & ~((mask)(f_b[g] > T(0)) ^ (mask)(f_c[g] > T(0)));
+            mt2_blend_lanes<T, N>(&c[g], same, a[g]);
+            mt2_blend_lanes<T, N>(&f_c[g], same, f_a[g]);
+            mt2_blend_lanes<T, N>(&d[g], same, b[g] - a[g]);
+            mt2_blend_lanes<T, N>(&e[g], same, b[g] - a[g]);
+
+            /* ... and `b' the closer to zero. */
+            real abs_f_b = f_b[g];
+            real abs_f_c = f_c[g];
+            mt2_abs_lanes<T, N>(&abs_f_b);
+            mt2_abs_lanes<T, N>(&abs_f_c);
+            const mask swap = run & (mask)(abs_f_c < abs_f_b);
+            const real b_old = b[g];
+            const real f_b_old = f_b[g];
+            mt2_blend_lanes<T, N>(&b[g], swap, c[g]);
+            mt2_blend_lanes<T, N>(&f_b[g], swap, f_c[g]);
+            mt2_blend_lanes<T, N>(&c[g], swap, b_old);
+            mt2_blend_lanes<T, N>(&f_c[g], swap, f_b_old);
+            mt2_blend_lanes<T, N>(&a[g], swap, b_old);
+            mt2_blend_lanes<T, N>(&f_a[g], swap, f_b_old);
+
+            real l = b[g];
+            mt2_min_lanes<T, N>(&l, c[g]);
+            real h = b[g];
+            mt2_blend_lanes<T, N>(&h, (mask)(b[g] < c[g]), c[g]);
+            const mask converged = run & (mask)(
+                h <= l*(T(1) + T(2)*rel_tol[g]) + T(2)*abs_tol);
+            mt2_blend_lanes<T, N>(&lo[g], converged, l);
+            mt2_blend_lanes<T, N>(&result[g], converged, T(0.5f)*(l + h));
+
+            /* Interpolate if that is making progress, else bisect. */
+            const real tol = l*rel_tol[g] + abs_tol;
+            const real half = T(0.5f)*(c[g] - b[g]);
+            real abs_f_a = f_a[g];
+            real abs_e = e[g];
+            mt2_abs_lanes<T, N>(&abs_f_a);
+            mt2_abs_lanes<T, N>(&abs_e);
+            abs_f_b = f_b[g];
+            mt2_abs_lanes<T, N>(&abs_f_b);
+            const mask interpolate = (
+                (mask)(abs_e >= tol)
+                & (mask)(abs_f_a > abs_f_b)
+                & (mask)(abs_f_a < inf));
+
+            /* Divide only by values which are safe in every lane, so as not
+             * to raise floating-point exceptions. */
+            const real one = real() + T(1);
+            const mask quadratic = (
+                interpolate & (mask)(a[g] != c[g]) & (mask)(f_c[g] != T(0)));
+            real f_a_safe = one;
+            real f_c_safe = one;
+            mt2_blend_lanes<T, N>(&f_a_safe, interpolate, f_a[g]);
+            mt2_blend_lanes<T, N>(&f_c_safe, quadratic, f_c[g]);
+
+            const real s = f_b[g] / f_a_safe;
+            real p = T(2)*half*s;
+            real pq = T(1) - s;
+            {
+                const real qa = f_a[g] / f_c_safe;
+                const real r = f_b[g] / f_c_safe;
+                mt2_blend_lanes<T, N>(
+                    &p, quadratic, s*(T(2)*half*qa*(qa - r) - (b[g] - a[g])*(r - T(1))));
+                mt2_blend_lanes<T, N>(
+                    &pq, quadratic, (qa - T(1))*(r - T(1))*(s - T(1)));
+            }
+            const mask positive = (mask)(p > T(0));
+            mt2_blend_lanes<T, N>(&pq, positive, -pq);
+            mt2_blend_lanes<T, N>(&p, ~positive, -p);
+
+            real limit_half = tol*pq;
+            real limit_e = e[g]*pq;
+            mt2_abs_lanes<T, N>(&limit_half);
+            mt2_abs_lanes<T, N>(&limit_e);
+            limit_half = T(3)*half*pq - limit_half;
+            mt2_min_lanes<T, N>(&limit_half, limit_e);
+            const mask accept = interpolate & (mask)(T(2)*p < limit_half);
+            real e_next = half;
+            real d_next = half;
+            mt2_blend_lanes<T, N>(&e_next, accept, d[g]);
+            real pq_safe = one;
+            mt2_blend_lanes<T, N>(&pq_safe, accept, pq);
+            mt2_blend_lanes<T, N>(&d_next, accept, p / pq_safe);
+
+            const mask next = run & ~converged;
+            mt2_blend_lanes<T, N>(&e[g], next, e_next);
+            mt2_blend_lanes<T, N>(&d[g], next, d_next);
+            mt2_blend_lanes<T, N>(&a[g], next, b[g]);
+            mt2_blend_lanes<T, N>(&f_a[g], next, f_b[g]);
+
+            /* Step by at least `tol', towards `c'. */
+            real move = -tol;
+            mt2_blend_lanes<T, N>(&move, (mask)(half > T(0)), tol);
+            real abs_d = d_next;
+            mt2_abs_lanes<T, N>(&abs_d);
+            mt2_blend_lanes<T, N>(&move, (mask)(abs_d > tol), d_next);
+            mt2_blend_lanes<T, N>(&b[g], next, b[g] + move);
+            mt2_blend_lanes<T, N>(&x[g], next, b[g]);
+
+            mt2_blend_lanes<T, N>(&result[g], fail_nan, nan);
+            mt2_blend_lanes<T, N>(&result[g], fail_inf, inf);
+
+            expanding[g] &= ~turn;
+            live[g] &= ~(fail_nan | fail_inf | fail_lo | converged);
+            any |= live[g];
+        }
+
+        typename mt2_lanes<T, N>::bits any_lane = 0;
+        for (int l = 0; l < N; ++l)
+            any_lane |= any[l];
+        if (!any_lane)
+            break;
+    }
+    return tests;
+}
+
+/*
+ * Lane-wise `mt2_disjoint'.
+ *
+ * Quadratic coefficient k of quadratic j is in q[3*j + k]. Branches become
+ * selects and the early escapes bitwise logic, with the same results.
+ */
+template <typename T, int N>
+static mt2_lanes_inline void
+mt2_disjoint_lanes(const typename mt2_lanes<T, N>::real q[12],
+                   const typename mt2_lanes<T, N>::real &m,
+                   typename mt2_lanes<T, N>::mask *disjoint,
+                   typename mt2_lanes<T, N>::mask *error,
+                   typename mt2_lanes<T, N>::real *discriminant)
+{
+    typedef typename mt2_lanes<T, N>::real real;
+    typedef typename mt2_lanes<T, N>::mask mask;
+    typedef typename mt2_lanes<T, N>::bits bits;
+
+    const real x = m*m;
+    const real a_det0 = q[0] + x*(q[1] + x*q[2]);
+    const real b_det0 = q[3] + x*(q[4] + x*q[5]);
+    const real a_lester0 = q[6] + x*(q[7] + x*q[8]);
+    const real b_lester0 = q[9] + x*(q[10] + x*q[11]);
+
+    /* Sort sides, comparing magnitudes with the sign bits cleared. */
+    const mask sign = mask() + ((bits)1 << (8*sizeof(T) - 1));
+    const mask swap = (mask)(
+        (real)((mask)a_det0 & ~sign) < (real)((mask)b_det0 & ~sign));
+    auto a_det = a_det0;
+    auto b_det = b_det0;
+    auto a_lester = a_lester0;
+    auto b_lester = b_lester0;
+    mt2_blend_lanes<T, N>(&a_det, swap, b_det0);
+    mt2_blend_lanes<T, N>(&b_det, swap, a_det0);
+    mt2_blend_lanes<T, N>(&a_lester, swap, b_lester0);
+    mt2_blend_lanes<T, N>(&b_lester, swap, a_lester0);
+
+    /* Scale to 'monomial form'. */
+    const real a = a_lester / a_det;
+    const real b = b_lester / a_det;
+    const real c = b_det / a_det;
+
+    *error = (mask)(a_det == T(0));
+    if (discriminant) {
+        *discriminant = (
+            a*c*(b*T(18) - a*a*T(4)) - (c*c*T(27) + b*b*(b*T(4) - a*a)));
+    }
+    *disjoint = (
+        (mask)(a*a > b*T(3)) &
+        ((mask)(a < T(0)) | (mask)(b*b*T(4) > a*a*b + a*c*T(3))) &
+        (mask)(a*c*(b*T(18) - a*a*T(4)) > c*c*T(27) + b*b*(b*T(4) - a*a))
+    );
+}
+
+/* Lane-wise `x = std::fabs(x)'. */
+template <typename T, int N>
+static mt2_lanes_inline void
+mt2_abs_lanes(typename mt2_lanes<T, N>::real *x)
+{
+    typedef typename mt2_lanes<T, N>::real real;
+    typedef typename mt2_lanes<T, N>::mask mask;
+    typedef typename mt2_lanes<T, N>::bits bits;
+    const mask sign = mask() + ((bits)1 << (8*sizeof(T) - 1));
+    *x = (real)((mask)*x & ~sign);
+}
+
+/* Lane-wise `x = y < x ? y : x'. */
+template <typename T, int N>
+static mt2_lanes_inline void
+mt2_min_lanes(typename mt2_lanes<T, N>::real *x,
+              const typename mt2_lanes<T, N>::real &y)
+{
+    typedef typename mt2_lanes<T, N>::mask mask;
+    mt2_blend_lanes<T, N>(x, (mask)(y < *x), y);
+}
+
+/* Lane-wise `x = m ? y : x'. */
+template <typename T, int N>
+static mt2_lanes_inline void
+mt2_blend_lanes(typename mt2_lanes<T, N>::real *x,
+                const typename mt2_lanes<T, N>::mask &m,
+                const typename mt2_lanes<T, N>::real &y)
+{
+    typedef typename mt2_lanes<T, N>::real real;
+    typedef typename mt2_lanes<T, N>::mask mask;
+    *x = (real)((m & (mask)y) | (~m & (mask)*x));
+}
+#endif
+
+/* Clean-up */
+#undef mt2_lanes_inline
+
+#endif /* MT2_BISECT_LANES_H */
@@ -0,0 +1,213 @@
+/*
+ * libmt2, the C interface described in mt2_c.h.
+ *
+ * Batches run the kernel of mt2_kernel.h, as mt2_tombs_ufunc does, with each
+ * argument a contiguous array.
+ */
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#define MT2_C_BUILDING 1
+#include "mt2_c.h"
+
+#include "mt2_bisect.h"
+#include "mt2_kernel.h"
+#include "mt2_pool.h"
+
+/* Number of events each thread claims at a time; see main.cpp. */
+#define MT2_C_CHUNK 1024
+
+
+/*
+ * Kernels
+ *
+ * Each variant is a mt2_pool_task over the events of a mt2_c_batch, so that
+ * it can be run directly, or split across the pool.
+ */
+template <typename T>
+struct mt2_c_batch
+{
+    const T *in[10];
+    T *out;
+    T precision;
+};
+
+/* Compute events [begin, end) of `batch', bisecting in vectors of N events. */
+template <typename T, int N, mt2_method Method>
+static MT2_ALWAYS_INLINE void mt2_c_kernel(
+    const struct mt2_c_batch<T> *batch,
+    std::ptrdiff_t begin,
+    std::ptrdiff_t end)
+{
+    /* The arguments of mt2_tombs_ufunc, with the precision broadcast. */
+    char *args[12];
+    std::ptrdiff_t steps[12];
+    for (int k = 0; k < 10; ++k)
+    {
+        args[k] = (char *)(batch->in[k] + begin);
+        steps[k] = sizeof(T);
+    }
+    args[10] = (char *)&batch->precision;
+    steps[10] = 0;
+    args[11] = (char *)(batch->out + begin);
+    steps[11] = sizeof(T);
+
+    mt2_kernel<T, T, N, 2, Method, false, false>(args, steps, end - begin, mt2_lane_ignore());
+}
+
+MT2_ISA_VARIANTS(mt2_c_task, (void *context, std::ptrdiff_t begin, std::ptrdiff_t end),
+                 mt2_c_kernel<T, lanes, Method>((const struct mt2_c_batch<T> *)context, begin, end))
+
+
+/*
+ * Instruction set variants
+ *
+ * As for the Python module, the best variant supported by the CPU is chosen on
+ * first use, unless the MT2_ISA environment variable names another supported
+ * one. Unlike the module, which fails to import, an unknown or unsupported
+ * MT2_ISA is ignored, since there is nowhere to report it.
+ */
+struct mt2_c_isa
+{
+    mt2_pool_task f64[mt2_n_methods];
+    mt2_pool_task f32[mt2_n_methods];
+};
+
+#define MT2_C_ISA(isa) {MT2_METHODS(mt2_c_task##isa, double), MT2_METHODS(mt2_c_task##isa, float)}
+
+/* For each of mt2_isas. */
+static const struct mt2_c_isa mt2_c_isas[] = {MT2_FOR_EACH_ISA(MT2_C_ISA)};
+
+/* The index in mt2_isas of the chosen variant; initialised once, safely from any thread. */
+static int mt2_c_chosen_isa(void)
+{
+    static const int chosen = []() {
+        const int isa = mt2_select_isa(std::getenv("MT2_ISA"));
+        return isa >= 0 ? isa : mt2_select_isa(NULL);
+    }();
+    return chosen;
+}
+
+
+/*
+ * Batches
+ *
+ * Options are read only as far as the caller's `size' says they extend, with
+ * defaults for the rest, so that callers compiled against an older mt2_c.h
+ * keep working as members are added.
+ */
+#define MT2_C_HAS(options, member) \
+    ((options)->size >= offsetof(mt2_options, member) + sizeof((options)->member))
+
+template <typename T>
+static int mt2_c_run(const T *const in[10], size_t n, T *out, const mt2_options *given)
+{
+    mt2_options options;
+    mt2_options_init(&options);
+    if (given != NULL)
+    {
+        if (given->size < offsetof(mt2_options, precision))
+            return MT2_ERROR_OPTIONS;
+        if (MT2_C_HAS(given, precision))
+            options.precision = given->precision;
+        if (MT2_C_HAS(given, method))
+            options.method = given->method;
+        if (MT2_C_HAS(given, threads))
+            options.threads = given->threads;
+    }
+    if (!(options.precision >= 0) || options.method < 0 || options.method >= mt2_n_methods || options.threads < 0)
+        return MT2_ERROR_OPTIONS;
+
+    if (n == 0)
+        return MT2_OK;
+    if (out == NULL)
+        return MT2_ERROR_NULL;
+    for (int k = 0; k < 10; ++k)
+    {
+        if (in[k] == NULL)
+            return MT2_ERROR_NULL;
+    }
+
+    int n_threads = options.threads;
+    if (n_threads == 0)
+    {
+        const unsigned int n_cpus = std::thread::hardware_concurrency();
+        n_threads = n_cpus > 0 ? (int)n_cpus : 1;
+    }
+
+    struct mt2_c_batch<T> batch;
+    std::memcpy(batch.in, in, sizeof(batch.in));
+    batch.out = out;
+    batch.precision = (T)options.precision;
+
+    const struct mt2_c_isa *isa = &mt2_c_isas[mt2_c_chosen_isa()];
+    const mt2_pool_task task = (sizeof(T) == sizeof(double) ? isa->f64 : isa->f32)[options.method];
+    if (n_threads <= 1 || n <= MT2_C_CHUNK)
+        task(&batch, 0, (std::ptrdiff_t)n);
+    else
+        mt2_process_pool()->run(n_threads, (std::ptrdiff_t)n, MT2_C_CHUNK, task, &batch);
+    return MT2_OK;
+}
+
+
+/* The interface */
+extern "C" {
+
+int mt2_abi_version(void)
+{
+    return MT2_ABI_VERSION;
+}
+
+const char *mt2_isa(void)
+{
+    return mt2_isas[mt2_c_chosen_isa()].name;
+}
+
+void mt2_options_init(mt2_options *options)
+{
+    std::memset(options, 0, sizeof(*options));
+    options->size = sizeof(*options);
+    options->precision = 0;
+    options->method = MT2_METHOD_BISECT;
+    options->threads = 1;
+}
+
+double mt2_f64(double m_vis_1, double px_vis_1, double py_vis_1,
+               double m_vis_2, double px_vis_2, double py_vis_2,
+               double px_miss, double py_miss,
+               double m_invis_1, double m_invis_2,
+               double precision)
+{
+    return mt2_bisect_impl(m_vis_1, px_vis_1, py_vis_1, m_vis_2, px_vis_2, py_vis_2,
+                           px_miss, py_miss, m_invis_1, m_invis_2, precision);
+}
+
+int mt2_batch_f64(const double *m_vis_1, const double *px_vis_1,
+                  const double *py_vis_1, const double *m_vis_2,
+                  const double *px_vis_2, const double *py_vis_2,
+                  const double *px_miss, const double *py_miss,
+                  const double *m_invis_1, const double *m_invis_2,
+                  size_t n, double *out,
+                  const mt2_options *options)
+{
+    const double *const in[10] = {m_vis_1, px_vis_1, py_vis_1, m_vis_2, px_vis_2,
+                                  py_vis_2, px_miss, py_miss, m_invis_1, m_invis_2};
+    return mt2_c_run(in, n, out, options);
+}
+
+int mt2_batch_f32(const float *m_vis_1, const float *px_vis_1,
+                  const float *py_vis_1, const float *m_vis_2,
+                  const float *px_vis_2, const float *py_vis_2,
+                  const float *px_miss, const float *py_miss,
+                  const float *m_invis_1, const float *m_invis_2,
+                  size_t n, float *out,
+                  const mt2_options *options)
+{
+    const float *const in[10] = {m_vis_1, px_vis_1, py_vis_1, m_vis_2, px_vis_2,
+                                 py_vis_2, px_miss, py_miss, m_invis_1, m_invis_2};
+    return mt2_c_run(in, n, out, options);
+}
+
+}  /* extern "C" */
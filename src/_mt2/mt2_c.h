@@ -0,0 +1,128 @@
+/*
+ * The C interface of libmt2, for C, Fortran, Julia and other languages that
+ * can call C functions.
+ *
+ * Events are given as contiguous structure-of-arrays: one array per argument
+ * of MT2, each of `n' elements. For example,
+ *
+ *     #include <mt2/mt2_c.h>
+ *
+ *     mt2_options options;
+ *     mt2_options_init(&options);
+ *     options.threads = 0;
+ *     if (mt2_batch_f64(m_vis_1, px_vis_1, py_vis_1,
+ *                       m_vis_2, px_vis_2, py_vis_2,
+ *                       px_miss, py_miss, m_invis_1, m_invis_2,
+ *                       n, out, &options) != MT2_OK)
+ *         ...
+ *
+ * The functions are those of the Python `mt2', including its SIMD and
+ * instruction set variants (chosen once, and overridable with the MT2_ISA
+ * environment variable as for Python) and its pool of threads, which is
+ * separate from that of the Python module. Results are the same whatever the
+ * number of threads, and the same as from Python for the same variant.
+ *
+ * The ABI is stable within a major version, MT2_ABI_VERSION: functions are
+ * only added, and `mt2_options' only grows at its end, as its `size' member
+ * tells the library which members the caller knows about.
+ *
+ * Please cite arxiv.org/abs/1411.4312 and arxiv.org/abs/hep-ph/9906349 .
+ */
+#ifndef MT2_C_H
+#define MT2_C_H
+
+#include <stddef.h>
+
+#if defined(_WIN32)
+#ifdef MT2_C_BUILDING
+#define MT2_C_API __declspec(dllexport)
+#else
+#define MT2_C_API __declspec(dllimport)
+#endif
+#elif defined(__GNUC__)
+#define MT2_C_API __attribute__((visibility("default")))
+#else
+#define MT2_C_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Constants */
+#define MT2_ABI_VERSION 1
+
+/* Return codes. */
+#define MT2_OK 0
+#define MT2_ERROR_NULL (-1)     /* An array is NULL, and `n' is not 0. */
+#define MT2_ERROR_OPTIONS (-2)  /* An option, or `size', is invalid. */
+
+/* Values of `mt2_options.method'. */
+#define MT2_METHOD_BISECT 0
+#define MT2_METHOD_BRENT 1
+
+
+/* Types */
+typedef struct mt2_options {
+    /* sizeof(mt2_options) as compiled by the caller; set by mt2_options_init. */
+    size_t size;
+    /* Relative precision of each result, or 0, the default, for the best. */
+    double precision;
+    /* MT2_METHOD_BISECT, the default, or MT2_METHOD_BRENT. */
+    int method;
+    /* Threads to use, including the caller's; 1 by default, 0 for one per
+     * CPU. Small batches are not split. */
+    int threads;
+} mt2_options;
+
+
+/* Functions */
+/* Return MT2_ABI_VERSION of the library, which may differ from the header. */
+MT2_C_API int mt2_abi_version(void);
+
+/* Return the name of the instruction set variant in use, e.g. "avx2". */
+MT2_C_API const char *mt2_isa(void);
+
+/* Set `*options' to the defaults. */
+MT2_C_API void mt2_options_init(mt2_options *options);
+
+/*
+ * Return MT2 of one event, to relative `precision' (0 for the best), found by
+ * bisection without SIMD lanes; the result may differ from that of
+ * mt2_batch_f64 by rounding.
+ */
+MT2_C_API double mt2_f64(double m_vis_1, double px_vis_1, double py_vis_1,
+                         double m_vis_2, double px_vis_2, double py_vis_2,
+                         double px_miss, double py_miss,
+                         double m_invis_1, double m_invis_2,
+                         double precision);
+
+/*
+ * Store MT2 of `n' events in `out', which may not overlap the inputs.
+ * `options' may be NULL for the defaults.
+ *
+ * Returns:
+ *     MT2_OK, or a negative MT2_ERROR_ code, in which case `out' is untouched.
+ */
+MT2_C_API int mt2_batch_f64(const double *m_vis_1, const double *px_vis_1,
+                            const double *py_vis_1, const double *m_vis_2,
+                            const double *px_vis_2, const double *py_vis_2,
+                            const double *px_miss, const double *py_miss,
+                            const double *m_invis_1, const double *m_invis_2,
+                            size_t n, double *out,
+                            const mt2_options *options);
+
+/* As mt2_batch_f64, computing in double but reading and writing float. */
+MT2_C_API int mt2_batch_f32(const float *m_vis_1, const float *px_vis_1,
+                            const float *py_vis_1, const float *m_vis_2,
+                            const float *px_vis_2, const float *py_vis_2,
+                            const float *px_miss, const float *py_miss,
+                            const float *m_invis_1, const float *m_invis_2,
+                            size_t n, float *out,
+                            const mt2_options *options);
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+
+#endif  /* MT2_C_H */
@@ -0,0 +1,388 @@
+/*
+ * The kernel shared by the Python module (main.cpp) and libmt2 (mt2_c.cpp).
+ *
+ * Events are prepared one at a time, queued, and bisected in lockstep groups
+ * across SIMD lanes, by a variant of each loop compiled for each instruction
+ * set. The best variant for the CPU is chosen at run time.
+ */
+#ifndef MT2_KERNEL_H
+#define MT2_KERNEL_H
+
+/*
+ * Includes
+ *
+ * cmath
+ *     std::fmax, std::isfinite
+ * cstddef
+ *     std::ptrdiff_t
+ * cstring
+ *     std::strcmp
+ * limits
+ *     std::numeric_limits
+ * mt2_bisect.h
+ *     mt2_kinematics, mt2_setup, mt2_method, mt2_prepare_kinematics,
+ *     mt2_prepare_masses
+ * mt2_bisect_lanes.h
+ *     mt2_bisect_lanes, MT2_VECTOR_BYTES
+ */
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+
+#include "mt2_bisect.h"
+#include "mt2_bisect_lanes.h"
+
+
+/* Macros */
+/*
+ * Loops are forced inline, so that each instruction set variant compiles
+ * them, and the lane kernels, for its own target. Lambdas take the attribute
+ * after their parameters.
+ */
+#ifdef __GNUC__
+#define MT2_ALWAYS_INLINE inline __attribute__((always_inline))
+#define MT2_LAMBDA_INLINE __attribute__((always_inline))
+#else
+#define MT2_ALWAYS_INLINE inline
+#define MT2_LAMBDA_INLINE
+#endif
+
+/*
+ * On x86 with GCC or Clang, loops are also compiled for AVX2 and AVX-512, and
+ * the best variant for the CPU is chosen at run time.
+ */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MT2_X86_DISPATCH 1
+#endif
+
+
+/* Queues */
+/* A mt2_lane_queue result callback which ignores the results. */
+struct mt2_lane_ignore
+{
+    MT2_ALWAYS_INLINE void operator()(double) const
+    {
+    }
+};
+
+/*
+ * Events waiting to be bisected G vectors of N at a time with Method, whose
+ * results are written as Out, and also passed to a Result callback.
+ *
+ * If Hints, each event has a lower and upper hint on its result. Those which
+ * are not finite are ignored, and the rest are tested as in mt2_bisect_setup.
+ */
+template <typename Out, int N, int G, mt2_method Method, bool Hints = false, typename Result = mt2_lane_ignore>
+class mt2_lane_queue
+{
+public:
+    explicit mt2_lane_queue(Result result_ = Result())
+        : tests(0), result(result_), n_queued(0)
+    {
+    }
+
+    /*
+     * Add the event with `kinematics' and invisible masses mInvis1 and
+     * mInvis2, bisected to `precision', whose result goes to `out'. Events
+     * which need no bisection have their result written at once; the queue
+     * is bisected whenever it fills.
+     */
+    MT2_ALWAYS_INLINE void add(
+        const struct mt2_kinematics<double> *kinematics,
+        double mInvis1,
+        double mInvis2,
+        double precision,
+        Out *out,
+        double lo_hint = 0,
+        double hi_hint = 0)
+    {
+        struct mt2_setup<double> *setup = &setups[n_queued];
+        if (!mt2_prepare_masses(kinematics, mInvis1, mInvis2, setup))
+        {
+            *out = (Out)setup->scale;
+            result(setup->scale);
+            return;
+        }
+
+        if (Hints)
+        {
+            /* Hints are in the units of MT2; the bisection works in units of
+             * the setup's scale. */
+            const double squeeze = 1 / setup->scale;
+            lo_hint *= squeeze;
+            hi_hint *= squeeze;
+            lo_hints[n_queued] = std::isfinite(lo_hint) ? lo_hint : 0;
+            hi_hints[n_queued] = std::isfinite(hi_hint) ? hi_hint : 0;
+        }
+        precisions[n_queued] = precision;
+        outs[n_queued] = out;
+        if (++n_queued == N * G)
+            flush();
+    }
+
+    /* Bisect the events queued so far, and write their results. */
+    MT2_ALWAYS_INLINE void flush()
+    {
+        if (n_queued == 0)
+            return;
+
+        tests += mt2_bisect_lanes<double, N, G, Method, Hints>(
+            setups, precisions, n_queued, results, lo_hints, hi_hints);
+        for (int k = 0; k < n_queued; ++k)
+        {
+            *outs[k] = (Out)results[k];
+            result(results[k]);
+        }
+        n_queued = 0;
+    }
+
+    /* Disjointness tests made so far, counting every lane of each test. */
+    unsigned long long tests;
+
+private:
+    Result result;
+    struct mt2_setup<double> setups[N * G];
+    double precisions[N * G];
+    double lo_hints[N * G];
+    double hi_hints[N * G];
+    double results[N * G];
+    Out *outs[N * G];
+    int n_queued;
+};
+
+/*
+ * Call `prepare(i)' for each element i in [begin, end), which adds any number
+ * of events to `queue', then bisect what remains queued. Returns the tests
+ * made, as mt2_lane_queue::tests.
+ */
+template <typename Queue, typename Prepare>
+static MT2_ALWAYS_INLINE unsigned long long mt2_lanes_loop(
+    std::ptrdiff_t begin,
+    std::ptrdiff_t end,
+    Queue *queue,
+    Prepare prepare)
+{
+    for (std::ptrdiff_t i = begin; i < end; ++i)
+    {
+        prepare(i);
+    }
+    queue->flush();
+    return queue->tests;
+}
+
+
+/* Kernels */
+/* Argument k of element i of strided `args', as a double. */
+template <typename In, typename Step>
+static MT2_ALWAYS_INLINE double mt2_strided_arg(char *const *args, const Step *steps, int k, std::ptrdiff_t i)
+{
+    return (double)*(const In *)(args[k] + i * steps[k]);
+}
+
+/*
+ * Compute n events with the arguments of mt2_tombs_ufunc, bisecting G vectors
+ * of N events at a time with Method, and return the tests made. Each argument
+ * k starts at args[k] and is steps[k] bytes from one event to the next. With
+ * Method mt2_method_brent, Brent's method is used instead of bisection.
+ *
+ * Arguments have type In, and results type Out; we always compute in double.
+ * When Out is less precise, bisection stops once the remaining interval is
+ * far below the resolution of the output.
+ *
+ * If Broadcast, the visible and missing momenta are the same for every event
+ * (they have stride 0, as when scanning over invisible masses), so their part
+ * of the preparation is done once.
+ *
+ * If Hints, as for mt2_tombs_hint_ufunc, two more arguments before the output
+ * give a lower and upper hint on each result, as for mt2_lane_queue.
+ *
+ * If Valid, as for mt2_tombs_valid_ufunc, a byte argument before the output
+ * says whether each event is valid. Invalid events, such as those with nulls
+ * in an Arrow column, are not queued, so that valid events still fill the
+ * lanes, and their results are NaN.
+ *
+ * The result of every valid event is also passed to `result'.
+ */
+template <typename In, typename Out, int N, int G, mt2_method Method, bool Broadcast, bool Hints, bool Valid, typename Step, typename Result>
+static MT2_ALWAYS_INLINE unsigned long long mt2_kernel_impl(
+    char *const *args,
+    const Step *steps,
+    std::ptrdiff_t n,
+    Result result)
+{
+    const int valid_arg = Hints ? 13 : 11;
+    const int out_arg = 11 + (Hints ? 2 : 0) + (Valid ? 1 : 0);
+
+    /* Tolerances below double epsilon are no-ops, so this only bites when
+     * Out is float. */
+    const double min_precision = std::numeric_limits<Out>::epsilon() / 8;
+    double precision = 0;
+
+    struct mt2_kinematics<double> kinematics;
+    mt2_lane_queue<Out, N, G, Method, Hints, Result> queue(result);
+
+    return mt2_lanes_loop(0, n, &queue, [&](std::ptrdiff_t i) MT2_LAMBDA_INLINE {
+        if (!Broadcast || i == 0)
+        {
+            mt2_prepare_kinematics(
+                mt2_strided_arg<In>(args, steps, 0, i),
+                mt2_strided_arg<In>(args, steps, 1, i),
+                mt2_strided_arg<In>(args, steps, 2, i),
+                mt2_strided_arg<In>(args, steps, 3, i),
+                mt2_strided_arg<In>(args, steps, 4, i),
+                mt2_strided_arg<In>(args, steps, 5, i),
+                mt2_strided_arg<In>(args, steps, 6, i),
+                mt2_strided_arg<In>(args, steps, 7, i),
+                &kinematics);
+        }
+
+        /* The precision is almost always a scalar, too. */
+        if (steps[10] != 0 || i == 0)
+        {
+            precision = std::fmax(mt2_strided_arg<In>(args, steps, 10, i), min_precision);
+        }
+
+        Out *out = (Out *)(args[out_arg] + i * steps[out_arg]);
+        if (Valid && !*(const unsigned char *)(args[valid_arg] + i * steps[valid_arg]))
+        {
+            *out = std::numeric_limits<Out>::quiet_NaN();
+            return;
+        }
+
+        queue.add(
+            &kinematics,
+            mt2_strided_arg<In>(args, steps, 8, i),
+            mt2_strided_arg<In>(args, steps, 9, i),
+            precision,
+            out,
+            Hints ? mt2_strided_arg<In>(args, steps, 11, i) : 0,
+            Hints ? mt2_strided_arg<In>(args, steps, 12, i) : 0);
+    });
+}
+
+/* Choose the variant of mt2_kernel_impl for the arguments' strides. */
+template <typename In, typename Out, int N, int G, mt2_method Method, bool Hints, bool Valid, typename Step, typename Result>
+static MT2_ALWAYS_INLINE unsigned long long mt2_kernel(
+    char *const *args,
+    const Step *steps,
+    std::ptrdiff_t n,
+    Result result)
+{
+    bool broadcast = true;
+    for (int k = 0; k < 8; ++k)
+    {
+        broadcast = broadcast && steps[k] == 0;
+    }
+
+    if (broadcast)
+        return mt2_kernel_impl<In, Out, N, G, Method, true, Hints, Valid>(args, steps, n, result);
+    else
+        return mt2_kernel_impl<In, Out, N, G, Method, false, Hints, Valid>(args, steps, n, result);
+}
+
+
+/* Instruction set variants */
+/*
+ * Define function template `name<T, Method>' with parameters `params' and
+ * body `...', along with a variant for each other instruction set, named with
+ * the suffixes of MT2_FOR_EACH_ISA. In the body, `lanes' is the number of
+ * doubles in a vector register of the variant's instruction set.
+ */
+#define MT2_ISA_VARIANT(name, target, n_lanes, params, ...) \
+    template <typename T, mt2_method Method>                 \
+    target static void name params                           \
+    {                                                        \
+        enum { lanes = n_lanes };                            \
+        __VA_ARGS__;                                         \
+    }
+
+#ifdef MT2_X86_DISPATCH
+#define MT2_ISA_VARIANTS(name, params, ...)                                                              \
+    MT2_ISA_VARIANT(name, , MT2_VECTOR_BYTES / 8, params, __VA_ARGS__)                                    \
+    MT2_ISA_VARIANT(name##_avx2, __attribute__((target("avx2,fma"))), 4, params, __VA_ARGS__)            \
+    MT2_ISA_VARIANT(name##_avx512, __attribute__((target("avx512f,fma"))), 8, params, __VA_ARGS__)
+
+#define MT2_FOR_EACH_ISA(entry) entry(), entry(_avx2), entry(_avx512)
+#else
+#define MT2_ISA_VARIANTS(name, params, ...) \
+    MT2_ISA_VARIANT(name, , MT2_VECTOR_BYTES / 8, params, __VA_ARGS__)
+
+#define MT2_FOR_EACH_ISA(entry) entry()
+#endif
+
+/* The variants of a function template defined by MT2_ISA_VARIANTS, for each mt2_method. */
+#define MT2_METHODS(name, T) {&name<T, mt2_method_bisect>, &name<T, mt2_method_brent>}
+
+struct mt2_isa_info
+{
+    const char *name;
+    bool (*supported)(void);
+};
+
+static inline bool mt2_isa_baseline(void)
+{
+    return true;
+}
+
+#ifdef MT2_X86_DISPATCH
+static inline bool mt2_isa_avx2(void)
+{
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+}
+
+static inline bool mt2_isa_avx512(void)
+{
+    return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("fma");
+}
+#endif
+
+/* In order of preference, best last, as for MT2_FOR_EACH_ISA. */
+static const struct mt2_isa_info mt2_isas[] = {
+    {"baseline", &mt2_isa_baseline},
+#ifdef MT2_X86_DISPATCH
+    {"avx2", &mt2_isa_avx2},
+    {"avx512", &mt2_isa_avx512},
+#endif
+};
+
+static const int mt2_n_isas = sizeof(mt2_isas) / sizeof(mt2_isas[0]);
+
+/* Returned by mt2_select_isa when it cannot honour the variant asked for. */
+enum
+{
+    mt2_isa_unknown = -1,
+    mt2_isa_unsupported = -2
+};
+
+/*
+ * Return the index in mt2_isas of the variant named `forced', or if that is
+ * NULL or empty, of the best variant supported by this CPU. Returns
+ * mt2_isa_unknown or mt2_isa_unsupported if `forced' cannot be used.
+ */
+static inline int mt2_select_isa(const char *forced)
+{
+#ifdef MT2_X86_DISPATCH
+    __builtin_cpu_init();
+#endif
+
+    if (forced != NULL && forced[0] != '\0')
+    {
+        for (int i = 0; i < mt2_n_isas; ++i)
+        {
+            if (std::strcmp(forced, mt2_isas[i].name) == 0)
+                return mt2_isas[i].supported() ? i : mt2_isa_unsupported;
+        }
+        return mt2_isa_unknown;
+    }
+
+    int best = 0;
+    for (int i = 1; i < mt2_n_isas; ++i)
+    {
+        if (mt2_isas[i].supported())
+            best = i;
+    }
+    return best;
+}
+
+#endif /* MT2_KERNEL_H */
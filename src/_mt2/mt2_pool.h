@@ -0,0 +1,190 @@
+/*
+ * A persistent pool of worker threads, for splitting ufunc loops.
+ *
+ * Work is a range [0, n) divided into fixed-size chunks. The calling thread
+ * and the workers each claim the next unclaimed chunk until none remain, so
+ * threads which meet slow events simply claim fewer chunks.
+ */
+#ifndef MT2_POOL_H
+#define MT2_POOL_H
+
+/*
+ * Includes
+ *
+ * atomic
+ *     std::atomic
+ * condition_variable
+ *     std::condition_variable
+ * cstddef
+ *     std::ptrdiff_t
+ * mutex
+ *     std::mutex, std::lock_guard, std::unique_lock
+ * thread
+ *     std::thread
+ * pthread.h
+ *     pthread_atfork
+ */
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <pthread.h>
+#define MT2_ATFORK 1
+#endif
+
+
+/* Process elements [begin, end) of the work described by context. */
+typedef void (*mt2_pool_task)(void *context, std::ptrdiff_t begin, std::ptrdiff_t end);
+
+class mt2_pool
+{
+public:
+    mt2_pool()
+        : n_workers(0), generation(0), n_wanted(0), n_busy(0),
+          task(NULL), context(NULL), n(0), chunk(1), next(0)
+    {
+    }
+
+    /*
+     * Run task over [0, n) in chunks, on up to n_threads threads including
+     * the caller, and return once all chunks are done.
+     *
+     * Workers are started on first use and then kept waiting for more work.
+     * The pool runs one job at a time; a caller which finds it busy runs its
+     * job alone rather than wait.
+     */
+    void run(int n_threads, std::ptrdiff_t n_, std::ptrdiff_t chunk_,
+             mt2_pool_task task_, void *context_)
+    {
+        std::unique_lock<std::mutex> running(run_mutex, std::try_to_lock);
+        const std::ptrdiff_t n_chunks = (n_ + chunk_ - 1) / chunk_;
+        if (n_threads > n_chunks)
+            n_threads = (int)n_chunks;
+        if (!running.owns_lock() || n_threads <= 1)
+        {
+            task_(context_, 0, n_);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            while (n_workers < n_threads - 1)
+            {
+                try
+                {
+                    std::thread(&mt2_pool::work, this, n_workers, generation).detach();
+                }
+                catch (...)
+                {
+                    /* Make do with the workers we have. */
+                    break;
+                }
+                ++n_workers;
+            }
+
+            task = task_;
+            context = context_;
+            n = n_;
+            chunk = chunk_;
+            next.store(0, std::memory_order_relaxed);
+            n_wanted = n_threads - 1 < n_workers ? n_threads - 1 : n_workers;
+            n_busy = n_wanted;
+            ++generation;
+        }
+        wake.notify_all();
+
+        claim();
+
+        std::unique_lock<std::mutex> lock(mutex);
+        while (n_busy > 0)
+            idle.wait(lock);
+    }
+
+private:
+    /* Worker `index', started while the pool was at generation `seen'. */
+    void work(int index, unsigned long seen)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;)
+        {
+            while (generation == seen)
+                wake.wait(lock);
+            seen = generation;
+            if (index >= n_wanted)
+                continue;
+
+            lock.unlock();
+            claim();
+            lock.lock();
+
+            if (--n_busy == 0)
+                idle.notify_one();
+        }
+    }
+
+    /* Process chunks of the current job until none are left. */
+    void claim()
+    {
+        for (;;)
+        {
+            const std::ptrdiff_t begin = next.fetch_add(chunk, std::memory_order_relaxed);
+            if (begin >= n)
+                return;
+            task(context, begin, begin + chunk < n ? begin + chunk : n);
+        }
+    }
+
+    /* Held by the thread running a job. */
+    std::mutex run_mutex;
+
+    /* Guards everything below except `next'. */
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    int n_workers;
+    unsigned long generation;
+    int n_wanted;
+    int n_busy;
+
+    /* The current job. */
+    mt2_pool_task task;
+    void *context;
+    std::ptrdiff_t n;
+    std::ptrdiff_t chunk;
+    std::atomic<std::ptrdiff_t> next;
+};
+
+
+/*
+ * The pool of this module, started on first use.
+ *
+ * Workers do not survive fork, so the child starts again with an empty pool.
+ * The parent's pool is leaked, since its locks may be held by threads which no
+ * longer exist.
+ */
+static mt2_pool *mt2_process_pool_instance = NULL;
+
+#ifdef MT2_ATFORK
+static inline void mt2_process_pool_atfork_child(void)
+{
+    mt2_process_pool_instance = new mt2_pool();
+}
+#endif
+
+static inline mt2_pool *mt2_process_pool(void)
+{
+    static const bool started = []() {
+        mt2_process_pool_instance = new mt2_pool();
+#ifdef MT2_ATFORK
+        pthread_atfork(NULL, NULL, &mt2_process_pool_atfork_child);
+#endif
+        return true;
+    }();
+    (void)started;
+    return mt2_process_pool_instance;
+}
+
+#endif /* MT2_POOL_H */
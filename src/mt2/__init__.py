@@ -1,12 +1,76 @@
-from typing import Optional, Union, overload
+import enum
+import numbers
+import queue
+import threading
+from typing import (
+    Any,
+    Callable,
+    Iterable,
+    Iterator,
+    Optional,
+    Sequence,
+    Tuple,
+    Union,
+    overload,
+)
 
 import numpy
+import numpy.lib.recfunctions
 
-from mt2._mt2 import mt2_lester_ufunc, mt2_tombs_ufunc  # pyright: ignore [reportMissingImports]
+from mt2._mt2 import (  # pyright: ignore [reportMissingImports]
+    _arrow_export,
+    _arrow_import,
+    _arrow_import_stream,
+    _set_call_method,
+    _set_call_threads,
+    get_num_threads,
+    max_objects,
+    mt2_above_ufunc,
+    mt2_bracket_ufunc,
+    mt2_combinatorial_ufunc,
+    mt2_diagnostics_ufunc,
+    mt2_four_vector_ufunc,
+    mt2_histogram_ufunc,
+    mt2_jagged_ufunc,
+    mt2_lester_ufunc,
+    mt2_polar_ufunc,
+    mt2_rows_ufunc,
+    mt2_scan_ufunc,
+    mt2_select_ufunc,
+    mt2_tombs_hint_ufunc,
+    mt2_tombs_ufunc,
+    mt2_tombs_valid_ufunc,
+    reset_stats,
+    set_num_threads,
+    stats,
+)
 
 __version__ = "1.3.1"
 
-__all__ = ["mt2", "mt2_arxiv", "mt2_ufunc"]
+__all__ = [
+    "ArrowFloat64Array",
+    "MT2Status",
+    "get_num_threads",
+    "mt2",
+    "mt2_above",
+    "mt2_arrow",
+    "mt2_arxiv",
+    "mt2_bracket",
+    "mt2_combinatorial",
+    "mt2_diagnostics",
+    "mt2_four_vector",
+    "mt2_histogram",
+    "mt2_jagged",
+    "mt2_mass_scan",
+    "mt2_polar",
+    "mt2_rows",
+    "mt2_select",
+    "mt2_stream",
+    "mt2_ufunc",
+    "reset_stats",
+    "set_num_threads",
+    "stats",
+]
 
 
 @overload
@@ -24,6 +88,10 @@ def mt2(
     desired_precision_on_mt2: float = 0.0,
     *,
     out: None = None,
+    threads: Optional[int] = None,
+    lo_hint: Optional[float] = None,
+    hi_hint: Optional[float] = None,
+    method: Optional[str] = None,
 ) -> float: ...
 @overload
 def mt2(
@@ -40,6 +108,10 @@ def mt2(
     desired_precision_on_mt2: Union[float, numpy.ndarray] = 0.0,
     *,
     out: Optional[numpy.ndarray] = None,
+    threads: Optional[int] = None,
+    lo_hint: Union[None, float, numpy.ndarray] = None,
+    hi_hint: Union[None, float, numpy.ndarray] = None,
+    method: Optional[str] = None,
 ) -> Union[float, numpy.ndarray]: ...
 def mt2(
     m_vis_1: Union[float, numpy.ndarray],
@@ -55,6 +127,10 @@ def mt2(
     desired_precision_on_mt2: Union[float, numpy.ndarray] = 0.0,
     *,
     out: Optional[numpy.ndarray] = None,
+    threads: Optional[int] = None,
+    lo_hint: Union[None, float, numpy.ndarray] = None,
+    hi_hint: Union[None, float, numpy.ndarray] = None,
+    method: Optional[str] = None,
 ) -> Union[float, numpy.ndarray]:
     """
     Returns asymmetric mT2 (which is >=0), or a negative value if no solution exists.
@@ -72,6 +148,21 @@ def mt2(
     directly, which specifies additional arguments (like `where`) in keeping with other
     numpy ufuncs.
 
+    Large arrays can be split across several threads, either for all calls with
+    `set_num_threads`, or for one call with `threads`. Events are handed out to
+    threads in small chunks as they become free, so slow events do not hold up the
+    rest. Results do not depend on the number of threads.
+
+    When MT2 has already been found for similar inputs, such as before a small change
+    in calibration, `lo_hint` and `hi_hint` can bracket each new result to save time.
+    Each hint is tested once before use, so a wrong hint costs a little time but does
+    not make the result any less accurate.
+
+    By default MT2 is found by bisection, which halves its bracket with each step.
+    With `method="brent"`, Brent's method is used instead: it interpolates to the root
+    where it can and falls back to bisection where it cannot, so it usually needs
+    several times fewer steps, and agrees with bisection to the requested precision.
+
     Args:
         m_vis_1: Mass of visible particle 1
         px_vis_1: x-momentum of visible particle 1
@@ -91,13 +182,624 @@ def mt2(
             Note that by requesting precision of ±0.01 GeV on an MT2 value of 100 GeV
             can result in speedups of a factor of two to three.
         out: If specified, an array into which the output will be placed.
-            Must have dtype numpy.float64.
+            Must have dtype numpy.float64, or numpy.float32 if all inputs are float32.
+        threads: If specified, the number of threads to use for this call, with 0
+            meaning one per CPU. Otherwise, the number set by `set_num_threads` is
+            used, which is 1 by default.
+        lo_hint: If specified, a suggested lower bound on MT2. It is ignored if it is
+            not finite, or is found not to be a lower bound.
+        hi_hint: If specified, a suggested upper bound on MT2. It is ignored if it is
+            not finite, and searched up from if it is found not to be an upper bound.
+        method: The root-finding method, "bisect" (the default) or "brent".
 
     Returns:
         MT2 calculated for all inputs. If an array, will have shape that is the result
-        of broadcasting all inputs.
+        of broadcasting all inputs. This is float32 if all inputs are float32 (the
+        calculation is still done in double precision), and float64 otherwise.
+    """
+    if lo_hint is None and hi_hint is None:
+        return _call(
+            mt2_tombs_ufunc,
+            threads,
+            method,
+            m_vis_1,
+            px_vis_1,
+            py_vis_1,
+            m_vis_2,
+            px_vis_2,
+            py_vis_2,
+            px_miss,
+            py_miss,
+            m_invis_1,
+            m_invis_2,
+            desired_precision_on_mt2,
+            out,
+        )
+    # A hint of zero is never above the initial lower bound, so is unused.
+    return _call(
+        mt2_tombs_hint_ufunc,
+        threads,
+        method,
+        m_vis_1,
+        px_vis_1,
+        py_vis_1,
+        m_vis_2,
+        px_vis_2,
+        py_vis_2,
+        px_miss,
+        py_miss,
+        m_invis_1,
+        m_invis_2,
+        desired_precision_on_mt2,
+        0.0 if lo_hint is None else lo_hint,
+        0.0 if hi_hint is None else hi_hint,
+        out,
+    )
+
+
+def mt2_above(
+    m_vis_1: Union[float, numpy.ndarray],
+    px_vis_1: Union[float, numpy.ndarray],
+    py_vis_1: Union[float, numpy.ndarray],
+    m_vis_2: Union[float, numpy.ndarray],
+    px_vis_2: Union[float, numpy.ndarray],
+    py_vis_2: Union[float, numpy.ndarray],
+    px_miss: Union[float, numpy.ndarray],
+    py_miss: Union[float, numpy.ndarray],
+    m_invis_1: Union[float, numpy.ndarray],
+    m_invis_2: Union[float, numpy.ndarray],
+    threshold: Union[float, numpy.ndarray],
+    *,
+    out: Optional[numpy.ndarray] = None,
+    threads: Optional[int] = None,
+) -> Union[bool, numpy.ndarray]:
+    """
+    Returns whether asymmetric mT2 is above `threshold`, usually without finding it.
+
+    This agrees with `mt2(...) > threshold`, but is much faster, so suits event
+    selection. Most events are settled by cheap lower and upper bounds on mT2, and the
+    rest by a single test of whether the ellipses of `mt2` are disjoint at the
+    threshold. Only events whose mT2 is within rounding of the threshold may disagree.
+
+    Like `mt2(...) > threshold`, this is False where mT2 would be NaN, or for a NaN
+    threshold.
+
+    Args:
+        m_vis_1, ..., m_invis_2: As for `mt2`.
+        threshold: The value of mT2 to compare against.
+        out: If specified, an array into which the output will be placed.
+            Must have dtype numpy.bool_.
+        threads: As for `mt2`.
+
+    Returns:
+        Whether mT2 is above `threshold` for all inputs, broadcast as for `mt2`.
+    """
+    return _call(
+        mt2_above_ufunc,
+        threads,
+        None,
+        m_vis_1,
+        px_vis_1,
+        py_vis_1,
+        m_vis_2,
+        px_vis_2,
+        py_vis_2,
+        px_miss,
+        py_miss,
+        m_invis_1,
+        m_invis_2,
+        threshold,
+        out,
+    )
+
+
+def mt2_mass_scan(
+    m_vis_1: Union[float, numpy.ndarray],
+    px_vis_1: Union[float, numpy.ndarray],
+    py_vis_1: Union[float, numpy.ndarray],
+    m_vis_2: Union[float, numpy.ndarray],
+    px_vis_2: Union[float, numpy.ndarray],
+    py_vis_2: Union[float, numpy.ndarray],
+    px_miss: Union[float, numpy.ndarray],
+    py_miss: Union[float, numpy.ndarray],
+    m_invis_grid: numpy.ndarray,
+    desired_precision_on_mt2: Union[float, numpy.ndarray] = 0.0,
+    *,
+    out: Optional[numpy.ndarray] = None,
+    threads: Optional[int] = None,
+    method: Optional[str] = None,
+) -> numpy.ndarray:
+    """
+    Returns symmetric mT2 for each event at each of a grid of invisible masses.
+
+    This gives the same results as `mt2` with both invisible masses broadcast along a
+    final axis of length K, but is faster: each event's kinematics are prepared once,
+    and each result is used to narrow the search at the next grid point. An ascending
+    grid gives the most benefit, but any order gives correct results.
+
+    Args:
+        m_vis_1: Mass of visible particle 1
+        px_vis_1: x-momentum of visible particle 1
+        py_vis_1: y-momentum of visible particle 1
+        m_vis_2: Mass of visible particle 2
+        px_vis_2: x-momentum of visible particle 2
+        py_vis_2: y-momentum of visible particle 2
+        px_miss: x component of missing momentum
+        py_miss: y component of missing momentum
+        m_invis_grid: Assumed masses of both invisible particles, along the last axis.
+            Any leading axes are broadcast against the other arguments.
+        desired_precision_on_mt2: As for `mt2`.
+        out: If specified, an array into which the output will be placed.
+            Must have dtype numpy.float64, or numpy.float32 if all inputs are float32.
+        threads: As for `mt2`.
+        method: As for `mt2`.
+
+    Returns:
+        MT2 calculated for all inputs, with shape (..., K), where ... is the result of
+        broadcasting all inputs other than the last axis of `m_invis_grid`.
+    """
+    return _call(
+        mt2_scan_ufunc,
+        threads,
+        method,
+        m_vis_1,
+        px_vis_1,
+        py_vis_1,
+        m_vis_2,
+        px_vis_2,
+        py_vis_2,
+        px_miss,
+        py_miss,
+        m_invis_grid,
+        desired_precision_on_mt2,
+        out,
+    )
+
+
+def mt2_bracket(
+    m_vis_1: Union[float, numpy.ndarray],
+    px_vis_1: Union[float, numpy.ndarray],
+    py_vis_1: Union[float, numpy.ndarray],
+    m_vis_2: Union[float, numpy.ndarray],
+    px_vis_2: Union[float, numpy.ndarray],
+    py_vis_2: Union[float, numpy.ndarray],
+    px_miss: Union[float, numpy.ndarray],
+    py_miss: Union[float, numpy.ndarray],
+    m_invis_1: Union[float, numpy.ndarray],
+    m_invis_2: Union[float, numpy.ndarray],
+    max_tests: Union[int, numpy.ndarray],
+    *,
+    out: Optional[Tuple[numpy.ndarray, numpy.ndarray]] = None,
+    threads: Optional[int] = None,
+) -> Tuple[Union[float, numpy.ndarray], Union[float, numpy.ndarray]]:
+    """
+    Returns lower and upper bounds on asymmetric mT2, with a fixed worst-case cost.
+
+    The bracket starts from cheap bounds on mT2, and is bisected with at most
+    `max_tests` tests of whether the ellipses of `mt2` are disjoint, each of which
+    halves its width. With `max_tests=0` only the cheap bounds are used. Bisection
+    stops early once the bracket is as tight as `mt2` at full precision, which takes
+    up to about 50 tests for float64 inputs.
+
+    mT2 is always within the bracket, up to rounding: float32 outputs are rounded
+    outwards. Where mT2 would be 0 or NaN, both bounds are that value.
+
+    Args:
+        m_vis_1, ..., m_invis_2: As for `mt2`.
+        max_tests: The largest number of disjointness tests to make for each event,
+            which must not be negative.
+        out: If specified, a tuple of two arrays into which the lower and upper bounds
+            will be placed. Each must have dtype numpy.float64, or numpy.float32 if all
+            inputs are float32.
+        threads: As for `mt2`.
+
+    Returns:
+        A tuple of the lower and upper bounds on mT2 for all inputs, each broadcast as
+        for `mt2`.
+    """
+    if numpy.any(numpy.asarray(max_tests) < 0):
+        raise ValueError("max_tests must not be negative")
+    return _call(
+        mt2_bracket_ufunc,
+        threads,
+        None,
+        m_vis_1,
+        px_vis_1,
+        py_vis_1,
+        m_vis_2,
+        px_vis_2,
+        py_vis_2,
+        px_miss,
+        py_miss,
+        m_invis_1,
+        m_invis_2,
+        max_tests,
+        *((None, None) if out is None else out),
+    )
+
+
+class MT2Status(enum.IntEnum):
+    """How the search for mT2 ended for an event, as returned by `mt2_diagnostics`."""
+
+    OK = 0
+    """mT2 was found to the requested precision."""
+    ZERO = 1
+    """All inputs were zero, so mT2 is zero."""
+    NAN_INPUT = 2
+    """A momentum was NaN, so mT2 is NaN."""
+    NO_BRACKET = 3
+    """A disjointness test failed before mT2 was bracketed, so mT2 is NaN."""
+    UNBOUNDED = 4
+    """No upper bound on mT2 was found, so mT2 is infinite."""
+    IMPRECISE = 5
+    """A disjointness test failed while narrowing the bracket, so mT2 is its lower
+    end, which may be less precise than requested."""
+
+
+def mt2_diagnostics(
+    m_vis_1: Union[float, numpy.ndarray],
+    px_vis_1: Union[float, numpy.ndarray],
+    py_vis_1: Union[float, numpy.ndarray],
+    m_vis_2: Union[float, numpy.ndarray],
+    px_vis_2: Union[float, numpy.ndarray],
+    py_vis_2: Union[float, numpy.ndarray],
+    px_miss: Union[float, numpy.ndarray],
+    py_miss: Union[float, numpy.ndarray],
+    m_invis_1: Union[float, numpy.ndarray],
+    m_invis_2: Union[float, numpy.ndarray],
+    desired_precision_on_mt2: Union[float, numpy.ndarray] = 0.0,
+    *,
+    out: Optional[
+        Tuple[numpy.ndarray, numpy.ndarray, numpy.ndarray, numpy.ndarray]
+    ] = None,
+    threads: Optional[int] = None,
+    method: Optional[str] = None,
+) -> Tuple[
+    Union[float, numpy.ndarray],
+    Union[int, numpy.ndarray],
+    Union[int, numpy.ndarray],
+    Union[int, numpy.ndarray],
+]:
+    """
+    Returns asymmetric mT2, with how the search for it ended and what it cost.
+
+    The value of mT2 agrees with `mt2` to its precision, but the search works through
+    events one at a time, so is slower; this is meant for finding expensive or problematic
+    regions of phase space, rather than for routine use.
+
+    Args:
+        m_vis_1, ..., desired_precision_on_mt2: As for `mt2`.
+        out: If specified, a tuple of four arrays into which the outputs will be
+            placed, with the dtypes below.
+        threads: As for `mt2`.
+        method: As for `mt2`.
+
+    Returns:
+        A tuple of four arrays, each broadcast as for `mt2`:
+            mT2, as from `mt2` up to rounding.
+            The status of each event as an `MT2Status` value, with dtype numpy.uint8.
+            The number of disjointness tests spent expanding the upper bound on mT2,
+                with dtype numpy.uint16.
+            The number of disjointness tests in total, including those expanding the
+                upper bound, with dtype numpy.uint16. Counts saturate at 65535.
+    """
+    return _call(
+        mt2_diagnostics_ufunc,
+        threads,
+        method,
+        m_vis_1,
+        px_vis_1,
+        py_vis_1,
+        m_vis_2,
+        px_vis_2,
+        py_vis_2,
+        px_miss,
+        py_miss,
+        m_invis_1,
+        m_invis_2,
+        desired_precision_on_mt2,
+        *((None,) * 4 if out is None else out),
+    )
+
+
+def mt2_combinatorial(
+    e_vis: numpy.ndarray,
+    px_vis: numpy.ndarray,
+    py_vis: numpy.ndarray,
+    pz_vis: numpy.ndarray,
+    offsets: numpy.ndarray,
+    px_miss: Union[float, numpy.ndarray],
+    py_miss: Union[float, numpy.ndarray],
+    m_invis_1: Union[float, numpy.ndarray],
+    m_invis_2: Union[float, numpy.ndarray],
+    desired_precision_on_mt2: Union[float, numpy.ndarray] = 0.0,
+    *,
+    out: Optional[Tuple[numpy.ndarray, numpy.ndarray]] = None,
+    threads: Optional[int] = None,
+    method: Optional[str] = None,
+) -> Tuple[numpy.ndarray, numpy.ndarray]:
+    """
+    Returns the least asymmetric mT2 over ways of splitting each event's visible
+    objects into two legs.
+
+    Each leg is the sum of the four-vectors of its objects, and every split into two
+    non-empty legs is considered. This agrees with the least `mt2` over all splits,
+    but pairings are visited in order of a cheap lower bound on their mT2, and the
+    search for each event stops once that bound reaches the best mT2 so far. A single
+    disjointness test rules out most of the other pairings without finding their mT2.
+
+    The objects are given as jagged arrays: the objects of event i are those from
+    `offsets[i]` to `offsets[i + 1]` of the flat arrays `e_vis`, ..., `pz_vis`.
+
+    Args:
+        e_vis, px_vis, py_vis, pz_vis: The four-momenta of the visible objects of all
+            events, as flat arrays of equal length.
+        offsets: The index of the first object of each event, followed by one past
+            the last object of the last event, as a non-decreasing 1-d integer array.
+        px_miss, ..., desired_precision_on_mt2: As for `mt2`, for each event.
+            Pairings whose mT2 is NaN are ignored.
+        out: If specified, a tuple of two arrays into which the outputs will be
+            placed, with the dtypes below.
+        threads: As for `mt2`.
+        method: As for `mt2`.
+
+    Returns:
+        A tuple of two arrays with one element per event:
+            The least mT2, with dtype numpy.float64, or numpy.float32 if all inputs
+                are float32. It is NaN for events with fewer than two objects, or
+                whose pairings all give NaN.
+            The pairing with that mT2, as a numpy.int64 mask whose bit j is set if
+                the j-th object of the event is in the leg of `m_invis_1`, or -1 if
+                mT2 is NaN. With equal invisible masses, the last object is always
+                in the other leg.
+
+    Raises:
+        ValueError: If the offsets are invalid, or an event has more than
+            `mt2._mt2.max_objects` objects.
+    """
+    offsets = numpy.asarray(offsets, dtype=numpy.int64)
+    if offsets.ndim != 1 or len(offsets) < 1:
+        raise ValueError("offsets must be a 1-d array of at least one index")
+    counts = numpy.diff(offsets)
+    if offsets[0] < 0 or (counts < 0).any() or offsets[-1] > numpy.shape(e_vis)[-1]:
+        raise ValueError("offsets must increase monotonically within the objects")
+    if len(counts) > 0 and counts.max() > max_objects:
+        raise ValueError(f"events may have at most {max_objects} objects")
+
+    return _call(
+        mt2_combinatorial_ufunc,
+        threads,
+        method,
+        e_vis,
+        px_vis,
+        py_vis,
+        pz_vis,
+        offsets[:-1],
+        offsets[1:],
+        px_miss,
+        py_miss,
+        m_invis_1,
+        m_invis_2,
+        desired_precision_on_mt2,
+        *((None, None) if out is None else out),
+    )
+
+
+def mt2_jagged(
+    m_vis: numpy.ndarray,
+    px_vis: numpy.ndarray,
+    py_vis: numpy.ndarray,
+    offsets: numpy.ndarray,
+    px_miss: Union[float, numpy.ndarray],
+    py_miss: Union[float, numpy.ndarray],
+    m_invis_1: Union[float, numpy.ndarray],
+    m_invis_2: Union[float, numpy.ndarray],
+    desired_precision_on_mt2: float = 0.0,
+    *,
+    legs: str = "leading",
+    threads: Optional[int] = None,
+    method: Optional[str] = None,
+) -> Tuple[numpy.ndarray, numpy.ndarray]:
     """
-    return mt2_tombs_ufunc(
+    Returns asymmetric mT2 for pairs of visible objects in jagged events.
+
+    The objects are given as jagged arrays, read where they lie without padding: the
+    objects of event i are those from `offsets[i]` to `offsets[i + 1]` of the flat
+    arrays `m_vis`, `px_vis` and `py_vis`, as in the content and offsets of an
+    Awkward Array. The results are written to a flat array with offsets of its own.
+
+    Args:
+        m_vis, px_vis, py_vis: The masses and transverse momenta of the visible
+            objects of all events, as flat arrays of equal length.
+        offsets: The index of the first object of each event, followed by one past
+            the last object of the last event, as a non-decreasing 1-d integer array.
+        px_miss, py_miss, m_invis_1, m_invis_2: As for `mt2`, for each event.
+        desired_precision_on_mt2: As for `mt2`, for all events.
+        legs: Which objects form the two legs:
+            "leading": The first two objects of each event, in that order. There is
+                one result per event, which is NaN if it has fewer than two objects.
+            "pairs": Each pair of objects in each event, in the order (0, 1), (0, 2),
+                ..., (1, 2), ..., with the first of each pair in the leg of
+                `m_invis_1`. There are n * (n - 1) / 2 results for an event of n
+                objects.
+        threads: As for `mt2`.
+        method: As for `mt2`.
+
+    Returns:
+        A tuple of the flat results, with dtype numpy.float64, or numpy.float32 if all
+        inputs are float32, and the offsets of each event's results within them.
+    """
+    if legs not in ("leading", "pairs"):
+        raise ValueError(f"legs must be 'leading' or 'pairs', not {legs!r}")
+    m_vis, px_vis, py_vis = (numpy.asarray(arg) for arg in (m_vis, px_vis, py_vis))
+    offsets = numpy.asarray(offsets, dtype=numpy.int64)
+    if offsets.ndim != 1 or len(offsets) < 1:
+        raise ValueError("offsets must be a 1-d array of at least one index")
+    counts = numpy.diff(offsets)
+    if offsets[0] < 0 or (counts < 0).any() or offsets[-1] > numpy.shape(m_vis)[-1]:
+        raise ValueError("offsets must increase monotonically within the objects")
+
+    n_events = len(counts)
+    dtype = numpy.result_type(
+        m_vis, px_vis, py_vis, px_miss, py_miss, m_invis_1, m_invis_2, numpy.float32
+    )
+    events = [
+        numpy.broadcast_to(numpy.asarray(arg, dtype), (n_events,))
+        for arg in (px_miss, py_miss, m_invis_1, m_invis_2)
+    ]
+    if legs == "leading":
+        out_offsets = numpy.arange(n_events + 1, dtype=numpy.int64)
+    else:
+        out_offsets = numpy.zeros(n_events + 1, dtype=numpy.int64)
+        numpy.cumsum(counts * (counts - 1) // 2, out=out_offsets[1:])
+
+    out = numpy.empty(out_offsets[-1], dtype)
+    _call(
+        mt2_jagged_ufunc,
+        threads,
+        method,
+        m_vis.astype(dtype, copy=False),
+        px_vis.astype(dtype, copy=False),
+        py_vis.astype(dtype, copy=False),
+        offsets[:-1],
+        offsets[1:],
+        out_offsets[:-1],
+        *events,
+        desired_precision_on_mt2,
+        legs == "pairs",
+        out,
+    )
+    return out, out_offsets
+
+
+def mt2_histogram(
+    m_vis_1: Union[float, numpy.ndarray],
+    px_vis_1: Union[float, numpy.ndarray],
+    py_vis_1: Union[float, numpy.ndarray],
+    m_vis_2: Union[float, numpy.ndarray],
+    px_vis_2: Union[float, numpy.ndarray],
+    py_vis_2: Union[float, numpy.ndarray],
+    px_miss: Union[float, numpy.ndarray],
+    py_miss: Union[float, numpy.ndarray],
+    m_invis_1: Union[float, numpy.ndarray],
+    m_invis_2: Union[float, numpy.ndarray],
+    bins: numpy.ndarray,
+    *,
+    weights: Optional[Union[float, numpy.ndarray]] = None,
+    threads: Optional[int] = None,
+) -> Tuple[numpy.ndarray, numpy.ndarray]:
+    """
+    Returns a histogram of asymmetric mT2 over events, usually without finding it.
+
+    This agrees with `numpy.histogram(mt2(...), bins, weights=weights)`, but is faster
+    and needs no array of mT2 values. Each event is only located among the bin edges,
+    by a binary search that tests whether the ellipses of `mt2` are disjoint at each
+    edge, and most events are settled by cheap bounds on mT2 after a few steps.
+
+    As in `numpy.histogram`, bin i counts events with `bins[i] <= mT2 < bins[i + 1]`,
+    except that the last bin also counts those at its right edge. So an mT2 of exactly
+    zero, or exactly the lower bound on mT2 of the visible and invisible masses, is
+    counted in the bin starting there. Other events whose mT2 is within rounding of
+    an edge may fall on either side of it. Events where mT2 would be NaN, or which
+    fall outside the edges, are not counted.
+
+    Args:
+        m_vis_1, ..., m_invis_2: As for `mt2`. All are broadcast together, and each
+            element of the result is an event.
+        bins: The monotonically increasing bin edges, as a 1-d array.
+        weights: If specified, the weight of each event, broadcast against the events.
+        threads: As for `mt2`.
+
+    Returns:
+        A tuple of the histogram and the bin edges, as for `numpy.histogram`. The
+        histogram has dtype numpy.int64, or numpy.float64 if `weights` is specified.
+    """
+    edges = numpy.asarray(bins, dtype=numpy.float64)
+    if edges.ndim != 1 or len(edges) < 2:
+        raise ValueError("bins must be a 1-d array of at least two edges")
+    if numpy.isnan(edges).any() or (numpy.diff(edges) < 0).any():
+        raise ValueError("bins must increase monotonically")
+
+    args = (
+        m_vis_1,
+        px_vis_1,
+        py_vis_1,
+        m_vis_2,
+        px_vis_2,
+        py_vis_2,
+        px_miss,
+        py_miss,
+        m_invis_1,
+        m_invis_2,
+    )
+    dtype = numpy.result_type(*args, numpy.float32)
+    shape = numpy.broadcast_shapes(
+        *(numpy.shape(arg) for arg in args), numpy.shape(weights)
+    )
+    # The events form the last core dimension of the ufunc, so there must be one.
+    shape = shape or (1,)
+    events = [numpy.broadcast_to(numpy.asarray(arg, dtype), shape) for arg in args]
+    event_weights = numpy.broadcast_to(
+        numpy.asarray(1.0 if weights is None else weights, numpy.float64), shape
+    )
+
+    out = numpy.zeros(shape[:-1] + (len(edges) - 1,))
+    _call(mt2_histogram_ufunc, threads, None, *events, event_weights, edges, out)
+    hist = out.reshape(-1, len(edges) - 1).sum(axis=0)
+    if weights is None:
+        hist = hist.astype(numpy.int64)
+    return hist, edges
+
+
+# The number of events tested by each call of mt2_select_ufunc, which bounds the
+# memory used for their indices before they are compacted.
+_SELECT_BLOCK = 65536
+
+
+def mt2_select(
+    m_vis_1: Union[float, numpy.ndarray],
+    px_vis_1: Union[float, numpy.ndarray],
+    py_vis_1: Union[float, numpy.ndarray],
+    m_vis_2: Union[float, numpy.ndarray],
+    px_vis_2: Union[float, numpy.ndarray],
+    py_vis_2: Union[float, numpy.ndarray],
+    px_miss: Union[float, numpy.ndarray],
+    py_miss: Union[float, numpy.ndarray],
+    m_invis_1: Union[float, numpy.ndarray],
+    m_invis_2: Union[float, numpy.ndarray],
+    *,
+    above: Optional[float] = None,
+    below: Optional[float] = None,
+    columns: Optional[Sequence[numpy.ndarray]] = None,
+    threads: Optional[int] = None,
+) -> Union[numpy.ndarray, Tuple[numpy.ndarray, ...]]:
+    """
+    Returns the indices of events whose asymmetric mT2 is within a window.
+
+    This agrees with `numpy.flatnonzero((mt2(...) > above) & (mt2(...) <= below))`,
+    but is much faster and needs neither an array of mT2 values nor a boolean mask.
+    As for `mt2_above`, each event is usually settled by cheap bounds on mT2, and
+    otherwise by a test of whether the ellipses of `mt2` are disjoint at each edge of
+    the window. The events are tested in blocks, so that the memory used grows with
+    the number of events selected rather than the number tested.
+
+    Events where mT2 would be NaN are never selected.
+
+    Args:
+        m_vis_1, ..., m_invis_2: As for `mt2`. All are broadcast together, and each
+            element of the result is an event.
+        above: If specified, select only events with mT2 above this.
+        below: If specified, select only events with mT2 at or below this.
+        columns: If specified, arrays whose leading dimensions are those of the
+            events, whose selected rows are returned instead of the indices.
+        threads: As for `mt2`.
+
+    Returns:
+        The flat indices of the selected events, as a numpy.int64 array in increasing
+        order. If `columns` is specified, instead a tuple of the selected rows of each
+        column, in the order of the indices.
+    """
+    args = (
         m_vis_1,
         px_vis_1,
         py_vis_1,
@@ -108,11 +810,540 @@ def mt2(
         py_miss,
         m_invis_1,
         m_invis_2,
+    )
+    dtype = numpy.result_type(*args, numpy.float32)
+    shape = numpy.broadcast_shapes(*(numpy.shape(arg) for arg in args))
+    size = int(numpy.prod(shape))
+    lo = -numpy.inf if above is None else float(above)
+    hi = numpy.inf if below is None else float(below)
+
+    pieces = []
+    if not (numpy.isnan(lo) or numpy.isnan(hi)):
+        # Blocks are walked in C order over the broadcast shape, so that the start of
+        # each is its flat index. Arguments are viewed where they can be, and
+        # otherwise copied a block at a time, never broadcast to the full shape.
+        events = numpy.nditer(
+            [numpy.asarray(arg, dtype) for arg in args],
+            flags=["external_loop", "buffered", "zerosize_ok"],
+            op_flags=[["readonly"]] * len(args),
+            order="C",
+            buffersize=_SELECT_BLOCK,
+        )
+        indices = numpy.empty(min(size, _SELECT_BLOCK), numpy.int64)
+        count = numpy.empty((), numpy.int64)
+        for block in events:
+            start = events.iterindex
+            out = indices[: len(block[0])]
+            _call(mt2_select_ufunc, threads, None, *block, lo, hi, out, count)
+            pieces.append(out[: int(count)] + start)
+    selected = numpy.concatenate(pieces) if pieces else numpy.empty(0, numpy.int64)
+
+    if columns is None:
+        return selected
+    result = []
+    for column in columns:
+        column = numpy.asarray(column)
+        if column.shape[: len(shape)] != shape:
+            raise ValueError(
+                f"columns must have leading dimensions {shape}, not {column.shape}"
+            )
+        rows = column.reshape((size,) + column.shape[len(shape) :])
+        result.append(numpy.take(rows, selected, axis=0))
+    return tuple(result)
+
+
+def mt2_rows(
+    events: numpy.ndarray,
+    desired_precision_on_mt2: Union[float, numpy.ndarray] = 0.0,
+    *,
+    fields: Optional[Sequence[Union[int, str]]] = None,
+    out: Optional[numpy.ndarray] = None,
+    threads: Optional[int] = None,
+    method: Optional[str] = None,
+) -> numpy.ndarray:
+    """
+    Returns asymmetric mT2 for events stored one per row.
+
+    This gives the same results as `mt2` with the ten arguments taken from each row,
+    but reads each event from one place in memory rather than from ten separate
+    arrays. It suits data that is already an (N, 10) matrix, or a structured array
+    whose records hold the ten values side by side.
+
+    Args:
+        events: The events, as an array of shape (..., K) whose last axis holds the
+            arguments of `mt2` from `m_vis_1` to `m_invis_2`, or as a structured array
+            of records. Rows are fastest when their values are adjacent in memory.
+        desired_precision_on_mt2: As for `mt2`, broadcast against the rows.
+        fields: The ten columns of `events` to use, in the order of the arguments of
+            `mt2`: indices of the last axis if `events` is a plain array, or field
+            names if it is structured. By default, the last axis must have length
+            10, or the records exactly ten fields.
+        out: If specified, an array into which the output will be placed. Must have
+            dtype numpy.float64, or numpy.float32 if `events` is float32.
+        threads: As for `mt2`.
+        method: As for `mt2`.
+
+    Returns:
+        MT2 calculated for all rows, with the shape of `events` without its last axis,
+        or the shape of `events` if it is structured.
+    """
+    events = numpy.asanyarray(events)
+    if events.dtype.names is not None:
+        names = events.dtype.names if fields is None else fields
+        if len(names) != 10:
+            raise ValueError(f"events must have 10 fields to use, not {len(names)}")
+        # A view onto the records when the fields share a dtype and are evenly spaced.
+        rows = numpy.lib.recfunctions.structured_to_unstructured(events[list(names)])
+    elif fields is not None:
+        if len(fields) != 10:
+            raise ValueError(f"fields must name 10 columns, not {len(fields)}")
+        rows = events[..., list(fields)]
+    else:
+        rows = events
+    return _call(mt2_rows_ufunc, threads, method, rows, desired_precision_on_mt2, out)
+
+
+def mt2_polar(
+    pt_vis_1: Union[float, numpy.ndarray],
+    phi_vis_1: Union[float, numpy.ndarray],
+    m_vis_1: Union[float, numpy.ndarray],
+    pt_vis_2: Union[float, numpy.ndarray],
+    phi_vis_2: Union[float, numpy.ndarray],
+    m_vis_2: Union[float, numpy.ndarray],
+    met: Union[float, numpy.ndarray],
+    phi_miss: Union[float, numpy.ndarray],
+    m_invis_1: Union[float, numpy.ndarray],
+    m_invis_2: Union[float, numpy.ndarray],
+    desired_precision_on_mt2: Union[float, numpy.ndarray] = 0.0,
+    *,
+    out: Optional[numpy.ndarray] = None,
+    threads: Optional[int] = None,
+    method: Optional[str] = None,
+) -> Union[float, numpy.ndarray]:
+    """
+    Returns asymmetric mT2 from momenta given by magnitude and azimuthal angle.
+
+    This gives the same results as `mt2` with `px = pt * cos(phi)` and
+    `py = pt * sin(phi)` for each visible particle and the missing momentum, up to
+    rounding, but converts inside the loop rather than making temporary arrays.
+
+    Args:
+        pt_vis_1: Transverse momentum of visible particle 1
+        phi_vis_1: Azimuthal angle of visible particle 1, in radians
+        m_vis_1: Mass of visible particle 1
+        pt_vis_2: Transverse momentum of visible particle 2
+        phi_vis_2: Azimuthal angle of visible particle 2, in radians
+        m_vis_2: Mass of visible particle 2
+        met: Magnitude of the missing transverse momentum
+        phi_miss: Azimuthal angle of the missing transverse momentum, in radians
+        m_invis_1, ..., method: As for `mt2`.
+
+    Returns:
+        MT2 calculated for all inputs, broadcast as for `mt2`.
+    """
+    return _call(
+        mt2_polar_ufunc,
+        threads,
+        method,
+        pt_vis_1,
+        phi_vis_1,
+        m_vis_1,
+        pt_vis_2,
+        phi_vis_2,
+        m_vis_2,
+        met,
+        phi_miss,
+        m_invis_1,
+        m_invis_2,
+        desired_precision_on_mt2,
+        out,
+    )
+
+
+def mt2_four_vector(
+    e_vis_1: Union[float, numpy.ndarray],
+    px_vis_1: Union[float, numpy.ndarray],
+    py_vis_1: Union[float, numpy.ndarray],
+    pz_vis_1: Union[float, numpy.ndarray],
+    e_vis_2: Union[float, numpy.ndarray],
+    px_vis_2: Union[float, numpy.ndarray],
+    py_vis_2: Union[float, numpy.ndarray],
+    pz_vis_2: Union[float, numpy.ndarray],
+    met: Union[float, numpy.ndarray],
+    phi_miss: Union[float, numpy.ndarray],
+    m_invis_1: Union[float, numpy.ndarray],
+    m_invis_2: Union[float, numpy.ndarray],
+    desired_precision_on_mt2: Union[float, numpy.ndarray] = 0.0,
+    *,
+    out: Optional[numpy.ndarray] = None,
+    threads: Optional[int] = None,
+    method: Optional[str] = None,
+) -> Union[float, numpy.ndarray]:
+    """
+    Returns asymmetric mT2 from the four-momenta of the visible particles.
+
+    This gives the same results as `mt2` with the mass of each visible particle
+    `sqrt(e**2 - px**2 - py**2 - pz**2)`, or zero where that is negative through
+    rounding, and the missing momentum converted as for `mt2_polar`, up to rounding.
+    The conversion happens inside the loop rather than making temporary arrays.
+
+    Args:
+        e_vis_1, px_vis_1, py_vis_1, pz_vis_1: Four-momentum of visible particle 1
+        e_vis_2, px_vis_2, py_vis_2, pz_vis_2: Four-momentum of visible particle 2
+        met, phi_miss: As for `mt2_polar`.
+        m_invis_1, ..., method: As for `mt2`.
+
+    Returns:
+        MT2 calculated for all inputs, broadcast as for `mt2`.
+    """
+    return _call(
+        mt2_four_vector_ufunc,
+        threads,
+        method,
+        e_vis_1,
+        px_vis_1,
+        py_vis_1,
+        pz_vis_1,
+        e_vis_2,
+        px_vis_2,
+        py_vis_2,
+        pz_vis_2,
+        met,
+        phi_miss,
+        m_invis_1,
+        m_invis_2,
         desired_precision_on_mt2,
         out,
     )
 
 
+class ArrowFloat64Array:
+    """
+    A float64 array with optional nulls, which Arrow libraries import without copying.
+
+    It implements the Arrow PyCapsule interface, so that, for example,
+    `pyarrow.array(result)` is a `pyarrow.DoubleArray` sharing its memory.
+
+    Attributes:
+        values: The values, as a 1-d numpy.float64 array. Nulls are NaN.
+        valid: Whether each value is not null, as a 1-d boolean array, or None if
+            there are no nulls.
+    """
+
+    def __init__(self, values: numpy.ndarray, valid: Optional[numpy.ndarray] = None):
+        self.values = numpy.ascontiguousarray(values, dtype=numpy.float64)
+        if self.values.ndim != 1:
+            raise ValueError("values must be 1-d")
+        self.valid = None
+        self._bitmap = None
+        self.null_count = 0
+        if valid is not None:
+            valid = numpy.asarray(valid, dtype=bool)
+            if valid.shape != self.values.shape:
+                raise ValueError("valid must have the shape of values")
+            self.null_count = len(valid) - int(numpy.count_nonzero(valid))
+            if self.null_count > 0:
+                self.valid = valid
+                self._bitmap = numpy.packbits(valid, bitorder="little")
+
+    def __len__(self) -> int:
+        return len(self.values)
+
+    def __arrow_c_array__(self, requested_schema=None):
+        """Return new capsules of the ArrowSchema and ArrowArray of this array."""
+        return _arrow_export(self.values, self._bitmap, self.null_count)
+
+
+def _arrow_chunks(column) -> list:
+    """Return the chunks of an Arrow array, as imported by `_arrow_import`."""
+    if hasattr(column, "__arrow_c_array__"):
+        return [_arrow_import(*column.__arrow_c_array__())]
+    if hasattr(column, "__arrow_c_stream__"):
+        return _arrow_import_stream(column.__arrow_c_stream__())
+    if isinstance(column, (list, tuple)):
+        return [chunk for part in column for chunk in _arrow_chunks(part)]
+    raise TypeError(f"expected an Arrow array, not {type(column).__name__}")
+
+
+def _arrow_valid(validity, bit_offset: int, length: int) -> Optional[numpy.ndarray]:
+    """Return a boolean array of the validity bitmap of a chunk, or None."""
+    if validity is None:
+        return None
+    bits = numpy.unpackbits(validity, count=bit_offset + length, bitorder="little")
+    return bits[bit_offset:].view(bool)
+
+
+def _and(a: Optional[numpy.ndarray], b: Optional[numpy.ndarray]):
+    return a if b is None else b if a is None else a & b
+
+
+def mt2_arrow(
+    *columns,
+    desired_precision_on_mt2: float = 0.0,
+    fields: Optional[Sequence[str]] = None,
+    threads: Optional[int] = None,
+    method: Optional[str] = None,
+) -> ArrowFloat64Array:
+    """
+    Returns asymmetric mT2 for events held in Apache Arrow arrays, without copying.
+
+    Arrays are read through the Arrow C data interface, as views of their buffers,
+    from any object implementing the Arrow PyCapsule interface: a `pyarrow.Array` or
+    `pyarrow.ChunkedArray`, a `pyarrow.RecordBatch` or `pyarrow.Table`, or those of
+    other Arrow libraries. Chunked columns are walked chunk by chunk, even where
+    columns are chunked differently, rather than concatenated. Events with a null in
+    any column are skipped, and are null in the result.
+
+    Args:
+        columns: Either the ten arguments of `mt2` from `m_vis_1` to `m_invis_2`, each
+            a float64 or float32 Arrow array, chunked array, or sequence of chunks, or
+            a number for all events; or a single record batch, table, or struct array
+            whose fields hold them.
+        desired_precision_on_mt2: As for `mt2`, for all events.
+        fields: For a single record batch, the names of the ten fields to use, in the
+            order of the arguments of `mt2`. By default, it must have exactly ten.
+        threads: As for `mt2`.
+        method: As for `mt2`.
+
+    Returns:
+        MT2 calculated for all events, as an ArrowFloat64Array of one chunk.
+    """
+    if len(columns) == 1:
+        chunks = _arrow_chunks(columns[0])
+        if any(chunk[4] is None for chunk in chunks):
+            raise TypeError("expected a record batch, table or struct array")
+        names = fields
+        if names is None:
+            names = [child[0] for child in chunks[0][4]] if chunks else []
+        if len(names) != 10:
+            raise ValueError(f"records must have 10 fields to use, not {len(names)}")
+        # Split each chunk of records into the chunks of its fields.
+        columns = [[] for _ in names]
+        for _, _, validity, bit_offset, children in chunks:
+            children = {child[0]: child for child in children}
+            for name, column in zip(names, columns):
+                if name not in children:
+                    raise ValueError(f"no field named {name!r}")
+                child = children[name]
+                length = len(child[1])
+                valid = _and(
+                    _arrow_valid(validity, bit_offset, length),
+                    _arrow_valid(*child[2:4], length),
+                )
+                column.append((child[1], valid))
+    elif len(columns) == 10:
+        columns = [
+            column
+            if isinstance(column, numbers.Real)
+            else [
+                (values, _arrow_valid(validity, bit_offset, len(values)))
+                for _, values, validity, bit_offset, _ in _arrow_chunks(column)
+            ]
+            for column in columns
+        ]
+    else:
+        raise TypeError(f"expected 1 or 10 columns, not {len(columns)}")
+
+    arrays = [column for column in columns if isinstance(column, list)]
+    if any(chunk[0] is None for column in arrays for chunk in column):
+        raise TypeError("expected arrays of numbers, not struct arrays")
+    lengths = {sum(len(chunk[0]) for chunk in column) for column in arrays}
+    if len(lengths) != 1:
+        raise ValueError("columns must be Arrow arrays of the same length")
+    (n,) = lengths
+    # Each column's chunks are walked together, in pieces ending wherever a chunk of
+    # any column ends.
+    ends = sorted(
+        {
+            end
+            for column in arrays
+            for end in numpy.cumsum([len(chunk[0]) for chunk in column])
+            if end > 0
+        }
+    )
+    values = numpy.full(n, numpy.nan)
+    valid = None
+    positions = [[0, 0] for _ in columns]
+    start = 0
+    for end in ends:
+        args = []
+        piece_valid = None
+        for column, position in zip(columns, positions):
+            if not isinstance(column, list):
+                args.append(column)
+                continue
+            while len(column[position[0]][0]) == position[1]:
+                position[:] = [position[0] + 1, 0]
+            chunk_values, chunk_valid = column[position[0]]
+            piece = slice(position[1], position[1] + end - start)
+            args.append(chunk_values[piece])
+            if chunk_valid is not None:
+                piece_valid = _and(piece_valid, chunk_valid[piece])
+            position[1] += end - start
+        if piece_valid is not None:
+            if valid is None:
+                valid = numpy.ones(n, dtype=bool)
+            valid[start:end] = piece_valid
+        # Null events are skipped within the loop, so that they do not break up the
+        # events filling its SIMD lanes.
+        valid_args = () if piece_valid is None else (piece_valid,)
+        _call(
+            mt2_tombs_ufunc if piece_valid is None else mt2_tombs_valid_ufunc,
+            threads,
+            method,
+            *args,
+            desired_precision_on_mt2,
+            *valid_args,
+            values[start:end],
+            dtype=numpy.float64,
+        )
+        start = end
+    return ArrowFloat64Array(values, valid)
+
+
+def mt2_stream(
+    chunks: Iterable[Any],
+    desired_precision_on_mt2: float = 0.0,
+    *,
+    function: Optional[Callable[..., Any]] = None,
+    write: Optional[Callable[[Any], None]] = None,
+    depth: int = 2,
+    threads: Optional[int] = None,
+    method: Optional[str] = None,
+) -> Optional[Iterator[Any]]:
+    """
+    Computes mT2 of a stream of chunks of events, overlapping reading, computing and
+    writing.
+
+    Chunks are read from `chunks` on one thread, and computed on another, while the
+    results of earlier chunks are written by the caller. Each stage waits only when
+    the queue between it and the next holds `depth` chunks, so while chunk k is
+    computed, chunk k + 1 can be read and chunk k - 1 written, and the stream goes
+    at the pace of the slowest stage rather than of all three together. The GIL is
+    released while computing, as it is by most reading and writing of files.
+
+    Args:
+        chunks: An iterable of chunks, such as a generator reading them from files.
+            Iterating it is the reading stage. A tuple is the arguments of
+            `function`; anything else, such as a record batch, is its only argument.
+        desired_precision_on_mt2: As for `mt2`, for all events.
+        function: The function computing each chunk, called with its arguments and
+            the keyword arguments `desired_precision_on_mt2`, `threads` and `method`:
+            `mt2` by default, or for example `mt2_rows` or `mt2_arrow`.
+        write: If specified, called with the result of each chunk, in order, as the
+            writing stage, before returning None.
+        depth: The number of chunks each queue between stages may hold.
+        threads: As for `mt2`, for computing each chunk.
+        method: As for `mt2`.
+
+    Returns:
+        If `write` is not specified, an iterator over the result of each chunk, in
+        order, whose consumer is the writing stage. Closing it early stops reading.
+    """
+    if depth < 1:
+        raise ValueError(f"depth must be positive, not {depth}")
+    function = mt2 if function is None else function
+
+    def compute(chunk):
+        return function(
+            *(chunk if isinstance(chunk, tuple) else (chunk,)),
+            desired_precision_on_mt2=desired_precision_on_mt2,
+            threads=threads,
+            method=method,
+        )
+
+    results = _pipeline(chunks, compute, depth)
+    if write is None:
+        return results
+    for result in results:
+        write(result)
+    return None
+
+
+# Marks the end of the items on a queue of _pipeline.
+_END = object()
+
+
+class _Failure:
+    """An exception raised in one stage of _pipeline, to be raised in the next."""
+
+    def __init__(self, error: BaseException):
+        self.error = error
+
+
+def _put(items: queue.Queue, item, stop: threading.Event) -> bool:
+    """Put `item` on `items` when there is space, unless `stop` is set first."""
+    while not stop.is_set():
+        try:
+            items.put(item, timeout=0.05)
+            return True
+        except queue.Full:
+            pass
+    return False
+
+
+def _get(items: queue.Queue, stop: threading.Event) -> Iterator[Any]:
+    """Yield the items of `items` until _END or `stop`, raising any _Failure."""
+    while not stop.is_set():
+        try:
+            item = items.get(timeout=0.05)
+        except queue.Empty:
+            continue
+        if item is _END:
+            return
+        if isinstance(item, _Failure):
+            raise item.error
+        yield item
+
+
+def _stage(items: Iterable[Any], function, out: queue.Queue, stop: threading.Event):
+    """Put `function` of each of `items` on `out`, then _END or the _Failure."""
+    try:
+        for item in items:
+            if not _put(out, function(item), stop):
+                return
+    except BaseException as error:
+        _put(out, _Failure(error), stop)
+        return
+    _put(out, _END, stop)
+
+
+def _pipeline(chunks: Iterable[Any], compute, depth: int) -> Iterator[Any]:
+    """Yield `compute` of each of `chunks`, reading and computing on two threads."""
+    stop = threading.Event()
+    read = queue.Queue(depth)
+    computed = queue.Queue(depth)
+    stages = [
+        threading.Thread(target=_stage, args=(chunks, lambda x: x, read, stop)),
+        threading.Thread(
+            target=_stage, args=(_get(read, stop), compute, computed, stop)
+        ),
+    ]
+    for stage in stages:
+        stage.start()
+    try:
+        yield from _get(computed, stop)
+    finally:
+        stop.set()
+        for stage in stages:
+            stage.join()
+
+
+def _call(ufunc, threads: Optional[int], method: Optional[str], *args, **kwargs):
+    """Call `ufunc` with `args`, overriding the threads and method for this call."""
+    previous_method = None if method is None else _set_call_method(method)
+    try:
+        previous_threads = None if threads is None else _set_call_threads(threads)
+        try:
+            return ufunc(*args, **kwargs)
+        finally:
+            if threads is not None:
+                _set_call_threads(previous_threads)
+    finally:
+        if method is not None:
+            _set_call_method(previous_method)
+
+
 mt2_ufunc = mt2_tombs_ufunc
 
 
@@ -1,3 +1,5 @@
+import numpy
+
 from mt2._mt2 import mt2_lally_ufunc, mt2_lester_ufunc, mt2_tombs_ufunc
 
 
@@ -20,3 +22,21 @@ def mt2_lester(
 
 def mt2_tombs(*args, desired_precision_on_mt2=0.0, out=None):
     return mt2_tombs_ufunc(*args, desired_precision_on_mt2, out)
+
+
+def random_args(n, seed=42, degenerate=False):
+    """
+    Return the ten arguments of `mt2` for `n` random events, seeding numpy.random.
+
+    If `degenerate`, some events have near-massless visible particles, and some
+    massless invisible particles.
+    """
+    numpy.random.seed(seed)
+    args = [numpy.random.uniform(-100, 100, n) for _ in range(10)]
+    for i in (0, 3, 8, 9):
+        args[i] = numpy.abs(args[i])
+    if degenerate:
+        args[3][::7] *= 1e-9
+        args[8][::11] = 0.0
+        args[9][::11] = 0.0
+    return args
@@ -0,0 +1,23 @@
+/* A second translation unit including the headers; see test_headers.cpp. */
+#include <mt2/mt2.h>
+
+double
+second_unit_mt2(const double args[10])
+{
+    return mt2::mt2(args[0], args[1], args[2], args[3], args[4], args[5],
+                    args[6], args[7], args[8], args[9]);
+}
+
+double
+second_unit_lester(const double args[10])
+{
+    return mt2::lester(args[0], args[1], args[2], args[3], args[4], args[5],
+                       args[6], args[7], args[8], args[9]);
+}
+
+double
+second_unit_lally(const double args[10])
+{
+    return mt2::lally(args[0], args[1], args[2], args[3], args[4], args[5],
+                      args[6], args[7], args[8], args[9]);
+}
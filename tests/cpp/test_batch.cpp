@@ -0,0 +1,229 @@
+/*
+ * Tests of mt2_batch, the command-line driver, whose path is the argument.
+ *
+ * Columns are written as .npy and raw files, and the results read back are
+ * compared with those of mt2_batch_f64 in this process.
+ */
+
+/*
+ * Includes
+ *
+ * cmath
+ *     std::fabs
+ * cstdio
+ *     std::fopen, std::fwrite, std::fread, std::printf
+ * cstdlib
+ *     std::system
+ * cstring
+ *     std::memcmp
+ * string
+ *     std::string
+ * vector
+ *     std::vector
+ * stdlib.h
+ *     mkdtemp
+ */
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <stdlib.h>
+
+#include <mt2/mt2_c.h>
+
+
+static int failures = 0;
+
+static void
+check(bool condition, const std::string &what)
+{
+    if (!condition) {
+        std::printf("FAIL: %s\n", what.c_str());
+        ++failures;
+    }
+}
+
+/* Return a uniform double in [0, 1) from a 64-bit LCG, as in the examples. */
+static double
+uniform(unsigned long long *state)
+{
+    *state = *state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (double)(*state >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static void
+write_file(const std::string &path, const std::string &header, const void *data,
+           std::size_t size)
+{
+    std::FILE *file = std::fopen(path.c_str(), "wb");
+    std::fwrite(header.data(), 1, header.size(), file);
+    std::fwrite(data, 1, size, file);
+    std::fclose(file);
+}
+
+/* Write `values' as a version 1.0 .npy file of dtype `descr'. */
+template <typename T>
+static void
+write_npy(const std::string &path, const char *descr, const std::vector<T> &values)
+{
+    std::string dict = std::string("{'descr': '") + descr
+                       + "', 'fortran_order': False, 'shape': ("
+                       + std::to_string(values.size()) + ",), }";
+    dict.append((64 - (10 + dict.size() + 1) % 64) % 64, ' ');
+    dict += '\n';
+    const std::string header = std::string("\x93NUMPY\x01\x00", 8)
+                               + (char)(dict.size() & 0xff) + (char)(dict.size() >> 8)
+                               + dict;
+    write_file(path, header, values.data(), values.size() * sizeof(T));
+}
+
+/* Read the values of a float64 .npy file, or none if it is not one. */
+static std::vector<double>
+read_npy(const std::string &path)
+{
+    std::vector<double> values;
+    std::FILE *file = std::fopen(path.c_str(), "rb");
+    if (!file)
+        return values;
+    std::vector<char> bytes;
+    char buffer[65536];
+    for (std::size_t n; (n = std::fread(buffer, 1, sizeof(buffer), file)) > 0;)
+        bytes.insert(bytes.end(), buffer, buffer + n);
+    std::fclose(file);
+    if (bytes.size() < 10 || std::memcmp(bytes.data(), "\x93NUMPY\x01\x00", 8) != 0)
+        return values;
+    const std::size_t offset =
+        10 + ((unsigned char)bytes[8] | (std::size_t)(unsigned char)bytes[9] << 8);
+    const std::string header(bytes.data() + 10, offset - 10);
+    if (offset % 64 != 0 || header.find("'<f8'") == std::string::npos)
+        return values;
+    values.resize((bytes.size() - offset) / sizeof(double));
+    std::memcpy(values.data(), bytes.data() + offset, values.size() * sizeof(double));
+    return values;
+}
+
+#define N_EVENTS 5000
+
+int
+main(int argc, char **argv)
+{
+    if (argc != 2) {
+        std::printf("usage: %s path/to/mt2_batch\n", argv[0]);
+        return 1;
+    }
+    char directory_template[] = "/tmp/mt2_batch_XXXXXX";
+    const std::string directory = mkdtemp(directory_template);
+    const std::string driver = std::string("'") + argv[1] + "'";
+
+    /* Events like those of test_c_api.c. */
+    std::vector<std::vector<double>> columns(10, std::vector<double>(N_EVENTS));
+    unsigned long long state = 42;
+    for (std::size_t i = 0; i < N_EVENTS; ++i) {
+        for (int j = 0; j < 10; ++j) {
+            double x = 200 * uniform(&state) - 100;
+            if (j == 0 || j == 3 || j == 8 || j == 9)
+                x = std::fabs(x);
+            columns[j][i] = x;
+        }
+    }
+
+    /* px_vis_2 is float32, px_miss raw float64, and m_invis_2 a number; the
+     * rest are float64 .npy files. py_miss is rounded to float32 for later. */
+    std::vector<float> px_vis_2(columns[4].begin(), columns[4].end());
+    std::vector<float> py_miss(columns[7].begin(), columns[7].end());
+    for (std::size_t i = 0; i < N_EVENTS; ++i) {
+        columns[4][i] = px_vis_2[i];
+        columns[7][i] = py_miss[i];
+        columns[9][i] = 12.5;
+    }
+    const char *names[10] = {"m_vis_1", "px_vis_1", "py_vis_1", "m_vis_2", "px_vis_2",
+                             "py_vis_2", "px_miss", "py_miss", "m_invis_1", "m_invis_2"};
+    std::string arguments;
+    for (int j = 0; j < 10; ++j) {
+        const std::string path = directory + "/" + names[j];
+        if (j == 4)
+            write_npy(path, "<f4", px_vis_2);
+        else if (j == 6)
+            write_file(path, "", columns[j].data(), N_EVENTS * sizeof(double));
+        else if (j != 9)
+            write_npy(path, "<f8", columns[j]);
+        arguments += std::string(" ") + names[j] + "="
+                     + (j == 9 ? std::string("12.5") : path);
+    }
+    const std::string out = directory + "/out.npy";
+
+    std::vector<double> expected(N_EVENTS);
+    mt2_options options;
+    mt2_options_init(&options);
+    const double *in[10];
+    for (int j = 0; j < 10; ++j)
+        in[j] = columns[j].data();
+    mt2_batch_f64(in[0], in[1], in[2], in[3], in[4], in[5], in[6], in[7], in[8], in[9],
+                  N_EVENTS, expected.data(), &options);
+
+    const std::string command = driver + arguments + " -o " + out;
+    int status = std::system((command + " -c 999 -j 2 > /dev/null 2>&1").c_str());
+    check(status == 0, "driver succeeds");
+    check(read_npy(out) == expected, "results match mt2_batch_f64 in chunks");
+
+    status = std::system((command + " -s 1234 -n 2000 > /dev/null 2>&1").c_str());
+    check(status == 0, "driver succeeds on a range");
+    check(read_npy(out)
+              == std::vector<double>(expected.begin() + 1234, expected.begin() + 3234),
+          "results of a range");
+
+    status = std::system((command + " -s 4000 -n 2000 -c 1 > /dev/null 2>&1").c_str());
+    check(status == 0, "driver succeeds on a range past the end");
+    check(read_npy(out) == std::vector<double>(expected.begin() + 4000, expected.end()),
+          "range is clipped to the end");
+
+    /* -t applies to every raw file, so py_miss is raw float32 only where
+     * px_miss is given as a number, which overrides the file given before. */
+    write_file(directory + "/py_miss", "", py_miss.data(), N_EVENTS * sizeof(float));
+    status = std::system((driver + arguments + " px_miss=-20 -t f4 -o " + out
+                          + " > /dev/null 2>&1")
+                             .c_str());
+    check(status == 0, "driver succeeds with raw float32");
+    std::vector<double> px_miss(N_EVENTS, -20.0);
+    mt2_batch_f64(in[0], in[1], in[2], in[3], in[4], in[5], px_miss.data(), in[7], in[8],
+                  in[9], N_EVENTS, expected.data(), &options);
+    check(read_npy(out) == expected, "results with raw float32");
+
+    /* Mismatched lengths, and missing or unknown arguments, are errors. */
+    write_npy(directory + "/short", "<f8", std::vector<double>(10, 1.0));
+    const char *bad[] = {" m_vis_1=", " m_invis_1=", " unknown=1"};
+    for (const char *argument : bad) {
+        const std::string value = std::string(argument).back() == '=' ? directory + "/short"
+                                                                      : "";
+        status = std::system((driver + arguments + argument + value + " -t f4 -o " + out
+                              + " 2> /dev/null")
+                                 .c_str());
+        check(status != 0, std::string("error for") + argument);
+    }
+    status = std::system((driver + " m_vis_1=1 -o " + out + " 2> /dev/null").c_str());
+    check(status != 0, "error for missing columns");
+
+    /* Options must be numbers in range, with nothing left over. py_miss is
+     * raw float32 by now, as above. */
+    const std::string raw = driver + arguments + " px_miss=-20 -t f4 -o " + out;
+    status = std::system((raw + " -c 100 -j 0 -p 0 -s 5 -n 10 > /dev/null 2>&1").c_str());
+    check(status == 0, "driver succeeds with every numeric option");
+    check(read_npy(out) == std::vector<double>(expected.begin() + 5, expected.begin() + 15),
+          "results with every numeric option");
+    const char *bad_options[] = {
+        " -c 10x", " -c -1", " -c ''", " -j 2.5", " -j x", " -j 9999999999",
+        " -p 1e-3y", " -p ''", " -p 1e999", " -s 12z", " -s -5", " -n 1e3",
+        " -n 99999999999999999999"};
+    for (const char *option : bad_options) {
+        status = std::system((raw + option + " > /dev/null 2>&1").c_str());
+        check(status != 0, std::string("error for") + option);
+    }
+
+    std::system(("rm -r '" + directory + "'").c_str());
+    if (failures == 0)
+        std::printf("OK\n");
+    return failures == 0 ? 0 : 1;
+}
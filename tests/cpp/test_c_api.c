@@ -0,0 +1,165 @@
+/*
+ * Tests of the C interface of libmt2, in mt2_c.h, called from C.
+ */
+
+/*
+ * Includes
+ *
+ * math.h
+ *     fabs, isnan, NAN
+ * stdio.h
+ *     printf
+ * stdlib.h
+ *     malloc, free
+ * string.h
+ *     memcmp
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <mt2/mt2_c.h>
+
+
+static int failures = 0;
+
+static void
+check(int condition, const char *what)
+{
+    if (!condition) {
+        printf("FAIL: %s\n", what);
+        ++failures;
+    }
+}
+
+/* Return a uniform double in [0, 1) from a 64-bit LCG, as in the examples. */
+static double
+uniform(unsigned long long *state)
+{
+    *state = *state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (double)(*state >> 11) * (1.0 / 9007199254740992.0);
+}
+
+#define N_EVENTS 5000
+
+int
+main(void)
+{
+    /* Events like those of the Python tests, with some near-massless. */
+    static double columns[10][N_EVENTS];
+    static float columns_f32[10][N_EVENTS];
+    static double out[N_EVENTS], out_threads[N_EVENTS], out_brent[N_EVENTS];
+    static float out_f32[N_EVENTS];
+    unsigned long long state = 42;
+    mt2_options options;
+    size_t i;
+    int j;
+
+    for (i = 0; i < N_EVENTS; ++i) {
+        for (j = 0; j < 10; ++j) {
+            double x = 200 * uniform(&state) - 100;
+            if (j == 0 || j == 3 || j == 8 || j == 9)
+                x = fabs(x);
+            columns[j][i] = x;
+        }
+        if (i % 7 == 0)
+            columns[3][i] *= 1e-9;
+        for (j = 0; j < 10; ++j)
+            columns_f32[j][i] = (float)columns[j][i];
+    }
+    columns[1][3] = NAN;
+
+    check(mt2_abi_version() == MT2_ABI_VERSION, "ABI version");
+    check(mt2_isa() != NULL && mt2_isa()[0] != '\0', "ISA name");
+    check(fabs(mt2_f64(100, 410, 20, 150, -210, -300, -200, 280, 100, 100, 0)
+               - 412.627668458219) < 1e-9,
+          "scalar example");
+
+#define ARGS(c) c[0], c[1], c[2], c[3], c[4], c[5], c[6], c[7], c[8], c[9]
+    check(mt2_batch_f64(ARGS(columns), N_EVENTS, out, NULL) == MT2_OK,
+          "batch");
+    for (i = 0; i < N_EVENTS; ++i) {
+        const double expected = mt2_f64(
+            columns[0][i], columns[1][i], columns[2][i], columns[3][i],
+            columns[4][i], columns[5][i], columns[6][i], columns[7][i],
+            columns[8][i], columns[9][i], 0);
+        if (isnan(expected) ? !isnan(out[i])
+                            : fabs(out[i] - expected) > 1e-12 * expected) {
+            check(0, "batch agrees with scalar");
+            break;
+        }
+    }
+    check(isnan(out[3]), "NAN input");
+
+    mt2_options_init(&options);
+    options.threads = 3;
+    check(mt2_batch_f64(ARGS(columns), N_EVENTS, out_threads, &options)
+              == MT2_OK,
+          "batch with threads");
+    check(memcmp(out, out_threads, sizeof(out)) == 0,
+          "threads give identical results");
+
+    options.method = MT2_METHOD_BRENT;
+    check(mt2_batch_f64(ARGS(columns), N_EVENTS, out_brent, &options)
+              == MT2_OK,
+          "batch with brent");
+    for (i = 0; i < N_EVENTS; ++i) {
+        if (i != 3 && fabs(out_brent[i] - out[i]) > 1e-12 * out[i]) {
+            check(0, "brent agrees with bisection");
+            break;
+        }
+    }
+
+    check(mt2_batch_f32(ARGS(columns_f32), N_EVENTS, out_f32, NULL) == MT2_OK,
+          "batch in float");
+    for (i = 0; i < N_EVENTS; ++i) {
+        const float expected = (float)mt2_f64(
+            columns_f32[0][i], columns_f32[1][i], columns_f32[2][i],
+            columns_f32[3][i], columns_f32[4][i], columns_f32[5][i],
+            columns_f32[6][i], columns_f32[7][i], columns_f32[8][i],
+            columns_f32[9][i], 0);
+        if (fabs(out_f32[i] - expected) > 1e-6 * expected) {
+            check(0, "float batch agrees with scalar");
+            break;
+        }
+    }
+
+    /* Invalid arguments leave the output untouched. */
+    mt2_options_init(&options);
+    options.method = 2;
+    out[0] = -1;
+    check(mt2_batch_f64(ARGS(columns), N_EVENTS, out, &options)
+              == MT2_ERROR_OPTIONS && out[0] == -1,
+          "invalid method");
+    mt2_options_init(&options);
+    options.precision = -1;
+    check(mt2_batch_f64(ARGS(columns), N_EVENTS, out, &options)
+              == MT2_ERROR_OPTIONS,
+          "invalid precision");
+    check(mt2_batch_f64(columns[0], NULL, columns[2], columns[3], columns[4],
+                        columns[5], columns[6], columns[7], columns[8],
+                        columns[9], N_EVENTS, out, NULL)
+              == MT2_ERROR_NULL,
+          "NULL array");
+    check(mt2_batch_f64(NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+                        NULL, 0, NULL, NULL)
+              == MT2_OK,
+          "empty batch");
+
+    /* Callers compiled against a smaller mt2_options get defaults. */
+    mt2_options_init(&options);
+    options.size = sizeof(size_t) + sizeof(double);
+    options.method = 2;
+    check(mt2_batch_f64(ARGS(columns), N_EVENTS, out_threads, &options)
+              == MT2_OK,
+          "older options");
+    options.size = 0;
+    check(mt2_batch_f64(ARGS(columns), N_EVENTS, out_threads, &options)
+              == MT2_ERROR_OPTIONS,
+          "zero size");
+
+    if (!failures)
+        printf("OK\n");
+    return failures ? 1 : 0;
+}
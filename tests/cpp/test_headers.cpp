@@ -0,0 +1,94 @@
+/*
+ * Tests of the C++ interface in mt2.h, compiled together with
+ * second_unit.cpp so that any definition made twice fails to link.
+ */
+
+/*
+ * Includes
+ *
+ * cmath
+ *     std::fabs, std::isnan
+ * cstdio
+ *     std::printf
+ * limits
+ *     std::numeric_limits
+ */
+#include <cmath>
+#include <cstdio>
+#include <limits>
+
+#include <mt2/mt2.h>
+
+
+double second_unit_mt2(const double args[10]);
+double second_unit_lester(const double args[10]);
+double second_unit_lally(const double args[10]);
+
+static int failures = 0;
+
+static void
+check(bool condition, const char *what)
+{
+    if (!condition) {
+        std::printf("FAIL: %s\n", what);
+        ++failures;
+    }
+}
+
+static bool
+close(double x, double y, double tolerance)
+{
+    return std::fabs(x - y) <= tolerance * std::fabs(y);
+}
+
+
+int
+main()
+{
+    /* The example of the README, and of tests/test_mt2.py. */
+    const double a[10] = {100, 410, 20, 150, -210, -300, -200, 280, 100, 100};
+    const double expected = 412.627668458219;
+
+    const double result = mt2::mt2(a[0], a[1], a[2], a[3], a[4], a[5], a[6],
+                                   a[7], a[8], a[9]);
+    check(close(result, expected, 1e-12), "mt2");
+    check(second_unit_mt2(a) == result, "mt2 in the second unit");
+    check(close(second_unit_lester(a), expected, 1e-12), "lester");
+    check(close(second_unit_lally(a), expected, 1e-9), "lally");
+
+    const float single = mt2::mt2<float>(100, 410, 20, 150, -210, -300, -200,
+                                         280, 100, 100);
+    check(close(single, expected, 1e-6), "mt2 in float");
+
+    mt2::diagnostics diagnostics;
+    const double brent = mt2::brent(a[0], a[1], a[2], a[3], a[4], a[5], a[6],
+                                    a[7], a[8], a[9], 0.0, &diagnostics);
+    check(close(brent, expected, 1e-12), "brent");
+    check(diagnostics.status == mt2_status_ok && diagnostics.tests > 0,
+          "brent diagnostics");
+    mt2::diagnose(0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0,
+                  &diagnostics);
+    check(diagnostics.status == mt2_status_zero, "diagnose zero");
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    check(std::isnan(mt2::diagnose(a[0], nan, a[2], a[3], a[4], a[5], a[6],
+                                   a[7], a[8], a[9], 0.0, &diagnostics))
+          && diagnostics.status == mt2_status_nan_input,
+          "diagnose NAN");
+
+    check(mt2::above(a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7], a[8],
+                     a[9], 412.6),
+          "above below mt2");
+    check(!mt2::above(a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7], a[8],
+                      a[9], 412.7),
+          "above above mt2");
+
+    double lo, hi;
+    const int tests = mt2::bracket(a[0], a[1], a[2], a[3], a[4], a[5], a[6],
+                                   a[7], a[8], a[9], 8, &lo, &hi);
+    check(tests <= 8 && lo <= expected && expected <= hi && lo < hi,
+          "bracket");
+
+    if (!failures)
+        std::printf("OK\n");
+    return failures ? 1 : 0;
+}
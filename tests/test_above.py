@@ -0,0 +1,71 @@
+"""Tests for testing whether mt2 is above a threshold."""
+
+import unittest
+
+import numpy
+
+from mt2 import mt2, mt2_above
+from tests.common import random_args
+
+
+class TestAbove(unittest.TestCase):
+    def setUp(self):
+        self.args = random_args(20000, degenerate=True)
+        self.expected = mt2(*self.args)
+
+    def test_matches_mt2(self):
+        for threshold in (-1.0, 0.0, 50.0, 100.0, 150.0, 200.0, 300.0):
+            result = mt2_above(*self.args, threshold)
+            self.assertEqual(result.dtype, numpy.bool_)
+            numpy.testing.assert_array_equal(
+                result, self.expected > threshold, err_msg=str(threshold)
+            )
+
+    def test_threshold_per_event(self):
+        thresholds = numpy.random.uniform(0, 250, len(self.expected))
+        numpy.testing.assert_array_equal(
+            mt2_above(*self.args, thresholds), self.expected > thresholds
+        )
+
+    def test_near_mt2(self):
+        # Either side of mt2, by more than its precision.
+        numpy.testing.assert_array_equal(
+            mt2_above(*self.args, self.expected * (1 - 1e-9)), self.expected > 0
+        )
+        self.assertFalse(mt2_above(*self.args, self.expected * (1 + 1e-9)).any())
+
+    def test_scalar(self):
+        args = (100, 410, 20, 150, -210, -300, -200, 280, 100, 100)
+        self.assertIs(bool(mt2_above(*args, 412.6)), True)
+        self.assertIs(bool(mt2_above(*args, 412.7)), False)
+
+    def test_zero_and_nan(self):
+        zero = (0.0,) * 10
+        self.assertTrue(mt2_above(*zero, -1.0))
+        self.assertFalse(mt2_above(*zero, 0.0))
+
+        args = [arg[:20].copy() for arg in self.args]
+        args[0][3] = numpy.nan
+        args[6][5] = numpy.inf
+        with numpy.errstate(invalid="ignore"):
+            expected = mt2(*args) > 10.0
+            numpy.testing.assert_array_equal(mt2_above(*args, 10.0), expected)
+            self.assertFalse(mt2_above(*args, numpy.nan).any())
+
+    def test_float32(self):
+        args = [arg.astype(numpy.float32) for arg in self.args]
+        expected = mt2(*args)
+        for threshold in (50.0, 150.0):
+            numpy.testing.assert_array_equal(
+                mt2_above(*args, numpy.float32(threshold)), expected > threshold
+            )
+
+    def test_threads_and_out(self):
+        out = numpy.empty(len(self.expected), dtype=numpy.bool_)
+        result = mt2_above(*self.args, 150.0, out=out, threads=3)
+        self.assertIs(result, out)
+        numpy.testing.assert_array_equal(out, self.expected > 150.0)
+
+
+if __name__ == "__main__":
+    unittest.main()
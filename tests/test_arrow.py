@@ -0,0 +1,279 @@
+"""Tests for evaluating mt2 on Apache Arrow arrays."""
+
+import ctypes
+import unittest
+
+import numpy
+
+from mt2 import ArrowFloat64Array, mt2, mt2_arrow
+from tests.common import random_args
+
+try:
+    import pyarrow
+except ImportError:
+    pyarrow = None
+
+FIELDS = (
+    "m_vis_1",
+    "px_vis_1",
+    "py_vis_1",
+    "m_vis_2",
+    "px_vis_2",
+    "py_vis_2",
+    "px_miss",
+    "py_miss",
+    "m_invis_1",
+    "m_invis_2",
+)
+
+
+def _chunks(values, ends, valid=None):
+    """Return `values` as a list of chunks ending at each of `ends`."""
+    starts = [0] + list(ends[:-1])
+    return [
+        ArrowFloat64Array(values[a:b], None if valid is None else valid[a:b])
+        for a, b in zip(starts, ends)
+    ]
+
+
+class _ArrowSchema(ctypes.Structure):
+    pass
+
+
+class _ArrowArray(ctypes.Structure):
+    pass
+
+
+_RELEASE_SCHEMA = ctypes.CFUNCTYPE(None, ctypes.POINTER(_ArrowSchema))
+_RELEASE_ARRAY = ctypes.CFUNCTYPE(None, ctypes.POINTER(_ArrowArray))
+
+_ArrowSchema._fields_ = [
+    ("format", ctypes.c_char_p),
+    ("name", ctypes.c_char_p),
+    ("metadata", ctypes.c_char_p),
+    ("flags", ctypes.c_int64),
+    ("n_children", ctypes.c_int64),
+    ("children", ctypes.POINTER(ctypes.POINTER(_ArrowSchema))),
+    ("dictionary", ctypes.POINTER(_ArrowSchema)),
+    ("release", _RELEASE_SCHEMA),
+    ("private_data", ctypes.c_void_p),
+]
+_ArrowArray._fields_ = [
+    ("length", ctypes.c_int64),
+    ("null_count", ctypes.c_int64),
+    ("offset", ctypes.c_int64),
+    ("n_buffers", ctypes.c_int64),
+    ("n_children", ctypes.c_int64),
+    ("buffers", ctypes.POINTER(ctypes.c_void_p)),
+    ("children", ctypes.POINTER(ctypes.POINTER(_ArrowArray))),
+    ("dictionary", ctypes.POINTER(_ArrowArray)),
+    ("release", _RELEASE_ARRAY),
+    ("private_data", ctypes.c_void_p),
+]
+
+
+@_RELEASE_SCHEMA
+def _release_schema(schema):
+    schema.contents.release = _RELEASE_SCHEMA()
+
+
+@_RELEASE_ARRAY
+def _release_array(array):
+    array.contents.release = _RELEASE_ARRAY()
+
+
+_capsule_new = ctypes.pythonapi.PyCapsule_New
+_capsule_new.restype = ctypes.py_object
+_capsule_new.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_void_p]
+
+
+class _HandBuiltStruct:
+    """A struct of float64 fields exported by hand through the C data interface."""
+
+    def __init__(self, columns, length, offset=0):
+        self.columns = [numpy.ascontiguousarray(column, numpy.float64) for column in columns]
+        n = len(self.columns)
+        self.schemas = [
+            _ArrowSchema(b"g", name.encode(), None, 0, 0, None, None, _release_schema)
+            for name in FIELDS[:n]
+        ]
+        self.buffers = [
+            (ctypes.c_void_p * 2)(None, column.ctypes.data) for column in self.columns
+        ]
+        self.arrays = [
+            _ArrowArray(len(column), 0, 0, 2, 0, buffers, None, None, _release_array)
+            for column, buffers in zip(self.columns, self.buffers)
+        ]
+        self.schema_children = (ctypes.POINTER(_ArrowSchema) * n)(
+            *(ctypes.pointer(schema) for schema in self.schemas)
+        )
+        self.array_children = (ctypes.POINTER(_ArrowArray) * n)(
+            *(ctypes.pointer(array) for array in self.arrays)
+        )
+        self.schema = _ArrowSchema(
+            b"+s", b"", None, 0, n, self.schema_children, None, _release_schema
+        )
+        self.struct_buffers = (ctypes.c_void_p * 1)(None)
+        self.array = _ArrowArray(
+            length, 0, offset, 1, n, self.struct_buffers, self.array_children, None,
+            _release_array,
+        )
+
+    def __arrow_c_array__(self, requested_schema=None):
+        return (
+            _capsule_new(ctypes.addressof(self.schema), b"arrow_schema", None),
+            _capsule_new(ctypes.addressof(self.array), b"arrow_array", None),
+        )
+
+
+class TestArrow(unittest.TestCase):
+    def test_matches_mt2(self):
+        args = random_args(1000)
+        result = mt2_arrow(*[ArrowFloat64Array(arg) for arg in args])
+        self.assertIsInstance(result, ArrowFloat64Array)
+        self.assertIsNone(result.valid)
+        self.assertEqual(result.null_count, 0)
+        numpy.testing.assert_array_equal(result.values, mt2(*args))
+
+    def test_nulls(self):
+        args = random_args(1000)
+        valid_1, valid_2 = numpy.random.uniform(size=(2, 1000)) < 0.9
+        columns = [ArrowFloat64Array(arg) for arg in args]
+        columns[1] = ArrowFloat64Array(args[1], valid_1)
+        columns[7] = ArrowFloat64Array(args[7], valid_2)
+        result = mt2_arrow(*columns)
+        valid = valid_1 & valid_2
+        numpy.testing.assert_array_equal(result.valid, valid)
+        self.assertEqual(result.null_count, numpy.sum(~valid))
+        self.assertTrue(numpy.isnan(result.values[~valid]).all())
+        numpy.testing.assert_array_equal(result.values[valid], mt2(*args)[valid])
+
+    def test_chunks(self):
+        # Each column is chunked differently, including an empty chunk.
+        args = random_args(1000)
+        valid = numpy.random.uniform(size=1000) < 0.5
+        columns = [_chunks(arg, [100 * k + 100, 1000]) for k, arg in enumerate(args)]
+        columns[4] = _chunks(args[4], [0, 333, 334, 1000], valid)
+        columns[9] = 20.0
+        result = mt2_arrow(*columns)
+        expected = mt2(*args[:9], 20.0)
+        numpy.testing.assert_array_equal(result.valid, valid)
+        numpy.testing.assert_array_equal(result.values[valid], expected[valid])
+
+    def test_export(self):
+        # The result is itself an Arrow array, whose nulls are read back.
+        args = random_args(100)
+        valid = numpy.arange(100) % 3 != 0
+        columns = [ArrowFloat64Array(arg) for arg in args[:9]]
+        result = mt2_arrow(*columns, ArrowFloat64Array(args[9], valid))
+        again = mt2_arrow(*columns, result)
+        numpy.testing.assert_array_equal(again.valid, valid)
+        numpy.testing.assert_array_equal(
+            again.values[valid], mt2(*args[:9], result.values)[valid]
+        )
+
+    def test_precision_threads_and_method(self):
+        args = random_args(5000)
+        columns = [_chunks(arg, [2500, 5000]) for arg in args]
+        expected = mt2(*args)
+        result = mt2_arrow(*columns, threads=4)
+        numpy.testing.assert_array_equal(result.values, expected)
+        result = mt2_arrow(*columns, desired_precision_on_mt2=1e-3, method="brent")
+        numpy.testing.assert_allclose(result.values, expected, rtol=2e-3)
+
+    def test_invalid(self):
+        args = random_args(10)
+        columns = [ArrowFloat64Array(arg) for arg in args]
+        with self.assertRaises(TypeError):
+            mt2_arrow(*columns[:9])
+        with self.assertRaises(TypeError):
+            mt2_arrow(*columns[:9], args[9])
+        with self.assertRaises(ValueError):
+            mt2_arrow(*columns[:9], ArrowFloat64Array(args[9][:5]))
+        with self.assertRaises(ValueError):
+            mt2_arrow(*[1.0] * 10)
+
+    def test_hand_built(self):
+        args = random_args(10)
+        result = mt2_arrow(_HandBuiltStruct(args, 10))
+        numpy.testing.assert_array_equal(result.values, mt2(*args))
+        result = mt2_arrow(_HandBuiltStruct(args, 6, offset=4))
+        numpy.testing.assert_array_equal(result.values, mt2(*args)[4:])
+
+    def test_hand_built_invalid(self):
+        args = random_args(10)
+        # A child shorter than its parent, whether by its own length or by the
+        # parent's offset.
+        short = list(args)
+        short[3] = short[3][:5]
+        for struct in (
+            _HandBuiltStruct(short, 10),
+            _HandBuiltStruct(args, 10, offset=1),
+            _HandBuiltStruct(args, -1),
+            _HandBuiltStruct(args, 0, offset=-1),
+        ):
+            with self.assertRaises(ValueError):
+                mt2_arrow(struct)
+
+
+@unittest.skipIf(pyarrow is None, "pyarrow is not installed")
+class TestPyArrow(unittest.TestCase):
+    def test_arrays(self):
+        args = random_args(1000)
+        valid = numpy.random.uniform(size=1000) < 0.9
+        columns = [pyarrow.array(arg) for arg in args]
+        # Chunked, and sliced so that arrays and their bitmaps start at an offset.
+        columns[2] = pyarrow.chunked_array([args[2][:10], args[2][10:]])
+        columns[5] = pyarrow.array(
+            numpy.concatenate([[0.0] * 3, args[5]]), mask=~numpy.r_[[True] * 3, valid]
+        )[3:]
+        result = mt2_arrow(*columns)
+        numpy.testing.assert_array_equal(result.valid, valid)
+        numpy.testing.assert_array_equal(result.values[valid], mt2(*args)[valid])
+
+        array = pyarrow.array(result)
+        self.assertEqual(array.type, pyarrow.float64())
+        self.assertEqual(array.null_count, numpy.sum(~valid))
+        is_valid = array.is_valid().to_numpy(zero_copy_only=False)
+        numpy.testing.assert_array_equal(is_valid, valid)
+        # The buffer is shared rather than copied.
+        self.assertEqual(array.buffers()[1].address, result.values.ctypes.data)
+
+    def test_float32(self):
+        args = [arg.astype(numpy.float32) for arg in random_args(300)]
+        result = mt2_arrow(*[pyarrow.array(arg) for arg in args])
+        self.assertEqual(result.values.dtype, numpy.float64)
+        expected = mt2(*[arg.astype(numpy.float64) for arg in args])
+        numpy.testing.assert_array_equal(result.values, expected)
+
+    def test_record_batches(self):
+        args = random_args(1000)
+        valid = numpy.random.uniform(size=1000) < 0.9
+        columns = dict(zip(FIELDS, (pyarrow.array(arg) for arg in args)))
+        columns["px_miss"] = pyarrow.array(args[6], mask=~valid)
+        table = pyarrow.table(columns)
+        batches = table.to_batches(max_chunksize=300)
+        expected = mt2(*args)
+
+        result = mt2_arrow(batches[0])
+        numpy.testing.assert_array_equal(result.valid, valid[:300])
+        numpy.testing.assert_array_equal(
+            result.values[valid[:300]], expected[:300][valid[:300]]
+        )
+        for records in (pyarrow.Table.from_batches(batches), batches):
+            result = mt2_arrow(records)
+            numpy.testing.assert_array_equal(result.valid, valid)
+            numpy.testing.assert_array_equal(result.values[valid], expected[valid])
+
+        extra = table.append_column("weight", pyarrow.array(numpy.ones(1000)))
+        with self.assertRaises(ValueError):
+            mt2_arrow(extra)
+        result = mt2_arrow(extra.select(list(FIELDS)[::-1] + ["weight"]), fields=FIELDS)
+        numpy.testing.assert_array_equal(result.values[valid], expected[valid])
+
+    def test_unsupported(self):
+        args = random_args(10)
+        columns = [pyarrow.array(arg) for arg in args]
+        for column in (pyarrow.array(numpy.arange(10)), pyarrow.table({"a": args[0]})):
+            with self.assertRaises(TypeError):
+                mt2_arrow(*columns[:9], column)
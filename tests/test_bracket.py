@@ -0,0 +1,99 @@
+"""Tests for bracketing mt2 with a limited number of disjointness tests."""
+
+import unittest
+
+import numpy
+
+from mt2 import mt2, mt2_bracket
+from tests.common import random_args
+
+
+class TestBracket(unittest.TestCase):
+    def setUp(self):
+        self.args = random_args(20000, degenerate=True)
+        self.expected = mt2(*self.args)
+
+    def assert_brackets(self, lo, hi, expected, rtol=1e-13):
+        lo = numpy.asarray(lo, dtype=numpy.float64)
+        hi = numpy.asarray(hi, dtype=numpy.float64)
+        self.assertTrue((lo <= hi).all())
+        self.assertTrue((lo <= expected * (1 + rtol)).all())
+        self.assertTrue((expected <= hi * (1 + rtol)).all())
+
+    def test_certified(self):
+        previous_width = numpy.inf
+        for max_tests in (0, 1, 2, 4, 8, 16, 32):
+            lo, hi = mt2_bracket(*self.args, max_tests)
+            self.assert_brackets(lo, hi, self.expected)
+            # Each test halves the bracket.
+            width = numpy.max(hi - lo)
+            self.assertLessEqual(width, previous_width)
+            previous_width = width
+
+    def test_full_precision(self):
+        lo, hi = mt2_bracket(*self.args, 1000)
+        numpy.testing.assert_allclose(lo, self.expected, rtol=1e-12, atol=0)
+        numpy.testing.assert_allclose(hi, self.expected, rtol=1e-12, atol=0)
+
+    def test_max_tests_per_event(self):
+        max_tests = numpy.arange(len(self.expected)) % 3 * 10
+        lo, hi = mt2_bracket(*self.args, max_tests)
+        self.assert_brackets(lo, hi, self.expected)
+        for k in (0, 10, 20):
+            mask = max_tests == k
+            expected_lo, expected_hi = mt2_bracket(
+                *(arg[mask] for arg in self.args), k
+            )
+            numpy.testing.assert_array_equal(lo[mask], expected_lo)
+            numpy.testing.assert_array_equal(hi[mask], expected_hi)
+
+    def test_large_and_negative_max_tests(self):
+        # Budgets beyond the range of an int are not truncated.
+        expected = mt2_bracket(*self.args, 1000)
+        for max_tests in (2**31, 2**32 + 1, 2**62):
+            lo, hi = mt2_bracket(*self.args, max_tests)
+            numpy.testing.assert_array_equal(lo, expected[0])
+            numpy.testing.assert_array_equal(hi, expected[1])
+        with self.assertRaises(ValueError):
+            mt2_bracket(*self.args, -1)
+
+    def test_scalar(self):
+        args = (100, 410, 20, 150, -210, -300, -200, 280, 100, 100)
+        lo, hi = mt2_bracket(*args, 20)
+        self.assertLessEqual(lo, 412.627668458219)
+        self.assertGreaterEqual(hi, 412.627668458219)
+        self.assertLess(hi - lo, 1e-3)
+
+    def test_zero_and_nan(self):
+        zero = (0.0,) * 10
+        self.assertEqual(mt2_bracket(*zero, 5), (0.0, 0.0))
+
+        args = [arg[:20].copy() for arg in self.args]
+        args[0][3] = numpy.nan
+        args[6][5] = numpy.inf
+        with numpy.errstate(invalid="ignore"):
+            lo, hi = mt2_bracket(*args, 5)
+            expected = mt2(*args)
+        numpy.testing.assert_array_equal(numpy.isnan(lo), numpy.isnan(expected))
+        numpy.testing.assert_array_equal(numpy.isnan(hi), numpy.isnan(expected))
+
+    def test_float32(self):
+        args = [arg.astype(numpy.float32) for arg in self.args]
+        expected = mt2(*[arg.astype(numpy.float64) for arg in args])
+        lo, hi = mt2_bracket(*args, 4)
+        self.assertEqual(lo.dtype, numpy.float32)
+        self.assertEqual(hi.dtype, numpy.float32)
+        self.assert_brackets(lo, hi, expected)
+
+    def test_threads_and_out(self):
+        out = (numpy.empty_like(self.expected), numpy.empty_like(self.expected))
+        lo, hi = mt2_bracket(*self.args, 8, out=out, threads=3)
+        self.assertIs(lo, out[0])
+        self.assertIs(hi, out[1])
+        expected_lo, expected_hi = mt2_bracket(*self.args, 8)
+        numpy.testing.assert_array_equal(lo, expected_lo)
+        numpy.testing.assert_array_equal(hi, expected_hi)
+
+
+if __name__ == "__main__":
+    unittest.main()
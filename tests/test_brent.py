@@ -0,0 +1,137 @@
+"""Tests for finding mt2 with Brent's method rather than bisection."""
+
+import os
+import subprocess
+import sys
+import unittest
+
+import numpy
+
+from mt2 import mt2, mt2_mass_scan
+from mt2._mt2 import supported_isas  # pyright: ignore [reportMissingImports]
+from tests.common import random_args
+
+
+class TestBrent(unittest.TestCase):
+    def setUp(self):
+        self.args = random_args(5000, degenerate=True)
+        self.expected = mt2(*self.args)
+
+    def test_matches_bisect(self):
+        result = mt2(*self.args, method="brent")
+        numpy.testing.assert_allclose(result, self.expected, rtol=1e-13, atol=0)
+        numpy.testing.assert_allclose(
+            mt2(*self.args, method="bisect"), self.expected, rtol=0, atol=0
+        )
+
+    def test_examples(self):
+        self.assertAlmostEqual(
+            mt2(100, 410, 20, 150, -210, -300, -200, 280, 100, 100, method="brent"),
+            412.627668458219,
+        )
+        # Based on Fig 5 of https://arxiv.org/pdf/1411.4312.pdf
+        computed_val = mt2(
+            0,
+            -42.017340486,
+            -146.365340528,
+            0.087252259,
+            -9.625614206,
+            145.757295514,
+            -16.692279406,
+            -14.730240471,
+            0,
+            0,
+            method="brent",
+        )
+        self.assertAlmostEqual(computed_val, 0.09719971)
+
+    def test_scale_invariance(self):
+        example_args = numpy.array((100, 410, 20, 150, -210, -300, -200, 280, 100, 100))
+        example_val = mt2(*example_args, method="brent")
+        for i in range(-100, 100, 10):
+            scale = 10.0**i
+            with numpy.errstate(over="ignore"):
+                computed_val = mt2(*(example_args * scale), method="brent")
+            numpy.testing.assert_allclose(computed_val, example_val * scale)
+
+    def test_precision(self):
+        for precision in (1e-3, 1e-6, 1e-9):
+            result = mt2(*self.args, precision, method="brent")
+            numpy.testing.assert_allclose(result, self.expected, rtol=2 * precision)
+
+    def test_no_solution_and_nan(self):
+        args = [arg[:20].copy() for arg in self.args]
+        args[0][3] = numpy.nan
+        args[6][5] = numpy.inf
+        with numpy.errstate(invalid="ignore"):
+            numpy.testing.assert_array_equal(
+                numpy.isnan(mt2(*args, method="brent")), numpy.isnan(mt2(*args))
+            )
+
+    def test_float32(self):
+        args = [arg.astype(numpy.float32) for arg in self.args]
+        result = mt2(*args, method="brent")
+        self.assertEqual(result.dtype, numpy.float32)
+        numpy.testing.assert_allclose(result, mt2(*args), rtol=1e-6)
+
+    def test_hints(self):
+        result = mt2(
+            *self.args,
+            lo_hint=self.expected * 0.99,
+            hi_hint=self.expected * 1.01,
+            method="brent",
+        )
+        numpy.testing.assert_allclose(result, self.expected, rtol=1e-13, atol=0)
+        # Wrong hints must not change the result.
+        result = mt2(
+            *self.args,
+            lo_hint=self.expected * 2,
+            hi_hint=self.expected * 0.5,
+            method="brent",
+        )
+        numpy.testing.assert_allclose(result, self.expected, rtol=1e-13, atol=0)
+
+    def test_mass_scan(self):
+        args = self.args[:8]
+        grid = numpy.linspace(0, 200, 21)
+        numpy.testing.assert_allclose(
+            mt2_mass_scan(*args, grid, method="brent"),
+            mt2_mass_scan(*args, grid),
+            rtol=1e-13,
+            atol=0,
+        )
+
+    def test_threads_and_out(self):
+        out = numpy.empty_like(self.expected)
+        result = mt2(*self.args, out=out, threads=3, method="brent")
+        self.assertIs(result, out)
+        numpy.testing.assert_array_equal(out, mt2(*self.args, method="brent"))
+
+    def test_unknown_method(self):
+        with self.assertRaises(ValueError):
+            mt2(*self.args, method="newton")
+        # The failed call must not change the method of later calls.
+        numpy.testing.assert_array_equal(mt2(*self.args), self.expected)
+
+    def test_variants_agree(self):
+        script = (
+            "import numpy\n"
+            "from mt2 import mt2\n"
+            "numpy.random.seed(42)\n"
+            "args = numpy.abs(numpy.random.uniform(-100, 100, (10, 2000)))\n"
+            "numpy.testing.assert_allclose(\n"
+            "    mt2(*args, method='brent'), mt2(*args), rtol=1e-13, atol=0\n"
+            ")\n"
+        )
+        for name in supported_isas:
+            process = subprocess.run(
+                [sys.executable, "-c", script],
+                env=dict(os.environ, MT2_ISA=name),
+                capture_output=True,
+                text=True,
+            )
+            self.assertEqual(process.returncode, 0, f"{name}: {process.stderr}")
+
+
+if __name__ == "__main__":
+    unittest.main()
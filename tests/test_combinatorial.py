@@ -0,0 +1,141 @@
+"""Tests for the least mt2 over pairings of visible objects."""
+
+import unittest
+
+import numpy
+
+from mt2 import mt2, mt2_combinatorial
+from mt2._mt2 import max_objects
+
+
+def _random_args(n_events, max_count=6, seed=42):
+    """Return jagged four-vectors and offsets, with per-event missing momenta."""
+    numpy.random.seed(seed)
+    counts = numpy.random.randint(0, max_count + 1, n_events)
+    offsets = numpy.concatenate([[0], numpy.cumsum(counts)])
+    n = offsets[-1]
+    pt = numpy.random.uniform(10, 200, n)
+    phi = numpy.random.uniform(-numpy.pi, numpy.pi, n)
+    eta = numpy.random.uniform(-2.5, 2.5, n)
+    m = numpy.random.uniform(0, 20, n)
+    px, py, pz = pt * numpy.cos(phi), pt * numpy.sin(phi), pt * numpy.sinh(eta)
+    e = numpy.sqrt(m**2 + px**2 + py**2 + pz**2)
+    px_miss, py_miss = numpy.random.uniform(-100, 100, (2, n_events))
+    return [e, px, py, pz, offsets, px_miss, py_miss]
+
+
+def _mass(e, px, py, pz):
+    return numpy.sqrt(numpy.maximum((e - pz) * (e + pz) - px * px - py * py, 0))
+
+
+def _legs_mt2(a, b, *args):
+    """Return mt2 with legs of four-vectors `a` and `b`, along their first axis."""
+    return mt2(_mass(*a), a[1], a[2], _mass(*b), b[1], b[2], *args)
+
+
+def _brute_force(e, px, py, pz, offsets, px_miss, py_miss, m_invis_1, m_invis_2):
+    """Return the least mt2 over all pairings, one event at a time."""
+    m_invis_1, m_invis_2 = numpy.broadcast_arrays(
+        m_invis_1, m_invis_2, numpy.empty(len(offsets) - 1)
+    )[:2]
+    results = numpy.full(len(offsets) - 1, numpy.nan)
+    for i in range(len(offsets) - 1):
+        vectors = numpy.stack([e, px, py, pz])[:, offsets[i] : offsets[i + 1]]
+        n = vectors.shape[1]
+        if n < 2:
+            continue
+        masks = numpy.arange(1, 2**n - 1)
+        in_a = (masks[:, numpy.newaxis] >> numpy.arange(n)) & 1 == 1
+        a = vectors @ in_a.T
+        b = vectors @ ~in_a.T
+        values = _legs_mt2(a, b, px_miss[i], py_miss[i], m_invis_1[i], m_invis_2[i])
+        results[i] = numpy.nanmin(values)
+    return results
+
+
+class TestCombinatorial(unittest.TestCase):
+    def test_matches_brute_force(self):
+        args = _random_args(300)
+        result, mask = mt2_combinatorial(*args, 50.0, 50.0)
+        expected = _brute_force(*args, 50.0, 50.0)
+        numpy.testing.assert_allclose(result, expected, rtol=1e-12)
+        counts = numpy.diff(args[4])
+        numpy.testing.assert_array_equal(numpy.isnan(result), counts < 2)
+        numpy.testing.assert_array_equal(mask < 0, counts < 2)
+        # With equal invisible masses, the last object is in the second leg.
+        self.assertTrue((mask < 2 ** (numpy.maximum(counts, 1) - 1)).all())
+
+    def test_asymmetric(self):
+        args = _random_args(200)
+        m_invis_1 = numpy.random.uniform(0, 100, 200)
+        result, _ = mt2_combinatorial(*args, m_invis_1, 10.0)
+        expected = _brute_force(*args, m_invis_1, 10.0)
+        numpy.testing.assert_allclose(result, expected, rtol=1e-12)
+
+    def test_mask(self):
+        # The returned pairing gives the returned mt2.
+        e, px, py, pz, offsets, px_miss, py_miss = _random_args(100)
+        result, mask = mt2_combinatorial(e, px, py, pz, offsets, px_miss, py_miss, 0, 5)
+        for i in numpy.flatnonzero(mask >= 0):
+            start, stop = offsets[i], offsets[i + 1]
+            in_a = (mask[i] >> numpy.arange(stop - start)) & 1 == 1
+            vectors = numpy.stack([e, px, py, pz])[:, start:stop]
+            a = vectors[:, in_a].sum(axis=1)
+            b = vectors[:, ~in_a].sum(axis=1)
+            self.assertTrue(in_a.any() and not in_a.all())
+            value = _legs_mt2(a, b, px_miss[i], py_miss[i], 0, 5)
+            self.assertAlmostEqual(result[i], value, delta=1e-12 * value)
+
+    def test_two_objects(self):
+        # With two objects, there is one pairing for each assignment of the masses.
+        vectors = numpy.array([[50, 30, 20, 10], [80, -40, 10, 30.0]])
+        result, mask = mt2_combinatorial(*vectors.T, [0, 2], 5.0, -20.0, 10.0, 0.0)
+        expected = min(
+            _legs_mt2(vectors[0], vectors[1], 5, -20, 10, 0),
+            _legs_mt2(vectors[1], vectors[0], 5, -20, 10, 0),
+        )
+        self.assertAlmostEqual(result[0], expected, delta=1e-12 * expected)
+        self.assertIn(mask[0], (1, 2))
+
+    def test_nan(self):
+        # Objects with NAN energy give some pairings a NAN lower bound, mixed
+        # with finite ones, which must not upset the others.
+        e, px, py, pz, offsets, px_miss, py_miss = _random_args(500)
+        e[::4] = numpy.nan
+        result, mask = mt2_combinatorial(e, px, py, pz, offsets, px_miss, py_miss, 0, 0)
+        n_nan = numpy.concatenate([[0], numpy.cumsum(numpy.isnan(e))])
+        has_nan = n_nan[offsets[1:]] > n_nan[offsets[:-1]]
+        self.assertTrue((mask < 2 ** (numpy.maximum(numpy.diff(offsets), 1) - 1)).all())
+        expected = _brute_force(e, px, py, pz, offsets, px_miss, py_miss, 0.0, 0.0)
+        numpy.testing.assert_allclose(result[~has_nan], expected[~has_nan], rtol=1e-12)
+
+    def test_precision_threads_and_method(self):
+        args = _random_args(2000, max_count=5)
+        expected = _brute_force(*args, 0.0, 0.0)
+        out = (numpy.empty(2000), numpy.empty(2000, dtype=numpy.int64))
+        result, mask = mt2_combinatorial(*args, 0.0, 0.0, out=out, threads=4)
+        self.assertIs(result, out[0])
+        self.assertIs(mask, out[1])
+        numpy.testing.assert_allclose(result, expected, rtol=1e-12)
+        result, _ = mt2_combinatorial(*args, 0.0, 0.0, 1e-4, method="brent")
+        numpy.testing.assert_allclose(result, expected, rtol=2e-4)
+
+    def test_float32(self):
+        args = _random_args(200)
+        args32 = [arg.astype(numpy.float32) for arg in args[:4]]
+        args32 += [args[4]] + [arg.astype(numpy.float32) for arg in args[5:]]
+        result, _ = mt2_combinatorial(*args32, numpy.float32(10), numpy.float32(10))
+        self.assertEqual(result.dtype, numpy.float32)
+        args64 = [arg.astype(numpy.float64) for arg in args32]
+        args64[4] = args[4]
+        expected = _brute_force(*args64, 10.0, 10.0)
+        numpy.testing.assert_allclose(result, expected, rtol=1e-5)
+
+    def test_invalid_offsets(self):
+        e, px, py, pz, offsets, px_miss, py_miss = _random_args(10)
+        for bad in (offsets[::-1], offsets + 1, [[0, 1]], []):
+            with self.assertRaises(ValueError):
+                mt2_combinatorial(e, px, py, pz, bad, 0.0, 0.0, 0.0, 0.0)
+        many = numpy.ones(max_objects + 1)
+        with self.assertRaises(ValueError):
+            mt2_combinatorial(many, many, many, many, [0, len(many)], 0, 0, 0, 0)
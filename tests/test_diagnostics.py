@@ -0,0 +1,99 @@
+"""Tests for finding mt2 with the status and counts of its search."""
+
+import unittest
+
+import numpy
+
+from mt2 import MT2Status, mt2, mt2_diagnostics
+from tests.common import random_args
+
+
+class TestDiagnostics(unittest.TestCase):
+    def setUp(self):
+        self.args = random_args(5000, degenerate=True)
+
+    def test_matches_mt2(self):
+        for method in ("bisect", "brent"):
+            result, status, expansions, tests = mt2_diagnostics(
+                *self.args, method=method
+            )
+            numpy.testing.assert_allclose(
+                result, mt2(*self.args, method=method), rtol=1e-13, atol=0
+            )
+            self.assertEqual(status.dtype, numpy.uint8)
+            self.assertEqual(expansions.dtype, numpy.uint16)
+            self.assertEqual(tests.dtype, numpy.uint16)
+            self.assertTrue((status == MT2Status.OK).all())
+            self.assertTrue((tests >= expansions).all())
+            self.assertTrue((tests >= 1).all())
+
+    def test_counts(self):
+        _, _, _, bisect_tests = mt2_diagnostics(*self.args, method="bisect")
+        _, _, _, brent_tests = mt2_diagnostics(*self.args, method="brent")
+        # Bisection to full precision takes about 50 tests, and Brent's far fewer.
+        self.assertGreater(bisect_tests.mean(), 40)
+        self.assertLess(brent_tests.mean(), bisect_tests.mean() / 2)
+        # A lower precision needs fewer tests.
+        _, _, _, tests = mt2_diagnostics(*self.args, 1e-3, method="bisect")
+        self.assertTrue((tests < bisect_tests).all())
+        # Bisection always expands at least once to find an upper bound.
+        _, _, expansions, _ = mt2_diagnostics(*self.args, method="bisect")
+        self.assertTrue((expansions >= 1).all())
+
+    def test_status(self):
+        args = [arg[:5].copy() for arg in self.args]
+        for arg in args:
+            arg[1] = 0.0
+        args[1][2] = numpy.nan
+        args[6][3] = numpy.inf
+        with numpy.errstate(invalid="ignore"):
+            result, status, _, tests = mt2_diagnostics(*args)
+        numpy.testing.assert_array_equal(
+            status,
+            [
+                MT2Status.OK,
+                MT2Status.ZERO,
+                MT2Status.NAN_INPUT,
+                MT2Status.NO_BRACKET,
+                MT2Status.OK,
+            ],
+        )
+        self.assertEqual(result[1], 0.0)
+        self.assertTrue(numpy.isnan(result[2:4]).all())
+        self.assertEqual(tests[1], 0)
+        self.assertEqual(tests[2], 0)
+
+    def test_scalar(self):
+        args = (100, 410, 20, 150, -210, -300, -200, 280, 100, 100)
+        result, status, expansions, tests = mt2_diagnostics(*args)
+        self.assertAlmostEqual(result, 412.627668458219)
+        self.assertEqual(status, MT2Status.OK)
+        self.assertGreater(expansions, 0)
+        self.assertGreater(tests, expansions)
+
+    def test_float32(self):
+        args = [arg.astype(numpy.float32) for arg in self.args]
+        result, status, _, tests = mt2_diagnostics(*args)
+        self.assertEqual(result.dtype, numpy.float32)
+        numpy.testing.assert_array_equal(result, mt2(*args))
+        self.assertTrue((status == MT2Status.OK).all())
+        # As for mt2, the search stops at the resolution of float32.
+        _, _, _, tests64 = mt2_diagnostics(*self.args)
+        self.assertLess(tests.mean(), tests64.mean())
+
+    def test_threads_and_out(self):
+        out = (
+            numpy.empty(len(self.args[0])),
+            numpy.empty(len(self.args[0]), dtype=numpy.uint8),
+            numpy.empty(len(self.args[0]), dtype=numpy.uint16),
+            numpy.empty(len(self.args[0]), dtype=numpy.uint16),
+        )
+        result = mt2_diagnostics(*self.args, out=out, threads=3)
+        for actual, expected in zip(result, out):
+            self.assertIs(actual, expected)
+        for actual, expected in zip(out, mt2_diagnostics(*self.args)):
+            numpy.testing.assert_array_equal(actual, expected)
+
+
+if __name__ == "__main__":
+    unittest.main()
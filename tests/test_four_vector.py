@@ -0,0 +1,126 @@
+"""Tests for evaluating mt2 from momenta in polar or four-vector form."""
+
+import unittest
+
+import numpy
+
+from mt2 import mt2, mt2_four_vector, mt2_polar
+
+
+def _random_args(n, seed=42):
+    """Return pt, phi and mass of the visible particles, and of the missing momentum."""
+    numpy.random.seed(seed)
+    pt_1, pt_2, met = numpy.random.uniform(0, 200, (3, n))
+    phi_1, phi_2, phi_miss = numpy.random.uniform(-numpy.pi, numpy.pi, (3, n))
+    m_1, m_2, m_invis_1, m_invis_2 = numpy.random.uniform(0, 100, (4, n))
+    return [pt_1, phi_1, m_1, pt_2, phi_2, m_2, met, phi_miss, m_invis_1, m_invis_2]
+
+
+def _cartesian(pt, phi):
+    return pt * numpy.cos(phi), pt * numpy.sin(phi)
+
+
+def _polar_mt2(pt_1, phi_1, m_1, pt_2, phi_2, m_2, met, phi_miss, *rest, **kwargs):
+    return mt2(
+        m_1,
+        *_cartesian(pt_1, phi_1),
+        m_2,
+        *_cartesian(pt_2, phi_2),
+        *_cartesian(met, phi_miss),
+        *rest,
+        **kwargs,
+    )
+
+
+def _four_vector(pt, phi, m, eta):
+    px, py = _cartesian(pt, phi)
+    pz = pt * numpy.sinh(eta)
+    return numpy.sqrt(m**2 + px**2 + py**2 + pz**2), px, py, pz
+
+
+class TestPolar(unittest.TestCase):
+    def test_matches_mt2(self):
+        args = _random_args(1000)
+        numpy.testing.assert_allclose(
+            mt2_polar(*args), _polar_mt2(*args), rtol=1e-12, atol=0
+        )
+
+    def test_broadcast_and_precision(self):
+        args = _random_args(500)
+        grid = numpy.linspace(0, 100, 5)[:, numpy.newaxis]
+        args[8] = args[9] = grid
+        result = mt2_polar(*args, 1e-3)
+        self.assertEqual(result.shape, (5, 500))
+        numpy.testing.assert_allclose(result, _polar_mt2(*args), rtol=2e-3)
+
+    def test_threads_method_and_out(self):
+        args = _random_args(5000)
+        out = numpy.empty(5000)
+        result = mt2_polar(*args, out=out, threads=4, method="brent")
+        self.assertIs(result, out)
+        numpy.testing.assert_allclose(
+            result, _polar_mt2(*args, method="brent"), rtol=1e-12, atol=0
+        )
+
+    def test_float32(self):
+        args = [arg.astype(numpy.float32) for arg in _random_args(300)]
+        result = mt2_polar(*args)
+        self.assertEqual(result.dtype, numpy.float32)
+        expected = _polar_mt2(*[arg.astype(numpy.float64) for arg in args])
+        numpy.testing.assert_allclose(result, expected, rtol=1e-6)
+
+    def test_scalar(self):
+        self.assertAlmostEqual(
+            mt2_polar(100, 0, 10, 100, numpy.pi, 10, 0, 0, 0, 0),
+            mt2(10, 100, 0, 10, -100, 0, 0, 0, 0, 0),
+        )
+
+
+class TestFourVector(unittest.TestCase):
+    def test_matches_mt2(self):
+        pt_1, phi_1, m_1, pt_2, phi_2, m_2, met, phi_miss, m_invis_1, m_invis_2 = (
+            _random_args(1000)
+        )
+        eta_1, eta_2 = numpy.random.uniform(-2.5, 2.5, (2, 1000))
+        result = mt2_four_vector(
+            *_four_vector(pt_1, phi_1, m_1, eta_1),
+            *_four_vector(pt_2, phi_2, m_2, eta_2),
+            met,
+            phi_miss,
+            m_invis_1,
+            m_invis_2,
+        )
+        expected = mt2(
+            m_1,
+            *_cartesian(pt_1, phi_1),
+            m_2,
+            *_cartesian(pt_2, phi_2),
+            *_cartesian(met, phi_miss),
+            m_invis_1,
+            m_invis_2,
+        )
+        # The mass is recovered from the energy with some cancellation.
+        numpy.testing.assert_allclose(result, expected, rtol=1e-9, atol=0)
+
+    def test_massless(self):
+        # The squared masses of massless four-vectors round to either side of zero;
+        # those below are taken as zero rather than giving NaN.
+        pt_1, phi_1, _, pt_2, phi_2, _, met, phi_miss, _, _ = _random_args(1000)
+        eta_1, eta_2 = numpy.random.uniform(-4, 4, (2, 1000))
+        e_1, px_1, py_1, pz_1 = _four_vector(pt_1, phi_1, 0, eta_1)
+        e_2, px_2, py_2, pz_2 = _four_vector(pt_2, phi_2, 0, eta_2)
+        self.assertTrue((e_1**2 - px_1**2 - py_1**2 - pz_1**2 < 0).any())
+        result = mt2_four_vector(
+            e_1, px_1, py_1, pz_1, e_2, px_2, py_2, pz_2, met, phi_miss, 0, 0
+        )
+        self.assertFalse(numpy.isnan(result).any())
+        expected = mt2(0, px_1, py_1, 0, px_2, py_2, *_cartesian(met, phi_miss), 0, 0)
+        # Recovered masses are about sqrt(epsilon) * e rather than zero, which moves
+        # small values of mT2 by rather more.
+        numpy.testing.assert_allclose(result, expected, rtol=1e-6, atol=0.05)
+
+    def test_nan(self):
+        event = (10.0, 1, 2, 3, 10, -1, -2, 3, 5, 0.5, 0, 0)
+        args = [numpy.full(3, float(value)) for value in event]
+        args[1][1] = numpy.nan
+        self.assertTrue(numpy.isnan(mt2_four_vector(*args)[1]))
@@ -0,0 +1,78 @@
+"""Tests for warm-starting mt2 with hints on the result."""
+
+import unittest
+
+import numpy
+
+from mt2 import mt2
+from tests.common import random_args
+
+
+class TestHints(unittest.TestCase):
+    def setUp(self):
+        self.args = random_args(2000)
+        self.expected = mt2(*self.args)
+
+    def assert_close(self, result):
+        numpy.testing.assert_allclose(result, self.expected, rtol=1e-13, atol=0)
+
+    def test_good_hints(self):
+        for width in (0.0, 1e-6, 1e-2, 1.0):
+            self.assert_close(
+                mt2(
+                    *self.args,
+                    lo_hint=self.expected * (1 - width),
+                    hi_hint=self.expected * (1 + width),
+                )
+            )
+
+    def test_one_hint(self):
+        self.assert_close(mt2(*self.args, lo_hint=self.expected * 0.99))
+        self.assert_close(mt2(*self.args, hi_hint=self.expected * 1.01))
+
+    def test_bad_hints(self):
+        # Each of these is wrong, so must be detected and not change the result.
+        self.assert_close(
+            mt2(*self.args, lo_hint=self.expected * 2, hi_hint=self.expected * 0.5)
+        )
+        self.assert_close(
+            mt2(*self.args, lo_hint=self.expected * 1.5, hi_hint=self.expected * 2)
+        )
+        self.assert_close(mt2(*self.args, lo_hint=1e300, hi_hint=1e-300))
+        self.assert_close(mt2(*self.args, lo_hint=-5.0, hi_hint=-1.0))
+
+    def test_non_finite_hints(self):
+        for hint in (numpy.nan, numpy.inf, -numpy.inf):
+            self.assert_close(mt2(*self.args, lo_hint=hint, hi_hint=hint))
+
+    def test_precision(self):
+        result = mt2(
+            *self.args,
+            1e-4,
+            lo_hint=self.expected * 0.9,
+            hi_hint=self.expected * 1.1,
+        )
+        numpy.testing.assert_allclose(result, self.expected, rtol=2e-4)
+
+    def test_float32(self):
+        args = [arg.astype(numpy.float32) for arg in self.args]
+        expected = mt2(*args)
+        result = mt2(*args, lo_hint=expected * 0.999, hi_hint=expected * 1.001)
+        self.assertEqual(result.dtype, numpy.float32)
+        numpy.testing.assert_allclose(result, expected, rtol=1e-6)
+
+    def test_threads_and_out(self):
+        out = numpy.empty_like(self.expected)
+        result = mt2(
+            *self.args,
+            lo_hint=self.expected * 0.9,
+            hi_hint=self.expected * 1.1,
+            out=out,
+            threads=3,
+        )
+        self.assertIs(result, out)
+        self.assert_close(out)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,92 @@
+"""Tests for histogramming mt2 without computing it."""
+
+import unittest
+
+import numpy
+
+from mt2 import mt2, mt2_histogram
+from tests.common import random_args
+
+
+class TestHistogram(unittest.TestCase):
+    def setUp(self):
+        self.args = random_args(20000, degenerate=True)
+        self.expected = mt2(*self.args)
+        self.edges = numpy.linspace(0, 300, 31)
+
+    def test_matches_numpy(self):
+        for edges in (self.edges, numpy.array([-10.0, 0.0, 120.0, 121.0, 1000.0])):
+            hist, result_edges = mt2_histogram(*self.args, edges)
+            self.assertEqual(hist.dtype, numpy.int64)
+            numpy.testing.assert_array_equal(result_edges, edges)
+            numpy.testing.assert_array_equal(
+                hist, numpy.histogram(self.expected, edges)[0]
+            )
+
+    def test_edges(self):
+        # As in numpy.histogram, bins include their left edge, and the last bin its
+        # right edge too.
+        zero = (0.0,) * 10
+        for edges in ([0, 1], [-1, 0], [-1, 0, 1], [-2, -1, 0]):
+            numpy.testing.assert_array_equal(
+                mt2_histogram(*zero, edges)[0], numpy.histogram(0.0, edges)[0]
+            )
+        # mT2 is exactly its lower bound, the visible mass, for a particle at rest.
+        at_rest = (100.0,) + (0.0,) * 9
+        for edges in ([100, 200], [0, 100, 200]):
+            numpy.testing.assert_array_equal(
+                mt2_histogram(*at_rest, edges)[0], numpy.histogram(100.0, edges)[0]
+            )
+
+    def test_weights(self):
+        weights = numpy.random.uniform(0, 2, len(self.expected))
+        hist, _ = mt2_histogram(*self.args, self.edges, weights=weights)
+        self.assertEqual(hist.dtype, numpy.float64)
+        expected, _ = numpy.histogram(self.expected, self.edges, weights=weights)
+        numpy.testing.assert_allclose(hist, expected, rtol=1e-12)
+
+    def test_broadcast(self):
+        args = [arg.reshape(100, 200) for arg in self.args]
+        args[8] = args[9] = 10.0
+        expected = mt2(*args)
+        hist, _ = mt2_histogram(*args, self.edges)
+        numpy.testing.assert_array_equal(
+            hist, numpy.histogram(expected, self.edges)[0]
+        )
+        # A single event.
+        args = (100, 410, 20, 150, -210, -300, -200, 280, 100, 100)
+        hist, _ = mt2_histogram(*args, [412, 413])
+        numpy.testing.assert_array_equal(hist, [1])
+
+    def test_nan_events(self):
+        args = [arg.copy() for arg in self.args]
+        args[0][::5] = numpy.nan
+        with numpy.errstate(invalid="ignore"):
+            expected = mt2(*args)
+            hist, _ = mt2_histogram(*args, self.edges)
+        numpy.testing.assert_array_equal(
+            hist, numpy.histogram(expected[~numpy.isnan(expected)], self.edges)[0]
+        )
+
+    def test_float32(self):
+        args = [arg.astype(numpy.float32) for arg in self.args]
+        hist, _ = mt2_histogram(*args, self.edges)
+        numpy.testing.assert_array_equal(
+            hist, numpy.histogram(mt2(*args), self.edges)[0]
+        )
+
+    def test_threads(self):
+        hist, _ = mt2_histogram(*self.args, self.edges, threads=1)
+        for threads in (2, 3):
+            numpy.testing.assert_array_equal(
+                mt2_histogram(*self.args, self.edges, threads=threads)[0], hist
+            )
+
+    def test_invalid_bins(self):
+        for bins in ([1.0], [[0.0, 1.0]], [0.0, 2.0, 1.0], [0.0, numpy.nan]):
+            with self.assertRaises(ValueError):
+                mt2_histogram(*self.args, bins)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,64 @@
+"""Tests for the instruction set variants of the ufunc loops."""
+
+import os
+import subprocess
+import sys
+import tempfile
+import unittest
+
+import numpy
+
+from mt2._mt2 import isa, supported_isas  # pyright: ignore [reportMissingImports]
+
+_SCRIPT = """
+import sys
+import numpy
+from mt2 import mt2
+from mt2._mt2 import isa
+
+numpy.random.seed(42)
+n = 1000
+args = [numpy.random.uniform(-100, 100, n) for _ in range(10)]
+for i in (0, 3, 8, 9):
+    args[i] = numpy.abs(args[i])
+assert isa == sys.argv[1], isa
+numpy.save(sys.argv[2], mt2(*args))
+"""
+
+
+def _run(isa_name, *args):
+    return subprocess.run(
+        [sys.executable, "-c", _SCRIPT, isa_name, *args],
+        env=dict(os.environ, MT2_ISA=isa_name),
+        capture_output=True,
+        text=True,
+    )
+
+
+class TestIsa(unittest.TestCase):
+    def test_selected(self):
+        self.assertIn("baseline", supported_isas)
+        self.assertIn(isa, supported_isas)
+        # Without an override, we pick the best supported variant.
+        if not os.environ.get("MT2_ISA"):
+            self.assertEqual(isa, supported_isas[-1])
+
+    def test_variants_agree(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            results = {}
+            for name in supported_isas:
+                path = os.path.join(tmp, f"{name}.npy")
+                process = _run(name, path)
+                self.assertEqual(process.returncode, 0, process.stderr)
+                results[name] = numpy.load(path)
+
+        # Variants may use fused-multiply-add, so agree only to rounding.
+        for name, result in results.items():
+            numpy.testing.assert_allclose(
+                result, results["baseline"], rtol=1e-12, err_msg=name
+            )
+
+    def test_unknown_variant(self):
+        process = _run("not-an-isa", "unused")
+        self.assertNotEqual(process.returncode, 0)
+        self.assertIn("MT2_ISA=not-an-isa", process.stderr)
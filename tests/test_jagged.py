@@ -0,0 +1,106 @@
+"""Tests for evaluating mt2 on jagged events."""
+
+import unittest
+
+import numpy
+
+from mt2 import mt2, mt2_jagged
+
+
+def _random_args(n_events, max_count=5, seed=42):
+    """Return jagged masses and momenta and their offsets, and per-event arguments."""
+    numpy.random.seed(seed)
+    counts = numpy.random.randint(0, max_count + 1, n_events)
+    offsets = numpy.concatenate([[0], numpy.cumsum(counts)])
+    m = numpy.random.uniform(0, 20, offsets[-1])
+    px, py = numpy.random.uniform(-100, 100, (2, offsets[-1]))
+    px_miss, py_miss = numpy.random.uniform(-100, 100, (2, n_events))
+    m_invis_1, m_invis_2 = numpy.random.uniform(0, 50, (2, n_events))
+    return [m, px, py, offsets, px_miss, py_miss, m_invis_1, m_invis_2]
+
+
+def _pairs(offsets, leading):
+    """Return the indices of the objects of each pair, and the event of each."""
+    a, b, events = [], [], []
+    for i in range(len(offsets) - 1):
+        start, stop = offsets[i], offsets[i + 1]
+        for j in range(start, stop):
+            for k in range(j + 1, stop):
+                if not leading or (j, k) == (start, start + 1):
+                    a.append(j)
+                    b.append(k)
+                    events.append(i)
+    return numpy.array(a, dtype=int), numpy.array(b, dtype=int), numpy.array(events)
+
+
+class TestJagged(unittest.TestCase):
+    def test_leading(self):
+        m, px, py, offsets, *events = _random_args(1000)
+        result, out_offsets = mt2_jagged(m, px, py, offsets, *events)
+        numpy.testing.assert_array_equal(out_offsets, numpy.arange(1001))
+
+        a, b, event = _pairs(offsets, leading=True)
+        has_pair = numpy.diff(offsets) >= 2
+        numpy.testing.assert_array_equal(event, numpy.flatnonzero(has_pair))
+        numpy.testing.assert_array_equal(
+            result[has_pair],
+            mt2(m[a], px[a], py[a], m[b], px[b], py[b], *[x[event] for x in events]),
+        )
+        self.assertTrue(numpy.isnan(result[~has_pair]).all())
+
+    def test_pairs(self):
+        m, px, py, offsets, *events = _random_args(1000)
+        result, out_offsets = mt2_jagged(m, px, py, offsets, *events, legs="pairs")
+        counts = numpy.diff(offsets)
+        numpy.testing.assert_array_equal(
+            numpy.diff(out_offsets), counts * (counts - 1) // 2
+        )
+
+        a, b, event = _pairs(offsets, leading=False)
+        numpy.testing.assert_array_equal(
+            result,
+            mt2(m[a], px[a], py[a], m[b], px[b], py[b], *[x[event] for x in events]),
+        )
+
+    def test_scalar_event_arguments(self):
+        m, px, py, offsets, *_ = _random_args(300)
+        result, _ = mt2_jagged(m, px, py, offsets, 10.0, -20.0, 0.0, 0.0, legs="pairs")
+        a, b, _ = _pairs(offsets, leading=False)
+        numpy.testing.assert_array_equal(
+            result, mt2(m[a], px[a], py[a], m[b], px[b], py[b], 10.0, -20.0, 0.0, 0.0)
+        )
+
+    def test_threads_precision_and_method(self):
+        m, px, py, offsets, *events = _random_args(5000)
+        expected, _ = mt2_jagged(m, px, py, offsets, *events, legs="pairs")
+        for kwargs in ({"threads": 4}, {"method": "brent"}):
+            result, _ = mt2_jagged(m, px, py, offsets, *events, legs="pairs", **kwargs)
+            numpy.testing.assert_allclose(result, expected, rtol=1e-12)
+        result, _ = mt2_jagged(m, px, py, offsets, *events, 1e-3, legs="pairs")
+        numpy.testing.assert_allclose(result, expected, rtol=2e-3)
+
+    def test_float32(self):
+        args = _random_args(300)
+        args = [arg.astype(numpy.float32) for arg in args[:3]] + args[3:4] + [
+            arg.astype(numpy.float32) for arg in args[4:]
+        ]
+        result, _ = mt2_jagged(*args, legs="pairs")
+        self.assertEqual(result.dtype, numpy.float32)
+        m, px, py, offsets, *events = args
+        a, b, event = _pairs(offsets, leading=False)
+        numpy.testing.assert_array_equal(
+            result,
+            mt2(m[a], px[a], py[a], m[b], px[b], py[b], *[x[event] for x in events]),
+        )
+
+    def test_empty_and_invalid(self):
+        result, out_offsets = mt2_jagged([], [], [], [0], 0.0, 0.0, 0.0, 0.0)
+        self.assertEqual(len(result), 0)
+        numpy.testing.assert_array_equal(out_offsets, [0])
+
+        m, px, py, offsets, *events = _random_args(10)
+        with self.assertRaises(ValueError):
+            mt2_jagged(m, px, py, offsets, *events, legs="all")
+        for bad in (offsets[::-1], offsets + 1, [[0, 1]], []):
+            with self.assertRaises(ValueError):
+                mt2_jagged(m, px, py, bad, 0.0, 0.0, 0.0, 0.0)
@@ -0,0 +1,93 @@
+"""Tests for evaluating mt2 over a grid of invisible masses."""
+
+import unittest
+
+import numpy
+
+from mt2 import mt2, mt2_mass_scan
+
+
+def _random_args(n, seed=42):
+    numpy.random.seed(seed)
+    args = [numpy.random.uniform(-100, 100, n) for _ in range(8)]
+    for i in (0, 3):
+        args[i] = numpy.abs(args[i])
+    return args
+
+
+def _broadcast_mt2(args, grid, **kwargs):
+    columns = [arg[..., numpy.newaxis] for arg in args]
+    return mt2(*columns, grid, grid, **kwargs)
+
+
+class TestMassScan(unittest.TestCase):
+    def test_matches_mt2(self):
+        args = _random_args(1000)
+        grid = numpy.linspace(0, 200, 41)
+        result = mt2_mass_scan(*args, grid)
+        self.assertEqual(result.shape, (1000, 41))
+        numpy.testing.assert_allclose(
+            result, _broadcast_mt2(args, grid), rtol=1e-13, atol=0
+        )
+
+    def test_any_grid_order(self):
+        args = _random_args(500)
+        grid = numpy.array([50.0, 0.0, 200.0, 10.0, 10.0, 100.0, 1e-9, 75.0])
+        numpy.testing.assert_allclose(
+            mt2_mass_scan(*args, grid), _broadcast_mt2(args, grid), rtol=1e-13, atol=0
+        )
+
+    def test_precision(self):
+        args = _random_args(500)
+        grid = numpy.linspace(0, 100, 21)
+        result = mt2_mass_scan(*args, grid, 1e-3)
+        numpy.testing.assert_allclose(result, _broadcast_mt2(args, grid), rtol=2e-3)
+
+    def test_grid_per_event(self):
+        args = _random_args(200)
+        grid = numpy.random.uniform(0, 100, (200, 7))
+        grid.sort(axis=-1)
+        numpy.testing.assert_allclose(
+            mt2_mass_scan(*args, grid),
+            mt2(*[arg[:, numpy.newaxis] for arg in args], grid, grid),
+            rtol=1e-13,
+            atol=0,
+        )
+
+    def test_scalar_event(self):
+        grid = numpy.array([0.0, 10.0, 100.0])
+        result = mt2_mass_scan(100, 410, 20, 150, -210, -300, -200, 280, grid)
+        self.assertEqual(result.shape, (3,))
+        numpy.testing.assert_allclose(
+            result, mt2(100, 410, 20, 150, -210, -300, -200, 280, grid, grid)
+        )
+
+    def test_no_solution_and_nan(self):
+        args = _random_args(20)
+        args[0][3] = numpy.nan
+        args[6][5] = numpy.inf
+        grid = numpy.array([0.0, 10.0, numpy.nan, 20.0, -5.0])
+        numpy.testing.assert_array_equal(
+            numpy.isnan(mt2_mass_scan(*args, grid)),
+            numpy.isnan(_broadcast_mt2(args, grid)),
+        )
+
+    def test_float32(self):
+        args = [arg.astype(numpy.float32) for arg in _random_args(300)]
+        grid = numpy.linspace(0, 100, 11, dtype=numpy.float32)
+        result = mt2_mass_scan(*args, grid)
+        self.assertEqual(result.dtype, numpy.float32)
+        numpy.testing.assert_allclose(result, _broadcast_mt2(args, grid), rtol=1e-6)
+
+    def test_threads_and_out(self):
+        args = _random_args(5000)
+        grid = numpy.linspace(0, 100, 5)
+        expected = mt2_mass_scan(*args, grid)
+        out = numpy.empty_like(expected)
+        result = mt2_mass_scan(*args, grid, out=out, threads=4)
+        self.assertIs(result, out)
+        numpy.testing.assert_array_equal(out, expected)
+
+
+if __name__ == "__main__":
+    unittest.main()
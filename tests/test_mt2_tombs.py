@@ -132,3 +132,70 @@ class TestTombs(unittest.TestCase):
         )
         self.assertAlmostEqual(zero, small, delta=1e-3)
         self.assertGreater(small, zero)
+
+    def test_batch_matches_elementwise(self):
+        # Events are bisected together in SIMD lanes; each lane must give exactly
+        # what the same event gives on its own, whatever its neighbours are doing.
+        numpy.random.seed(7)
+        n = 101
+        args = [numpy.random.uniform(-100, 100, n) for _ in range(10)]
+        for i in (0, 3, 8, 9):
+            args[i] = numpy.abs(args[i])
+        # Mix in events that finish early, or at very different scales.
+        for arg in args:
+            arg[5] = 0.0
+            arg[17] = numpy.nan
+        for arg in args[:8]:
+            arg[40:50] *= 1e-30
+            arg[60:70] *= 1e30
+        precision = numpy.random.choice([0.0, 1e-3, 0.5], n)
+
+        with numpy.errstate(invalid="ignore"):
+            batch = mt2_tombs(*args, desired_precision_on_mt2=precision)
+            single = numpy.array(
+                [
+                    mt2_tombs(
+                        *(arg[i] for arg in args),
+                        desired_precision_on_mt2=precision[i],
+                    )
+                    for i in range(n)
+                ]
+            )
+        numpy.testing.assert_array_equal(batch, single)
+
+    def test_float32(self):
+        # float32 inputs are computed in double internally, but written as float32.
+        numpy.random.seed(11)
+        n = 1000
+        args = [
+            numpy.random.uniform(-100, 100, n).astype(numpy.float32) for _ in range(10)
+        ]
+        for i in (0, 3, 8, 9):
+            args[i] = numpy.abs(args[i])
+
+        result = mt2_tombs(*args)
+        self.assertEqual(result.dtype, numpy.float32)
+
+        expected = mt2_tombs(*(arg.astype(numpy.float64) for arg in args))
+        self.assertEqual(expected.dtype, numpy.float64)
+        numpy.testing.assert_allclose(
+            result, expected, rtol=2 * numpy.finfo(numpy.float32).eps
+        )
+
+        # Mixing in any float64 argument selects the float64 loop.
+        mixed = mt2_tombs(*args[:-1], args[-1].astype(numpy.float64))
+        self.assertEqual(mixed.dtype, numpy.float64)
+        numpy.testing.assert_array_equal(mixed, expected)
+
+    def test_broadcast_matches_full_arrays(self):
+        # Operands with stride 0 take a path which prepares them once per loop; this
+        # must agree exactly with passing full arrays.
+        mass_1 = numpy.linspace(0, 200, 37).reshape((-1, 1))
+        mass_2 = numpy.linspace(0, 200, 41).reshape((1, -1))
+        args = (100, 410, 20, 150, -210, -300, -200, 280, mass_1, mass_2, 1e-6)
+
+        broadcast = mt2_tombs(*args[:-1], desired_precision_on_mt2=args[-1])
+        full = [numpy.array(arg) for arg in numpy.broadcast_arrays(*args)]
+        self.assertTrue(all(arg.strides[-1] != 0 for arg in full))
+        expected = mt2_tombs(*full[:-1], desired_precision_on_mt2=full[-1])
+        numpy.testing.assert_array_equal(broadcast, expected)
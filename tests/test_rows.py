@@ -0,0 +1,89 @@
+"""Tests for evaluating mt2 on events stored one per row."""
+
+import unittest
+
+import numpy
+
+from mt2 import mt2, mt2_rows
+from tests.common import random_args
+
+FIELDS = (
+    "m_vis_1",
+    "px_vis_1",
+    "py_vis_1",
+    "m_vis_2",
+    "px_vis_2",
+    "py_vis_2",
+    "px_miss",
+    "py_miss",
+    "m_invis_1",
+    "m_invis_2",
+)
+
+
+class TestRows(unittest.TestCase):
+    def test_matches_mt2(self):
+        args = random_args(1000)
+        rows = numpy.stack(args, axis=-1)
+        numpy.testing.assert_array_equal(mt2_rows(rows), mt2(*args))
+
+    def test_strided_rows(self):
+        args = random_args(500)
+        # Column-major, so that each row's values are a column apart.
+        rows = numpy.asfortranarray(numpy.stack(args, axis=-1))
+        numpy.testing.assert_array_equal(mt2_rows(rows), mt2(*args))
+
+    def test_structured(self):
+        args = random_args(500)
+        events = numpy.zeros(500, dtype=[(name, "f8") for name in FIELDS])
+        for name, arg in zip(FIELDS, args):
+            events[name] = arg
+        numpy.testing.assert_array_equal(mt2_rows(events), mt2(*args))
+
+    def test_field_map(self):
+        args = random_args(500)
+        dtype = [("event", "i8"), ("weight", "f4")] + [(name, "f8") for name in FIELDS]
+        events = numpy.zeros(500, dtype=dtype)
+        for name, arg in zip(FIELDS, args):
+            events[name] = arg
+        with self.assertRaises(ValueError):
+            mt2_rows(events)
+        numpy.testing.assert_array_equal(mt2_rows(events, fields=FIELDS), mt2(*args))
+
+    def test_column_map(self):
+        args = random_args(500)
+        order = numpy.random.permutation(12)
+        rows = numpy.zeros((500, 12))
+        rows[:, order[:10]] = numpy.stack(args, axis=-1)
+        numpy.testing.assert_array_equal(mt2_rows(rows, fields=order[:10]), mt2(*args))
+        with self.assertRaises(ValueError):
+            mt2_rows(rows, fields=order[:9])
+
+    def test_precision_and_brent(self):
+        args = random_args(300)
+        rows = numpy.stack(args, axis=-1)
+        numpy.testing.assert_allclose(mt2_rows(rows, 1e-3), mt2(*args), rtol=2e-3)
+        numpy.testing.assert_array_equal(
+            mt2_rows(rows, method="brent"), mt2(*args, method="brent")
+        )
+
+    def test_threads_and_out(self):
+        args = random_args(5000)
+        rows = numpy.stack(args, axis=-1).reshape(50, 100, 10)
+        out = numpy.empty((50, 100))
+        result = mt2_rows(rows, out=out, threads=4)
+        self.assertIs(result, out)
+        numpy.testing.assert_array_equal(result.ravel(), mt2(*args))
+
+    def test_float32(self):
+        args = [arg.astype(numpy.float32) for arg in random_args(300)]
+        result = mt2_rows(numpy.stack(args, axis=-1))
+        self.assertEqual(result.dtype, numpy.float32)
+        numpy.testing.assert_array_equal(result, mt2(*args))
+
+    def test_nan(self):
+        args = random_args(20)
+        args[1][3] = numpy.nan
+        result = mt2_rows(numpy.stack(args, axis=-1))
+        self.assertTrue(numpy.isnan(result[3]))
+        numpy.testing.assert_array_equal(numpy.isnan(result), numpy.isnan(mt2(*args)))
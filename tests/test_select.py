@@ -0,0 +1,88 @@
+"""Tests for selecting events by mt2 without computing it."""
+
+import tracemalloc
+import unittest
+
+import numpy
+
+from mt2 import mt2, mt2_select
+from tests.common import random_args
+
+
+def _expected(args, above=-numpy.inf, below=numpy.inf):
+    val = mt2(*args)
+    return numpy.flatnonzero((val > above) & (val <= below))
+
+
+class TestSelect(unittest.TestCase):
+    def test_matches_mt2(self):
+        args = random_args(10000)
+        for above, below in ((100, None), (None, 100), (80, 120), (150, 140)):
+            indices = mt2_select(*args, above=above, below=below)
+            self.assertEqual(indices.dtype, numpy.int64)
+            expected = _expected(
+                args,
+                -numpy.inf if above is None else above,
+                numpy.inf if below is None else below,
+            )
+            numpy.testing.assert_array_equal(indices, expected)
+
+    def test_blocks_and_threads(self):
+        # More events than one block, split across threads within each.
+        args = random_args(150000)
+        expected = _expected(args, 120, 160)
+        for threads in (1, 4):
+            indices = mt2_select(*args, above=120, below=160, threads=threads)
+            numpy.testing.assert_array_equal(indices, expected)
+
+    def test_nan(self):
+        args = random_args(1000)
+        args[1][::7] = numpy.nan
+        indices = mt2_select(*args, below=1e6)
+        numpy.testing.assert_array_equal(indices, _expected(args, below=1e6))
+        self.assertFalse(numpy.any(indices % 7 == 0))
+        self.assertEqual(len(mt2_select(*args, above=numpy.nan)), 0)
+        self.assertEqual(len(mt2_select(*args, below=numpy.nan)), 0)
+
+    def test_broadcast_and_float32(self):
+        args = random_args(600)
+        args = [arg.reshape(20, 30) for arg in args[:8]] + [10.0, args[9][:30]]
+        numpy.testing.assert_array_equal(
+            mt2_select(*args, above=90), _expected(args, 90)
+        )
+        args32 = [numpy.asarray(arg, numpy.float32) for arg in args]
+        numpy.testing.assert_array_equal(
+            mt2_select(*args32, above=90), _expected(args32, 90)
+        )
+
+    def test_broadcast_memory(self):
+        # 1000 events over 2000 invisible masses, which would take 16 MB for each
+        # argument broadcast to the full shape, and 160 MB for all ten.
+        args = random_args(1000)
+        args[8] = numpy.linspace(0, 100, 2000).reshape(2000, 1)
+        tracemalloc.start()
+        try:
+            indices = mt2_select(*args, above=150, below=160)
+            _, peak = tracemalloc.get_traced_memory()
+        finally:
+            tracemalloc.stop()
+        self.assertLess(peak, 2000 * 1000 * 8)
+        numpy.testing.assert_array_equal(indices, _expected(args, 150, 160))
+
+    def test_columns(self):
+        args = random_args(1000)
+        weights = numpy.random.uniform(size=1000)
+        four_momenta = numpy.random.uniform(size=(1000, 4))
+        selected_weights, selected_momenta = mt2_select(
+            *args, above=100, columns=[weights, four_momenta]
+        )
+        expected = _expected(args, 100)
+        numpy.testing.assert_array_equal(selected_weights, weights[expected])
+        numpy.testing.assert_array_equal(selected_momenta, four_momenta[expected])
+        with self.assertRaises(ValueError):
+            mt2_select(*args, above=100, columns=[weights[:10]])
+
+    def test_empty(self):
+        args = [numpy.zeros(0)] * 10
+        self.assertEqual(len(mt2_select(*args, above=0)), 0)
+        self.assertEqual(len(mt2_select(*[1.0] * 10, above=1e6)), 0)
@@ -0,0 +1,103 @@
+"""Tests for the process-wide counters of each engine."""
+
+import unittest
+
+import numpy
+
+from mt2 import (
+    mt2,
+    mt2_above,
+    mt2_arxiv,
+    mt2_bracket,
+    mt2_diagnostics,
+    mt2_histogram,
+    mt2_mass_scan,
+    mt2_select,
+    reset_stats,
+    stats,
+)
+from tests.common import mt2_lally, random_args
+
+
+class TestStats(unittest.TestCase):
+    def setUp(self):
+        reset_stats()
+
+    def tearDown(self):
+        reset_stats()
+
+    def test_reset(self):
+        mt2(*random_args(100))
+        self.assertEqual(stats()["tombs"]["events"], 100)
+        reset_stats()
+        for engine in ("tombs", "lester", "lally"):
+            self.assertEqual(
+                stats()[engine],
+                {
+                    "events": 0,
+                    "tests": 0,
+                    "errors": 0,
+                    "infinities": 0,
+                    "nans": 0,
+                    "seconds": 0.0,
+                },
+            )
+
+    def test_engines(self):
+        args = random_args(1000)
+        mt2(*args)
+        mt2_arxiv(*args)
+        mt2_lally(*[arg[:2] for arg in args])
+        result = stats()
+        self.assertEqual(result["tombs"]["events"], 1000)
+        self.assertEqual(result["lester"]["events"], 1000)
+        self.assertEqual(result["lally"]["events"], 2)
+        # Bisection needs ~50 disjointness tests in lanes and ~40 in lester's scalar
+        # search, and lally makes none.
+        self.assertGreater(result["tombs"]["tests"], 40 * 1000)
+        self.assertGreater(result["lester"]["tests"], 30 * 1000)
+        self.assertEqual(result["lally"]["tests"], 0)
+        for engine in ("tombs", "lester", "lally"):
+            self.assertGreater(result[engine]["seconds"], 0)
+
+    def test_nans(self):
+        args = random_args(100)
+        args[1][:3] = numpy.nan
+        with numpy.errstate(invalid="ignore"):
+            mt2(*args)
+        result = stats()["tombs"]
+        self.assertEqual(result["nans"], 3)
+        self.assertEqual(result["infinities"], 0)
+        self.assertEqual(result["errors"], 0)
+
+    def test_threads_and_variants(self):
+        args = random_args(10_000)
+        mt2(*args, threads=3)
+        mt2(*args, method="brent")
+        mt2_mass_scan(*args[:8], numpy.linspace(0, 100, 5))
+        _, _, _, tests = mt2_diagnostics(*[arg[:10] for arg in args])
+        result = stats()["tombs"]
+        self.assertEqual(result["events"], 2 * 10_000 + 5 * 10_000 + 10)
+        self.assertGreaterEqual(result["tests"], tests.sum())
+
+    def test_decisions(self):
+        # Functions which decide about mT2 without finding it count their events,
+        # and the few disjointness tests they make.
+        args = random_args(1000)
+        calls = (
+            (lambda: mt2_above(*args, 100.0), 1000),
+            (lambda: mt2_bracket(*args, 3), 3000),
+            (lambda: mt2_histogram(*args, numpy.linspace(0, 300, 31)), 5000),
+            (lambda: mt2_select(*args, above=100.0, below=200.0), 2000),
+        )
+        for call, max_tests in calls:
+            reset_stats()
+            call()
+            result = stats()["tombs"]
+            self.assertEqual(result["events"], 1000)
+            self.assertGreater(result["tests"], 0)
+            self.assertLessEqual(result["tests"], max_tests)
+
+
+if __name__ == "__main__":
+    unittest.main()
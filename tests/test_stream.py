@@ -0,0 +1,113 @@
+"""Tests for computing mt2 of a stream of chunks."""
+
+import threading
+import time
+import unittest
+
+import numpy
+
+from mt2 import mt2, mt2_rows, mt2_stream
+from tests.common import random_args
+
+
+def _chunks(args, size):
+    """Yield tuples of the arguments of successive chunks of `size` events."""
+    for start in range(0, len(args[0]), size):
+        yield tuple(arg[start : start + size] for arg in args)
+
+
+class TestStream(unittest.TestCase):
+    def test_matches_mt2(self):
+        args = random_args(10000)
+        results = list(mt2_stream(_chunks(args, 999)))
+        self.assertEqual(len(results), 11)
+        numpy.testing.assert_array_equal(numpy.concatenate(results), mt2(*args))
+
+    def test_write(self):
+        args = random_args(5000)
+        written = []
+        self.assertIsNone(mt2_stream(_chunks(args, 1000), write=written.append))
+        numpy.testing.assert_array_equal(numpy.concatenate(written), mt2(*args))
+
+    def test_function_and_options(self):
+        args = random_args(5000)
+        rows = numpy.stack(args, axis=-1)
+        results = mt2_stream(
+            (rows[i : i + 700] for i in range(0, 5000, 700)),
+            1e-3,
+            function=mt2_rows,
+            depth=1,
+            threads=2,
+            method="brent",
+        )
+        numpy.testing.assert_allclose(
+            numpy.concatenate(list(results)), mt2(*args), rtol=2e-3
+        )
+
+    def test_bounded(self):
+        # Reading runs at most a few chunks ahead of writing.
+        args = random_args(1000)
+        n_read = []
+
+        def read():
+            for chunk in _chunks(args, 10):
+                n_read.append(1)
+                yield chunk
+
+        for k, _ in enumerate(mt2_stream(read(), depth=2)):
+            time.sleep(0.001)
+            # Two queued before computing, one computing, two queued after it, and
+            # one being read.
+            self.assertLessEqual(len(n_read), k + 7)
+        self.assertEqual(len(n_read), 100)
+
+    def test_overlap(self):
+        # Reading each chunk waits until the previous one is being written, which
+        # only happens if reading and writing take place at the same time.
+        args = random_args(100)
+        writing = [threading.Event() for _ in range(10)]
+        waited = []
+
+        def read():
+            for k, chunk in enumerate(_chunks(args, 10)):
+                if k > 0:
+                    waited.append(writing[k - 1].wait(timeout=5))
+                yield chunk
+
+        written = []
+
+        def write(result):
+            writing[len(written)].set()
+            written.append(result)
+
+        mt2_stream(read(), write=write)
+        self.assertEqual(waited, [True] * 9)
+        numpy.testing.assert_array_equal(numpy.concatenate(written), mt2(*args))
+
+    def test_errors(self):
+        args = random_args(1000)
+
+        def read():
+            yield from _chunks(args[:5] + [None] * 5, 100)
+
+        with self.assertRaises(TypeError):
+            list(mt2_stream(read()))
+
+        def fail():
+            yield next(_chunks(args, 100))
+            raise OSError("cannot read")
+
+        results = mt2_stream(fail())
+        numpy.testing.assert_array_equal(next(results), mt2(*args)[:100])
+        with self.assertRaisesRegex(OSError, "cannot read"):
+            next(results)
+        with self.assertRaises(ValueError):
+            mt2_stream(_chunks(args, 100), depth=0)
+
+    def test_close(self):
+        # Closing the results early stops the stages.
+        args = random_args(100000)
+        results = mt2_stream(_chunks(args, 100))
+        next(results)
+        results.close()
+        self.assertEqual(threading.active_count(), 1)
@@ -0,0 +1,87 @@
+"""Tests for splitting the mt2 ufunc loop across threads."""
+
+import os
+import threading
+import unittest
+
+import numpy
+
+from mt2 import get_num_threads, mt2, set_num_threads
+
+
+def _random_args(n, seed=42):
+    numpy.random.seed(seed)
+    args = [numpy.random.uniform(-100, 100, n) for _ in range(10)]
+    for i in (0, 3, 8, 9):
+        args[i] = numpy.abs(args[i])
+    # Make some events much slower than the bulk, so threads finish unevenly.
+    for i in (3, 8):
+        args[i][::7] *= 1e-9
+    return args
+
+
+class TestThreads(unittest.TestCase):
+    def tearDown(self):
+        set_num_threads(1)
+
+    def test_default(self):
+        self.assertEqual(get_num_threads(), 1)
+
+    def test_results_independent_of_threads(self):
+        # Lengths around multiples of the chunk size, to check the edges.
+        for n in (1, 1023, 1024, 1025, 10_001):
+            args = _random_args(n)
+            expected = mt2(*args)
+            for threads in (2, 3, 8):
+                numpy.testing.assert_array_equal(mt2(*args, threads=threads), expected)
+
+    def test_strided_and_float32(self):
+        args = _random_args(20_000)
+        strided = [arg[::2] for arg in args]
+        numpy.testing.assert_array_equal(mt2(*strided, threads=4), mt2(*strided))
+
+        args32 = [arg.astype(numpy.float32) for arg in args]
+        numpy.testing.assert_array_equal(mt2(*args32, threads=4), mt2(*args32))
+
+    def test_broadcast_and_out(self):
+        args = _random_args(5000)
+        args[8] = 10.0
+        args[9] = 20.0
+        expected = mt2(*args)
+        out = numpy.empty_like(expected)
+        result = mt2(*args, out=out, threads=3)
+        self.assertIs(result, out)
+        numpy.testing.assert_array_equal(out, expected)
+
+    def test_set_num_threads(self):
+        set_num_threads(3)
+        self.assertEqual(get_num_threads(), 3)
+        set_num_threads(0)
+        self.assertEqual(get_num_threads(), os.cpu_count() or 1)
+        with self.assertRaises(ValueError):
+            set_num_threads(-1)
+
+    def test_call_override_is_restored(self):
+        set_num_threads(2)
+        mt2(*_random_args(10), threads=5)
+        self.assertEqual(get_num_threads(), 2)
+        with self.assertRaises(ValueError):
+            mt2(*_random_args(10), threads=-1)
+        self.assertEqual(get_num_threads(), 2)
+
+    def test_concurrent_callers(self):
+        # Callers which find the pool busy run on their own thread instead.
+        args = _random_args(20_000)
+        expected = mt2(*args)
+        results = [None] * 4
+
+        def _call(i):
+            results[i] = mt2(*args, threads=4)
+
+        callers = [threading.Thread(target=_call, args=(i,)) for i in range(4)]
+        for caller in callers:
+            caller.start()
+        for caller in callers:
+            caller.join()
+        for result in results:
+            numpy.testing.assert_array_equal(result, expected)